@@ -0,0 +1,43 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.cpp
+//
+// Identification: src/buffer/buffer_access_strategy.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_access_strategy.h"
+
+#include <tuple>
+
+namespace bustub {
+
+BufferAccessStrategy::BufferAccessStrategy(size_t ring_size) : ring_size_(ring_size) {}
+
+bool BufferAccessStrategy::GetRecycleCandidate(const BufferPoolManager *bpm, frame_id_t *frame_id,
+                                               page_id_t *page_id) {
+  std::scoped_lock latch(latch_);
+  auto it = rings_.find(bpm);
+  if (it == rings_.end() || it->second.slots_.size() < ring_size_) {
+    return false;
+  }
+  std::tie(*frame_id, *page_id) = it->second.slots_[it->second.next_];
+  return true;
+}
+
+void BufferAccessStrategy::AddFrame(const BufferPoolManager *bpm, frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock latch(latch_);
+  auto &ring = rings_[bpm];
+  if (ring.slots_.size() < ring_size_) {
+    ring.slots_.emplace_back(frame_id, page_id);
+    return;
+  }
+  ring.slots_[ring.next_] = {frame_id, page_id};
+  ring.next_ = (ring.next_ + 1) % ring_size_;
+}
+
+}  // namespace bustub
@@ -12,29 +12,48 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
 #include "common/macros.h"
 
 namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
-    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager) {}
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, replacer_type) {}
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                                                     DiskManager *disk_manager, LogManager *log_manager)
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type)
     : pool_size_(pool_size),
       num_instances_(num_instances),
       instance_index_(instance_index),
       next_page_id_(instance_index),
       disk_manager_(disk_manager),
-      log_manager_(log_manager) {
+      log_manager_(log_manager),
+      page_table_(pool_size) {
   BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
   BUSTUB_ASSERT(
       instance_index < num_instances,
       "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
   // We allocate a consecutive memory space for the buffer pool.
   pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size);
+  frame_io_ = new FrameIO[pool_size_];
+  switch (replacer_type) {
+    case ReplacerType::CLOCK:
+      replacer_ = new ClockReplacer(pool_size);
+      break;
+    case ReplacerType::LRU_K:
+      replacer_ = new LRUKReplacer(pool_size);
+      break;
+    case ReplacerType::LRU:
+    default:
+      replacer_ = new LRUReplacer(pool_size);
+      break;
+  }
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
     free_list_.emplace_back(static_cast<int>(i));
@@ -42,78 +61,154 @@ BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  StopBackgroundWriter();
   delete[] pages_;
+  delete[] frame_io_;
   delete replacer_;
 }
 
 bool BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) {
-  latch_.lock();
-  if (page_table_.count(page_id) == 0U) {
-    latch_.unlock();
+  // Pinning the page keeps it from being evicted while it is written, without holding latch_ across the write.
+  frame_id_t frame;
+  if (!PinResident(page_id, &frame, false)) {
     return false;
   }
-  frame_id_t frame = page_table_[page_id];
-  // though not dirty,also flash into disk
-  // if (!pages_[frame].IsDirty()) {
-  //   latch_.unlock();
-  //   return true;
-  // }
-  disk_manager_->WritePage(page_id, pages_[frame].data_);
-  pages_[frame].is_dirty_ = false;
-  latch_.unlock();
+  WaitForIO(frame);
+  Page *page = &pages_[frame];
+  // The read latch keeps the page in step with its LSN while the log is forced and the page is written.
+  page->RLatch();
+  if (ForceLog(page->GetLSN())) {
+    flush_log_waits_++;
+  }
+  // Clear the dirty flag before writing so that a concurrent unpin marking the page dirty is not lost.
+  page->is_dirty_ = false;
+  disk_manager_->WritePage(page_id, page->data_);
+  page->rec_lsn_ = INVALID_LSN;
+  page->RUnlatch();
+  UnpinPgImp(page_id, false);
   return true;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
-  latch_.lock();
-  for (auto &x : page_table_) {
-    auto page_id = x.first;
-    frame_id_t frame = x.second;
-    // 不是脏文件是否可以不需要读入磁盘
-    if (!pages_[frame].IsDirty()) {
+  FlushBatch batch;
+  PrepareFlush(&batch);
+  // The pages are sorted, so that adjacent pages go to the disk in one sequential write.
+  disk_manager_->WritePages(batch.page_ids_, batch.GetPageData());
+  FinishFlush(batch);
+}
+
+void BufferPoolManagerInstance::PrepareFlush(FlushBatch *batch) {
+  // Page ids of frames only change under latch_, so collect the dirty ones first and write them unlatched.
+  std::vector<page_id_t> dirty_pages;
+  {
+    std::scoped_lock latch(latch_);
+    for (size_t i = 0; i < pool_size_; ++i) {
+      if (pages_[i].page_id_ != INVALID_PAGE_ID && pages_[i].IsDirty()) {
+        dirty_pages.push_back(pages_[i].page_id_);
+      }
+    }
+  }
+  std::sort(dirty_pages.begin(), dirty_pages.end());
+  // Pin every page that is still resident so that all of them can be written in one batch. Holding the read latches
+  // of all of them across the batch could deadlock with a thread that latches several pages, so each page is copied
+  // under its latch and the copies are written.
+  batch->copies_.resize(dirty_pages.size() * PAGE_SIZE);
+  lsn_t max_lsn = INVALID_LSN;
+  for (auto page_id : dirty_pages) {
+    frame_id_t frame;
+    if (!PinResident(page_id, &frame, false)) {
       continue;
     }
-    disk_manager_->WritePage(page_id, pages_[frame].data_);
-    pages_[frame].is_dirty_ = false;
+    WaitForIO(frame);
+    Page *page = &pages_[frame];
+    page->RLatch();
+    batch->written_.emplace_back(page, page->GetLSN());
+    page->is_dirty_ = false;
+    memcpy(batch->copies_.data() + batch->page_ids_.size() * PAGE_SIZE, page->data_, PAGE_SIZE);
+    page->RUnlatch();
+    max_lsn = std::max(max_lsn, batch->written_.back().second);
+    batch->page_ids_.push_back(page_id);
+  }
+  batch->copies_.resize(batch->page_ids_.size() * PAGE_SIZE);
+  // WAL: one log force covers every copy.
+  if (ForceLog(max_lsn)) {
+    flush_log_waits_++;
+  }
+}
+
+void BufferPoolManagerInstance::FinishFlush(const FlushBatch &batch) {
+  for (const auto &[page, written_lsn] : batch.written_) {
+    ResetRecLSN(page, written_lsn);
+  }
+  for (auto page_id : batch.page_ids_) {
+    UnpinPgImp(page_id, false);
+  }
+}
+
+std::vector<std::pair<page_id_t, lsn_t>> BufferPoolManagerInstance::GetDirtyPageTableImp() {
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_page_table;
+  for (size_t i = 0; i < pool_size_; ++i) {
+    // A change holds the page write latch from before its log record is appended until its LSN is set, so the read
+    // latch waits for changes that are logged but do not show in the recLSN yet.
+    pages_[i].RLatch();
+    {
+      std::scoped_lock latch(latch_);
+      lsn_t rec_lsn = pages_[i].rec_lsn_;
+      if (pages_[i].page_id_ != INVALID_PAGE_ID && rec_lsn != INVALID_LSN) {
+        dirty_page_table.emplace_back(pages_[i].page_id_, rec_lsn);
+      }
+    }
+    pages_[i].RUnlatch();
+  }
+  // Pages evicted after their frame was visited are still covered here until their write-back is done.
+  std::scoped_lock latch(latch_);
+  for (const auto &[page_id, rec_lsn] : writing_back_) {
+    if (rec_lsn != INVALID_LSN) {
+      dirty_page_table.emplace_back(page_id, rec_lsn);
+    }
   }
-  latch_.unlock();
+  return dirty_page_table;
 }
 
-Page *BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) {
+Page *BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) { return NewPgWithStrategyImp(page_id, nullptr); }
+
+Page *BufferPoolManagerInstance::NewPgWithStrategyImp(page_id_t *page_id, BufferAccessStrategy *strategy) {
   // 0.   Make sure you call AllocatePage!
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
-  latch_.lock();
-  Page *res = nullptr;
+  std::unique_lock latch(latch_);
   frame_id_t frame;
-  bool get = false;
-  if (!free_list_.empty()) {
-    frame = free_list_.back();
-    free_list_.pop_back();
-    get = true;
-  } else if (replacer_->Victim(&frame)) {
-    get = true;
-    if (pages_[frame].IsDirty()) {
-      disk_manager_->WritePage(pages_[frame].page_id_, pages_[frame].data_);
-    }
-    page_table_.erase(pages_[frame].page_id_);
-    pages_[frame].ResetMemory();
-    pages_[frame].is_dirty_ = false;
+  page_id_t dirty_page_id;
+  if (!GetVictimFrame(&frame, &dirty_page_id, strategy)) {
+    return nullptr;
   }
-  if (get) {
-    *page_id = AllocatePage();
-    pages_[frame].page_id_ = *page_id;
-    pages_[frame].pin_count_ = 1;
-    page_table_[*page_id] = frame;
-    res = &pages_[frame];
+  *page_id = AllocatePage();
+  Page *page = &pages_[frame];
+  page->page_id_ = *page_id;
+  page->is_dirty_ = false;
+  page->rec_lsn_ = INVALID_LSN;
+  page->pin_count_ = 1;
+  replacer_->Pin(frame);
+  frame_io_[frame].in_progress_ = true;
+  page_table_.WLatch(*page_id);
+  page_table_.Insert(*page_id, frame);
+  page_table_.WUnlatch(*page_id);
+  if (strategy != nullptr) {
+    strategy->AddFrame(this, frame, *page_id);
   }
-  latch_.unlock();
-  return res;
+  latch.unlock();
+
+  WriteBack(frame, dirty_page_id);
+  page->ResetMemory();
+  FinishIO(frame);
+  return page;
 }
 
-Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) {
+Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) { return FetchPgWithStrategyImp(page_id, nullptr); }
+
+Page *BufferPoolManagerInstance::FetchPgWithStrategyImp(page_id_t page_id, BufferAccessStrategy *strategy) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
@@ -121,41 +216,45 @@ Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) {
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  Page *res = nullptr;
-  latch_.lock();
-  bool fetched = false;
   frame_id_t frame;
-  if (page_table_.count(page_id) != 0U) {
-    frame = page_table_[page_id];
-    replacer_->Pin(frame);
-    pages_[frame].pin_count_++;
-    fetched = true;
-  } else {
-    if (!free_list_.empty()) {
-      frame = free_list_.back();
-      free_list_.pop_back();
-      page_table_[page_id] = frame;
-      fetched = true;
-    } else if (replacer_->Victim(&frame)) {
-      if (pages_[frame].IsDirty()) {
-        disk_manager_->WritePage(pages_[frame].page_id_, pages_[frame].data_);
-      }
-      page_table_.erase(pages_[frame].page_id_);
-      fetched = true;
-    }
-    if (fetched) {
-      disk_manager_->ReadPage(page_id, pages_[frame].data_);
-      pages_[frame].page_id_ = page_id;
-      pages_[frame].is_dirty_ = false;
-      pages_[frame].pin_count_ = 1;
-      page_table_[page_id] = frame;
-    }
+  if (PinResident(page_id, &frame)) {
+    WaitForIO(frame);
+    return &pages_[frame];
+  }
+  std::unique_lock latch(latch_);
+  // A page that was just evicted may still be on its way to disk; reading it before then would return stale data.
+  write_back_cv_.wait(latch, [&] { return writing_back_.count(page_id) == 0; });
+  // Another thread may have brought the page in while we were waiting for latch_.
+  if (PinResident(page_id, &frame)) {
+    latch.unlock();
+    WaitForIO(frame);
+    return &pages_[frame];
+  }
+  page_id_t dirty_page_id;
+  if (!GetVictimFrame(&frame, &dirty_page_id, strategy)) {
+    return nullptr;
   }
-  if (fetched) {
-    res = &pages_[frame];
+  // Publish the mapping with I/O in progress so that concurrent requesters for this page wait on the frame instead
+  // of on latch_.
+  Page *page = &pages_[frame];
+  page->page_id_ = page_id;
+  page->is_dirty_ = false;
+  page->rec_lsn_ = INVALID_LSN;
+  page->pin_count_ = 1;
+  replacer_->Pin(frame);
+  frame_io_[frame].in_progress_ = true;
+  page_table_.WLatch(page_id);
+  page_table_.Insert(page_id, frame);
+  page_table_.WUnlatch(page_id);
+  if (strategy != nullptr) {
+    strategy->AddFrame(this, frame, page_id);
   }
-  latch_.unlock();
-  return res;
+  latch.unlock();
+
+  WriteBack(frame, dirty_page_id);
+  disk_manager_->ReadPage(page_id, page->data_);
+  FinishIO(frame);
+  return page;
 }
 
 bool BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) {
@@ -164,51 +263,296 @@ bool BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) {
   // 1.   If P does not exist, return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-  latch_.lock();
-  bool deleted = false;
+  std::scoped_lock latch(latch_);
   DeallocatePage(page_id);
-  if (page_table_.count(page_id) != 0U) {
-    frame_id_t frame = page_table_[page_id];
-    if (pages_[frame].GetPinCount() == 0) {
-      // dirty不需要考虑?
-      // if (pages_[frame].is_dirty_) {
-      //   disk_manager_->WritePage(page_id, pages_[frame].data_);
-      // }
-      page_table_.erase(page_id);
-      pages_[frame].page_id_ = INVALID_PAGE_ID;
-      pages_[frame].ResetMemory();
-      pages_[frame].is_dirty_ = false;
-      // replacer和free_list之间只能选一个呆着,pincount为0且在pagetable中,说明replacer中已经有frame
-      replacer_->Pin(frame);
-      free_list_.push_front(frame);
-      deleted = true;
-    }
-  } else {
-    deleted = true;
+  frame_id_t frame;
+  page_table_.WLatch(page_id);
+  if (!page_table_.Find(page_id, &frame)) {
+    page_table_.WUnlatch(page_id);
+    return true;
   }
-  latch_.unlock();
-  return deleted;
+  // The bucket write latch keeps the hit path from pinning the page between this check and the removal.
+  if (pages_[frame].GetPinCount() != 0) {
+    page_table_.WUnlatch(page_id);
+    return false;
+  }
+  page_table_.Remove(page_id);
+  page_table_.WUnlatch(page_id);
+  pages_[frame].page_id_ = INVALID_PAGE_ID;
+  pages_[frame].ResetMemory();
+  pages_[frame].is_dirty_ = false;
+  pages_[frame].rec_lsn_ = INVALID_LSN;
+  // replacer和free_list之间只能选一个呆着,pincount为0且在pagetable中,说明replacer中已经有frame
+  replacer_->Pin(frame);
+  free_list_.push_front(frame);
+  return true;
 }
 
 bool BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) {
-  latch_.lock();
-  bool usedpin = false;
-  if (page_table_.count(page_id) != 0U) {
-    frame_id_t frame = page_table_[page_id];
-    // 这要if嘛
-    if (is_dirty) {
-      pages_[frame].is_dirty_ = is_dirty;
+  frame_id_t frame;
+  page_table_.RLatch(page_id);
+  if (!page_table_.Find(page_id, &frame)) {
+    page_table_.RUnlatch(page_id);
+    return false;
+  }
+  Page *page = &pages_[frame];
+  if (is_dirty) {
+    page->is_dirty_ = true;
+  }
+  int pin_count = page->pin_count_.load();
+  do {
+    if (pin_count <= 0) {
+      page_table_.RUnlatch(page_id);
+      return false;
     }
-    if (pages_[frame].GetPinCount() > 0) {
-      usedpin = true;
-      pages_[frame].pin_count_--;
-      if (pages_[frame].pin_count_ == 0) {
-        replacer_->Unpin(frame);
-      }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+  if (pin_count == 1) {
+    replacer_->Unpin(frame);
+  }
+  page_table_.RUnlatch(page_id);
+  return true;
+}
+
+bool BufferPoolManagerInstance::PinResident(page_id_t page_id, frame_id_t *frame_id, bool reference) {
+  page_table_.RLatch(page_id);
+  bool found = page_table_.Find(page_id, frame_id);
+  if (found) {
+    pages_[*frame_id].pin_count_++;
+    if (reference) {
+      replacer_->Pin(*frame_id);
+    }
+  }
+  page_table_.RUnlatch(page_id);
+  return found;
+}
+
+bool BufferPoolManagerInstance::GetVictimFrame(frame_id_t *frame_id, page_id_t *dirty_page_id,
+                                               BufferAccessStrategy *strategy) {
+  *dirty_page_id = INVALID_PAGE_ID;
+  frame_id_t ring_frame;
+  page_id_t ring_page_id;
+  // A bulk operation recycles the oldest frame of its ring, unless the page it loaded there has left the frame or is
+  // pinned again. In that case the frame stays with the shared pool and the ring takes the frame found below instead.
+  if (strategy != nullptr && strategy->GetRecycleCandidate(this, &ring_frame, &ring_page_id) &&
+      pages_[ring_frame].page_id_ == ring_page_id && EvictFrame(ring_frame, dirty_page_id)) {
+    replacer_->Pin(ring_frame);
+    *frame_id = ring_frame;
+    return true;
+  }
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.back();
+    free_list_.pop_back();
+    return true;
+  }
+  // WAL: a dirty victim whose log records are not durable yet would have to wait for the log before its write-back,
+  // so a few of them are passed over and unpinned back into the replacer. LRU-K keeps their reference history, so a
+  // hot page does not turn cold by being passed over.
+  std::vector<frame_id_t> deferred;
+  bool found = false;
+  while (!found && replacer_->Victim(frame_id)) {
+    if (deferred.size() < static_cast<size_t>(EVICTION_LOG_LOOKAHEAD) && pages_[*frame_id].IsDirty() &&
+        !IsLogDurable(pages_[*frame_id].GetLSN())) {
+      deferred.push_back(*frame_id);
+      continue;
     }
+    // Pin and unpin race with each other outside latch_, so the replacer may hand out a frame that has been pinned
+    // again or already returned to the free list. Such a frame is dropped here and re-enters the replacer on its next
+    // unpin.
+    found = EvictFrame(*frame_id, dirty_page_id);
+  }
+  if (found) {
+    eviction_log_skips_ += deferred.size();
+  }
+  for (auto deferred_frame : deferred) {
+    if (!found && EvictFrame(deferred_frame, dirty_page_id)) {
+      *frame_id = deferred_frame;
+      found = true;
+    } else {
+      replacer_->Unpin(deferred_frame);
+    }
+  }
+  return found;
+}
+
+bool BufferPoolManagerInstance::EvictFrame(frame_id_t frame_id, page_id_t *dirty_page_id) {
+  Page *page = &pages_[frame_id];
+  page_id_t page_id = page->page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  // Only a frame that is still mapped and unpinned while its bucket is write latched can be evicted.
+  page_table_.WLatch(page_id);
+  frame_id_t mapped;
+  if (page->GetPinCount() != 0 || !page_table_.Find(page_id, &mapped) || mapped != frame_id) {
+    page_table_.WUnlatch(page_id);
+    return false;
+  }
+  page_table_.Remove(page_id);
+  page_table_.WUnlatch(page_id);
+  if (page->IsDirty()) {
+    *dirty_page_id = page_id;
+    writing_back_.emplace(page_id, page->GetRecLSN());
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::WriteBack(frame_id_t frame_id, page_id_t dirty_page_id) {
+  if (dirty_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  // The background writer, if running, has fallen behind.
+  bgwriter_cv_.notify_one();
+  // The frame is unmapped and reserved by the caller, so nobody can change the page any more.
+  if (ForceLog(pages_[frame_id].GetLSN())) {
+    eviction_log_waits_++;
+  }
+  disk_manager_->WritePage(dirty_page_id, pages_[frame_id].data_);
+  {
+    std::scoped_lock latch(latch_);
+    writing_back_.erase(dirty_page_id);
+  }
+  write_back_cv_.notify_all();
+}
+
+bool BufferPoolManagerInstance::IsLogDurable(lsn_t page_lsn) const {
+  return !enable_logging || log_manager_ == nullptr || page_lsn <= log_manager_->GetPersistentLSN();
+}
+
+bool BufferPoolManagerInstance::ForceLog(lsn_t page_lsn) {
+  if (IsLogDurable(page_lsn)) {
+    return false;
+  }
+  log_manager_->Flush(page_lsn);
+  return true;
+}
+
+void BufferPoolManagerInstance::ResetRecLSN(Page *page, lsn_t written_lsn) {
+  page->RLatch();
+  if (page->GetLSN() == written_lsn) {
+    page->rec_lsn_ = INVALID_LSN;
+  }
+  page->RUnlatch();
+}
+
+void BufferPoolManagerInstance::WaitForIO(frame_id_t frame_id) {
+  FrameIO &io = frame_io_[frame_id];
+  if (!io.in_progress_) {
+    return;
+  }
+  std::unique_lock lock(io.mutex_);
+  io.cv_.wait(lock, [&] { return !io.in_progress_; });
+}
+
+void BufferPoolManagerInstance::FinishIO(frame_id_t frame_id) {
+  FrameIO &io = frame_io_[frame_id];
+  {
+    std::scoped_lock lock(io.mutex_);
+    io.in_progress_ = false;
+  }
+  io.cv_.notify_all();
+}
+
+void BufferPoolManagerInstance::RunBackgroundWriter() {
+  std::scoped_lock bgwriter_latch(bgwriter_latch_);
+  if (bgwriter_thread_ != nullptr) {
+    return;
+  }
+  enable_bgwriter_ = true;
+  bgwriter_thread_ = new std::thread(&BufferPoolManagerInstance::RunBackgroundWriterLoop, this);
+}
+
+void BufferPoolManagerInstance::StopBackgroundWriter() {
+  std::thread *bgwriter_thread;
+  {
+    std::scoped_lock bgwriter_latch(bgwriter_latch_);
+    enable_bgwriter_ = false;
+    bgwriter_thread = bgwriter_thread_;
+    bgwriter_thread_ = nullptr;
+  }
+  if (bgwriter_thread == nullptr) {
+    return;
+  }
+  bgwriter_cv_.notify_one();
+  bgwriter_thread->join();
+  delete bgwriter_thread;
+}
+
+void BufferPoolManagerInstance::RunBackgroundWriterLoop() {
+  std::unique_lock bgwriter_latch(bgwriter_latch_);
+  while (enable_bgwriter_) {
+    bgwriter_latch.unlock();
+    CleanVictimFrames();
+    bgwriter_latch.lock();
+    bgwriter_cv_.wait_for(bgwriter_latch, bgwriter_interval);
+  }
+}
+
+size_t BufferPoolManagerInstance::CleanVictimFrames() {
+  size_t low_watermark = std::max<size_t>(1, pool_size_ * BGWRITER_LOW_WATERMARK / 100);
+  size_t free_frames;
+  {
+    std::scoped_lock latch(latch_);
+    free_frames = free_list_.size();
+  }
+  if (free_frames >= low_watermark) {
+    return 0;
+  }
+  // Only the frames that will be evicted next matter; a dirty page further up the replacer may still be modified
+  // again before it gets there.
+  std::vector<frame_id_t> victims;
+  replacer_->PeekVictims(low_watermark - free_frames, &victims);
+  size_t written = 0;
+  for (auto frame : victims) {
+    if (pages_[frame].IsDirty() && CleanFrame(frame)) {
+      written++;
+    }
+  }
+  return written;
+}
+
+bool BufferPoolManagerInstance::CleanFrame(frame_id_t frame_id) {
+  Page *page = &pages_[frame_id];
+  page_id_t page_id;
+  {
+    std::scoped_lock latch(latch_);
+    page_id = page->page_id_;
+  }
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  // Pin the page without telling the replacer, so that it keeps its place in the victim order but cannot be evicted
+  // while it is written. A page that is pinned by someone else is in use and not about to be evicted anyway.
+  page_table_.RLatch(page_id);
+  frame_id_t mapped;
+  if (!page_table_.Find(page_id, &mapped) || mapped != frame_id || page->GetPinCount() != 0) {
+    page_table_.RUnlatch(page_id);
+    return false;
+  }
+  page->pin_count_++;
+  page_table_.RUnlatch(page_id);
+
+  // Force the log without the page latch, so that changes to the page can go on meanwhile.
+  page->RLatch();
+  lsn_t page_lsn = page->GetLSN();
+  page->RUnlatch();
+  if (ForceLog(page_lsn)) {
+    flush_log_waits_++;
+  }
+
+  bool written = false;
+  page->RLatch();
+  // WAL: the page may only reach the disk after the log records of all its changes.
+  if (page->IsDirty() && IsLogDurable(page->GetLSN())) {
+    page->is_dirty_ = false;
+    disk_manager_->WritePage(page_id, page->data_);
+    // No change can have happened during the write under the read latch.
+    page->rec_lsn_ = INVALID_LSN;
+    written = true;
   }
-  latch_.unlock();
-  return usedpin;
+  page->RUnlatch();
+  // The frame re-enters the replacer here only if a victim search dropped it while it was pinned.
+  UnpinPgImp(page_id, false);
+  return written;
 }
 
 page_id_t BufferPoolManagerInstance::AllocatePage() {
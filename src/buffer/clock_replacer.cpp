@@ -14,16 +14,71 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : num_pages_(num_pages), states_(std::make_unique<std::atomic<uint8_t>[]>(num_pages)) {
+  for (size_t i = 0; i < num_pages_; ++i) {
+    states_[i] = 0;
+  }
+}
 
 ClockReplacer::~ClockReplacer() = default;
 
-bool ClockReplacer::Victim(frame_id_t *frame_id) { return false; }
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  // Every step either clears a reference bit or claims a frame, so the sweep ends within two turns of the clock
+  // unless other threads keep unpinning frames.
+  while (size_ > 0) {
+    size_t frame = clock_hand_++ % num_pages_;
+    uint8_t state = states_[frame].load();
+    if ((state & IN_REPLACER) == 0) {
+      continue;
+    }
+    if ((state & REFERENCED) != 0) {
+      states_[frame].compare_exchange_strong(state, IN_REPLACER);
+      continue;
+    }
+    // Concurrent victims race on the same frame, only the one that clears the state owns it.
+    if (states_[frame].compare_exchange_strong(state, 0)) {
+      size_--;
+      *frame_id = static_cast<frame_id_t>(frame);
+      return true;
+    }
+  }
+  return false;
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  if ((states_[frame_id].exchange(0) & IN_REPLACER) != 0) {
+    size_--;
+  }
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  // Count the frame before publishing it, so that a concurrent victim can never drive size_ below zero.
+  size_++;
+  // Unpinning a frame that is already in the replacer leaves its reference bit alone.
+  uint8_t state = states_[frame_id].load();
+  do {
+    if ((state & IN_REPLACER) != 0) {
+      size_--;
+      return;
+    }
+  } while (!states_[frame_id].compare_exchange_weak(state, IN_REPLACER | REFERENCED));
+}
 
-size_t ClockReplacer::Size() { return 0; }
+size_t ClockReplacer::Size() { return size_; }
+
+void ClockReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {
+  // Without concurrent changes, the sweep first claims the unreferenced frames ahead of the hand and then, with their
+  // reference bits cleared, the referenced ones in the same order.
+  size_t hand = clock_hand_;
+  for (uint8_t wanted : {IN_REPLACER, static_cast<uint8_t>(IN_REPLACER | REFERENCED)}) {
+    for (size_t i = 0; i < num_pages_ && frame_ids->size() < max_frames; ++i) {
+      size_t frame = (hand + i) % num_pages_;
+      if (states_[frame].load() == wanted) {
+        frame_ids->push_back(static_cast<frame_id_t>(frame));
+      }
+    }
+  }
+}
 
 }  // namespace bustub
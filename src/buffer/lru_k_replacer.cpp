@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, uint64_t correlated_reference_period)
+    : k_(k), correlated_reference_period_(correlated_reference_period), frames_(num_pages) {}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock lock(mu_);
+  if (evictable_.empty()) {
+    return false;
+  }
+  *frame_id = std::get<2>(*evictable_.begin());
+  evictable_.erase(evictable_.begin());
+  auto &frame = frames_[*frame_id];
+  frame.evictable_ = false;
+  frame.victim_ = true;
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock lock(mu_);
+  auto &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    evictable_.erase(GetEvictionKey(frame_id));
+    frame.evictable_ = false;
+  }
+  // A victim is pinned for the page that replaces the old one, whose history starts from scratch.
+  if (frame.victim_) {
+    frame.references_.clear();
+    frame.victim_ = false;
+  }
+  RecordReference(frame_id);
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock lock(mu_);
+  auto &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    return;
+  }
+  // A victim that was passed over keeps the history of its page. A frame that was never pinned through this replacer
+  // is referenced now.
+  frame.victim_ = false;
+  if (frame.references_.empty()) {
+    RecordReference(frame_id);
+  }
+  frame.evictable_ = true;
+  evictable_.insert(GetEvictionKey(frame_id));
+}
+
+size_t LRUKReplacer::Size() {
+  std::scoped_lock lock(mu_);
+  return evictable_.size();
+}
+
+void LRUKReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {
+  std::scoped_lock lock(mu_);
+  for (auto it = evictable_.begin(); it != evictable_.end() && frame_ids->size() < max_frames; ++it) {
+    frame_ids->push_back(std::get<2>(*it));
+  }
+}
+
+void LRUKReplacer::RecordReference(frame_id_t frame_id) {
+  auto &frame = frames_[frame_id];
+  uint64_t now = ++current_timestamp_;
+  bool correlated = !frame.references_.empty() && now - frame.last_reference_ <= correlated_reference_period_;
+  frame.last_reference_ = now;
+  if (correlated) {
+    return;
+  }
+  frame.references_.push_back(now);
+  if (frame.references_.size() > k_) {
+    frame.references_.pop_front();
+  }
+}
+
+LRUKReplacer::EvictionKey LRUKReplacer::GetEvictionKey(frame_id_t frame_id) const {
+  const auto &frame = frames_[frame_id];
+  return {frame.references_.size() >= k_, frame.references_.front(), frame_id};
+}
+
+}  // namespace bustub
@@ -62,4 +62,11 @@ size_t LRUReplacer::Size() {
   return size;
 }
 
+void LRUReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {
+  std::scoped_lock lock(mu_);
+  for (auto it = replace_lst_.rbegin(); it != replace_lst_.rend() && frame_ids->size() < max_frames; ++it) {
+    frame_ids->push_back(*it);
+  }
+}
+
 }  // namespace bustub
@@ -0,0 +1,39 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_buckets) : num_buckets_(1), shift_(32) {
+  while (num_buckets_ < num_buckets) {
+    num_buckets_ <<= 1;
+    shift_--;
+  }
+  buckets_ = std::make_unique<Bucket[]>(num_buckets_);
+}
+
+bool PageTable::Find(page_id_t page_id, frame_id_t *frame_id) {
+  auto &map = GetBucket(page_id)->map_;
+  auto it = map.find(page_id);
+  if (it == map.end()) {
+    return false;
+  }
+  *frame_id = it->second;
+  return true;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) { GetBucket(page_id)->map_[page_id] = frame_id; }
+
+bool PageTable::Remove(page_id_t page_id) { return GetBucket(page_id)->map_.erase(page_id) != 0U; }
+
+}  // namespace bustub
@@ -12,11 +12,16 @@
 
 #include "buffer/parallel_buffer_pool_manager.h"
 
+#include <algorithm>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
 namespace bustub {
 
 ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
                                                      LogManager *log_manager)
-    : num_instances_(num_instances) {
+    : disk_manager_(disk_manager), num_instances_(num_instances) {
   buffer_pool_ = new BufferPoolManager *[num_instances_];
   // Allocate and create individual BufferPoolManagerInstances
   for (size_t i = 0; i < num_instances_; i++) {
@@ -29,7 +34,7 @@ ParallelBufferPoolManager::~ParallelBufferPoolManager() {
   for (size_t i = 0; i < num_instances_; i++) {
     delete buffer_pool_[i];
   }
-  delete buffer_pool_;
+  delete[] buffer_pool_;
 }
 
 size_t ParallelBufferPoolManager::GetPoolSize() {
@@ -37,6 +42,42 @@ size_t ParallelBufferPoolManager::GetPoolSize() {
   return buffer_pool_[0]->GetPoolSize() * num_instances_;
 }
 
+void ParallelBufferPoolManager::RunBackgroundWriter() {
+  for (size_t i = 0; i < num_instances_; i++) {
+    static_cast<BufferPoolManagerInstance *>(buffer_pool_[i])->RunBackgroundWriter();
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundWriter() {
+  for (size_t i = 0; i < num_instances_; i++) {
+    static_cast<BufferPoolManagerInstance *>(buffer_pool_[i])->StopBackgroundWriter();
+  }
+}
+
+size_t ParallelBufferPoolManager::GetEvictionLogWaits() {
+  size_t waits = 0;
+  for (size_t i = 0; i < num_instances_; i++) {
+    waits += static_cast<BufferPoolManagerInstance *>(buffer_pool_[i])->GetEvictionLogWaits();
+  }
+  return waits;
+}
+
+size_t ParallelBufferPoolManager::GetEvictionLogSkips() {
+  size_t skips = 0;
+  for (size_t i = 0; i < num_instances_; i++) {
+    skips += static_cast<BufferPoolManagerInstance *>(buffer_pool_[i])->GetEvictionLogSkips();
+  }
+  return skips;
+}
+
+size_t ParallelBufferPoolManager::GetFlushLogWaits() {
+  size_t waits = 0;
+  for (size_t i = 0; i < num_instances_; i++) {
+    waits += static_cast<BufferPoolManagerInstance *>(buffer_pool_[i])->GetFlushLogWaits();
+  }
+  return waits;
+}
+
 BufferPoolManager *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
   // Get BufferPoolManager responsible for handling given page id. You can use this method in your other methods.
   uint32_t idx = GetIdx(page_id);
@@ -49,6 +90,11 @@ Page *ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) {
   return buffer_pool_[idx]->FetchPage(page_id);
 }
 
+Page *ParallelBufferPoolManager::FetchPgWithStrategyImp(page_id_t page_id, BufferAccessStrategy *strategy) {
+  uint32_t idx = GetIdx(page_id);
+  return buffer_pool_[idx]->FetchPageWithStrategy(page_id, strategy);
+}
+
 bool ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) {
   // Unpin page_id from responsible BufferPoolManagerInstance
   uint32_t idx = GetIdx(page_id);
@@ -61,7 +107,9 @@ bool ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) {
   return buffer_pool_[idx]->FlushPage(page_id);
 }
 
-Page *ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) {
+Page *ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) { return NewPgWithStrategyImp(page_id, nullptr); }
+
+Page *ParallelBufferPoolManager::NewPgWithStrategyImp(page_id_t *page_id, BufferAccessStrategy *strategy) {
   // create new page. We will request page allocation in a round robin manner from the underlying
   // BufferPoolManagerInstances
   // 1.   From a starting index of the BPMIs, call NewPageImpl until either 1) success and return 2) looped around to
@@ -71,7 +119,7 @@ Page *ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) {
   Page *page = nullptr;
   uint32_t start_idx = next_idx_;
   while (page == nullptr) {
-    page = buffer_pool_[next_idx_]->NewPage(page_id);
+    page = buffer_pool_[next_idx_]->NewPageWithStrategy(page_id, strategy);
     next_idx_ = (next_idx_ + 1) % num_instances_;
     if (next_idx_ == start_idx) {
       break;
@@ -87,10 +135,53 @@ bool ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) {
 }
 
 void ParallelBufferPoolManager::FlushAllPgsImp() {
-  // flush all pages from all BufferPoolManagerInstances
+  std::vector<BufferPoolManagerInstance::FlushBatch> batches(num_instances_);
+  RunPerInstance([&](size_t i) {
+    static_cast<BufferPoolManagerInstance *>(buffer_pool_[i])->PrepareFlush(&batches[i]);
+  });
+
+  std::vector<std::pair<page_id_t, const char *>> pages;
+  for (const auto &batch : batches) {
+    auto page_data = batch.GetPageData();
+    for (size_t i = 0; i < batch.page_ids_.size(); i++) {
+      pages.emplace_back(batch.page_ids_[i], page_data[i]);
+    }
+  }
+  std::sort(pages.begin(), pages.end());
+  size_t slice_size = (pages.size() + num_instances_ - 1) / num_instances_;
+  RunPerInstance([&](size_t i) {
+    std::vector<page_id_t> page_ids;
+    std::vector<const char *> page_data;
+    for (size_t j = i * slice_size; j < std::min(pages.size(), (i + 1) * slice_size); j++) {
+      page_ids.push_back(pages[j].first);
+      page_data.push_back(pages[j].second);
+    }
+    disk_manager_->WritePages(page_ids, page_data);
+  });
+
+  for (size_t i = 0; i < num_instances_; i++) {
+    static_cast<BufferPoolManagerInstance *>(buffer_pool_[i])->FinishFlush(batches[i]);
+  }
+}
+
+void ParallelBufferPoolManager::RunPerInstance(const std::function<void(size_t)> &task) {
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < num_instances_; i++) {
+    threads.emplace_back(task, i);
+  }
+  task(0);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+std::vector<std::pair<page_id_t, lsn_t>> ParallelBufferPoolManager::GetDirtyPageTableImp() {
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_page_table;
   for (size_t i = 0; i < num_instances_; i++) {
-    buffer_pool_[i]->FlushAllPages();
+    auto instance_table = buffer_pool_[i]->GetDirtyPageTable();
+    dirty_page_table.insert(dirty_page_table.end(), instance_table.begin(), instance_table.end());
   }
+  return dirty_page_table;
 }
 
 }  // namespace bustub
@@ -0,0 +1,206 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// prefetcher.cpp
+//
+// Identification: src/buffer/prefetcher.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/prefetcher.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace bustub {
+
+void PrefetchStream::Consume(page_id_t page_id) {
+  std::vector<page_id_t> unpin;
+  {
+    std::scoped_lock latch(prefetcher_->latch_);
+    auto it = std::find(pinned_.begin(), pinned_.end(), page_id);
+    if (it != pinned_.end()) {
+      // The page was ready. If the window was full too, the consumer is the bottleneck and can do with less.
+      if (pinned_.size() >= distance_) {
+        if (++idle_hits_ >= 2 * distance_) {
+          distance_ = std::max<size_t>(1, distance_ - 1);
+          idle_hits_ = 0;
+        }
+      } else {
+        idle_hits_ = 0;
+      }
+      unpin.assign(pinned_.begin(), it + 1);
+      pinned_.erase(pinned_.begin(), it + 1);
+    } else {
+      // The consumer had to read the page itself: read further ahead, and drop the pages it has passed.
+      distance_ = std::min(2 * distance_, prefetcher_->max_distance_);
+      idle_hits_ = 0;
+      unpin.assign(pinned_.begin(), pinned_.end());
+      pinned_.clear();
+      if (page_id == in_flight_) {
+        in_flight_consumed_ = true;
+      } else if (next_page_fn_) {
+        next_page_id_ = page_id;
+        skip_next_page_ = true;
+        position_version_++;
+      } else {
+        auto pos = std::find(page_ids_.begin() + next_index_, page_ids_.end(), page_id);
+        if (pos != page_ids_.end()) {
+          next_index_ = pos - page_ids_.begin() + 1;
+          position_version_++;
+        }
+      }
+    }
+    stalled_ = false;
+  }
+  prefetcher_->cv_.notify_one();
+  for (auto unpin_page_id : unpin) {
+    prefetcher_->bpm_->UnpinPage(unpin_page_id, false);
+  }
+}
+
+size_t PrefetchStream::GetDistance() {
+  std::scoped_lock latch(prefetcher_->latch_);
+  return distance_;
+}
+
+bool PrefetchStream::NeedsRead() const {
+  if (closed_ || stalled_ || in_flight_ != INVALID_PAGE_ID || pinned_.size() >= distance_) {
+    return false;
+  }
+  return next_page_fn_ ? next_page_id_ != INVALID_PAGE_ID : next_index_ < page_ids_.size();
+}
+
+Prefetcher::Prefetcher(BufferPoolManager *bpm, size_t max_distance)
+    : bpm_(bpm), max_distance_(std::max<size_t>(1, max_distance)) {
+  worker_ = std::thread(&Prefetcher::RunWorker, this);
+}
+
+Prefetcher::~Prefetcher() {
+  {
+    std::scoped_lock latch(latch_);
+    BUSTUB_ASSERT(streams_.empty(), "All prefetch streams must be released before the prefetcher.");
+    enable_worker_ = false;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+std::shared_ptr<PrefetchStream> Prefetcher::PrefetchChain(page_id_t first_page_id,
+                                                          std::function<page_id_t(Page *)> next_page_fn,
+                                                          BufferAccessStrategy *strategy) {
+  auto *stream = new PrefetchStream(this, strategy);
+  stream->next_page_fn_ = std::move(next_page_fn);
+  stream->next_page_id_ = first_page_id;
+  return Open(stream);
+}
+
+std::shared_ptr<PrefetchStream> Prefetcher::PrefetchPages(std::vector<page_id_t> page_ids,
+                                                          BufferAccessStrategy *strategy) {
+  auto *stream = new PrefetchStream(this, strategy);
+  stream->page_ids_ = std::move(page_ids);
+  return Open(stream);
+}
+
+std::shared_ptr<PrefetchStream> Prefetcher::Open(PrefetchStream *stream) {
+  {
+    std::scoped_lock latch(latch_);
+    streams_.push_back(stream);
+  }
+  cv_.notify_one();
+  return std::shared_ptr<PrefetchStream>(stream, [this](PrefetchStream *closing) { Close(closing); });
+}
+
+void Prefetcher::Close(PrefetchStream *stream) {
+  std::deque<page_id_t> unpin;
+  {
+    std::unique_lock latch(latch_);
+    stream->closed_ = true;
+    // Wait for a read in flight, so that no page of the stream is left pinned once it is closed.
+    read_done_cv_.wait(latch, [&] { return stream->in_flight_ == INVALID_PAGE_ID; });
+    unpin.swap(stream->pinned_);
+    streams_.remove(stream);
+    delete stream;
+  }
+  for (auto page_id : unpin) {
+    bpm_->UnpinPage(page_id, false);
+  }
+}
+
+void Prefetcher::RunWorker() {
+  std::unique_lock latch(latch_);
+  while (true) {
+    PrefetchStream *stream = nullptr;
+    cv_.wait(latch, [&] {
+      if (!enable_worker_) {
+        return true;
+      }
+      auto it = std::find_if(streams_.begin(), streams_.end(), [](PrefetchStream *s) { return s->NeedsRead(); });
+      if (it == streams_.end()) {
+        return false;
+      }
+      // Serve the streams round robin.
+      stream = *it;
+      streams_.erase(it);
+      streams_.push_back(stream);
+      return true;
+    });
+    if (!enable_worker_) {
+      return;
+    }
+
+    page_id_t page_id;
+    bool skip = false;
+    if (stream->next_page_fn_) {
+      page_id = stream->next_page_id_;
+      skip = stream->skip_next_page_;
+      stream->skip_next_page_ = false;
+    } else {
+      page_id = stream->page_ids_[stream->next_index_++];
+    }
+    stream->in_flight_ = page_id;
+    stream->in_flight_consumed_ = false;
+    uint64_t position_version = stream->position_version_;
+    latch.unlock();
+
+    // The read itself runs without latch_, so consumers can keep reporting progress meanwhile.
+    Page *page = bpm_->FetchPageWithStrategy(page_id, stream->strategy_);
+    page_id_t next_page_id = INVALID_PAGE_ID;
+    if (page != nullptr && stream->next_page_fn_) {
+      page->RLatch();
+      next_page_id = stream->next_page_fn_(page);
+      page->RUnlatch();
+    }
+
+    latch.lock();
+    stream->in_flight_ = INVALID_PAGE_ID;
+    bool repositioned = stream->position_version_ != position_version;
+    if (page == nullptr) {
+      // Every frame is pinned. Retry the same page once the consumer has released some, only to learn its successor
+      // if the consumer has read it in the meantime.
+      stream->stalled_ = true;
+      if (!repositioned) {
+        if (stream->next_page_fn_) {
+          stream->skip_next_page_ = skip || stream->in_flight_consumed_;
+        } else if (!stream->in_flight_consumed_) {
+          stream->next_index_--;
+        }
+      }
+    } else {
+      if (stream->next_page_fn_ && !repositioned) {
+        stream->next_page_id_ = next_page_id;
+      }
+      if (skip || repositioned || stream->in_flight_consumed_ || stream->closed_) {
+        bpm_->UnpinPage(page_id, false);
+      } else {
+        stream->pinned_.push_back(page_id);
+      }
+    }
+    read_done_cv_.notify_all();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// coding_util.cpp
+//
+// Identification: src/common/util/coding_util.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/coding_util.h"
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+namespace bustub {
+
+#ifndef __SSE4_2__
+namespace {
+
+/** The reflected CRC-32C polynomial. */
+constexpr uint32_t CRC32C_POLYNOMIAL = 0x82f63b78;
+
+constexpr std::array<uint32_t, 256> MakeCrc32cTable() {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? CRC32C_POLYNOMIAL : 0);
+    }
+    table[i] = crc;
+  }
+  return table;
+}
+
+constexpr std::array<uint32_t, 256> CRC32C_TABLE = MakeCrc32cTable();
+
+}  // namespace
+#endif
+
+uint32_t CodingUtil::Crc32c(const char *data, size_t size, uint32_t crc) {
+  crc = ~crc;
+#ifdef __SSE4_2__
+  uint64_t crc64 = crc;
+  for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t), data += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(uint64_t));
+    crc64 = _mm_crc32_u64(crc64, word);
+  }
+  crc = static_cast<uint32_t>(crc64);
+  for (; size > 0; size--, data++) {
+    crc = _mm_crc32_u8(crc, static_cast<uint8_t>(*data));
+  }
+#else
+  for (; size > 0; size--, data++) {
+    crc = (crc >> 8) ^ CRC32C_TABLE[(crc ^ static_cast<uint8_t>(*data)) & 0xff];
+  }
+#endif
+  return ~crc;
+}
+
+size_t CodingUtil::Compress(const char *data, size_t size, char *dest, size_t capacity) {
+  // The position + 1 of the last 4-byte sequence with every hash, 0 for none.
+  std::vector<uint32_t> table(size_t{1} << LZ_HASH_BITS, 0);
+  auto hash = [](const char *pos) {
+    uint32_t word;
+    memcpy(&word, pos, sizeof(uint32_t));
+    return (word * 2654435761U) >> (32 - LZ_HASH_BITS);
+  };
+  char *out = dest;
+  char *out_end = dest + capacity;
+  size_t literal_start = 0;
+  size_t pos = 0;
+  while (pos + LZ_MIN_MATCH <= size) {
+    uint32_t &entry = table[hash(data + pos)];
+    size_t candidate = entry;
+    entry = static_cast<uint32_t>(pos + 1);
+    if (candidate == 0 || memcmp(data + candidate - 1, data + pos, LZ_MIN_MATCH) != 0) {
+      pos++;
+      continue;
+    }
+    candidate--;
+    size_t length = LZ_MIN_MATCH;
+    while (pos + length < size && data[candidate + length] == data[pos + length]) {
+      length++;
+    }
+    size_t literals = pos - literal_start;
+    if (static_cast<size_t>(out_end - out) < literals + 3 * MAX_VARINT32_LENGTH) {
+      return 0;
+    }
+    out = PutVarint32(out, static_cast<uint32_t>(literals));
+    memcpy(out, data + literal_start, literals);
+    out += literals;
+    out = PutVarint32(out, static_cast<uint32_t>(length - LZ_MIN_MATCH));
+    out = PutVarint32(out, static_cast<uint32_t>(pos - candidate));
+    pos += length;
+    literal_start = pos;
+  }
+  size_t literals = size - literal_start;
+  if (static_cast<size_t>(out_end - out) < literals + MAX_VARINT32_LENGTH) {
+    return 0;
+  }
+  out = PutVarint32(out, static_cast<uint32_t>(literals));
+  memcpy(out, data + literal_start, literals);
+  out += literals;
+  return out - dest;
+}
+
+bool CodingUtil::Decompress(const char *src, size_t src_size, char *dest, size_t size) {
+  const char *end = src + src_size;
+  size_t out = 0;
+  while (true) {
+    uint32_t literals;
+    src = GetVarint32(src, end, &literals);
+    if (src == nullptr || literals > static_cast<size_t>(end - src) || literals > size - out) {
+      return false;
+    }
+    memcpy(dest + out, src, literals);
+    src += literals;
+    out += literals;
+    if (out == size) {
+      return src == end;
+    }
+    uint32_t length;
+    uint32_t offset;
+    src = GetVarint32(src, end, &length);
+    src = src == nullptr ? nullptr : GetVarint32(src, end, &offset);
+    if (src == nullptr || offset == 0 || offset > out || length + LZ_MIN_MATCH > size - out) {
+      return false;
+    }
+    // The match may overlap the bytes it produces, which repeats a short pattern.
+    for (size_t i = 0; i < length + LZ_MIN_MATCH; ++i, ++out) {
+      dest[out] = dest[out - offset];
+    }
+  }
+}
+
+}  // namespace bustub
@@ -14,6 +14,8 @@
 
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "catalog/catalog.h"
 #include "storage/table/table_heap.h"
@@ -30,6 +32,17 @@ Transaction *TransactionManager::Begin(Transaction *txn, IsolationLevel isolatio
     txn = new Transaction(next_txn_id_++, isolation_level);
   }
 
+  {
+    std::scoped_lock latch(active_txns_latch_);
+    lsn_t begin_lsn = INVALID_LSN;
+    if (enable_logging) {
+      LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::BEGIN);
+      begin_lsn = log_manager_->AppendLogRecord(&log_record);
+      txn->SetPrevLSN(begin_lsn);
+    }
+    active_txns_[txn->GetTransactionId()] = {txn, begin_lsn};
+  }
+
   txn_map[txn->GetTransactionId()] = txn;
   return txn;
 }
@@ -50,6 +63,21 @@ void TransactionManager::Commit(Transaction *txn) {
   }
   write_set->clear();
 
+  lsn_t lsn = INVALID_LSN;
+  {
+    std::scoped_lock latch(active_txns_latch_);
+    if (enable_logging) {
+      LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::COMMIT);
+      lsn = log_manager_->AppendLogRecord(&log_record);
+      txn->SetPrevLSN(lsn);
+    }
+    active_txns_.erase(txn->GetTransactionId());
+  }
+  if (lsn != INVALID_LSN) {
+    // The transaction is committed once its commit record is durable; concurrent commits share the log write.
+    log_manager_->Flush(lsn);
+  }
+
   // Release all the locks.
   ReleaseLocks(txn);
   // Release the global transaction latch.
@@ -58,11 +86,13 @@ void TransactionManager::Commit(Transaction *txn) {
 
 void TransactionManager::Abort(Transaction *txn) {
   txn->SetState(TransactionState::ABORTED);
-  // Rollback before releasing the lock.
+  // Rollback before releasing the lock. Every compensating change is logged as a CLR, whose undo-next LSN lets
+  // recovery continue an interrupted rollback where it stopped.
   auto table_write_set = txn->GetWriteSet();
   while (!table_write_set->empty()) {
     auto &item = table_write_set->back();
     auto table = item.table_;
+    txn->SetUndoNextLSN(item.undo_next_lsn_);
     if (item.wtype_ == WType::DELETE) {
       table->RollbackDelete(item.rid_, txn);
     } else if (item.wtype_ == WType::INSERT) {
@@ -100,12 +130,39 @@ void TransactionManager::Abort(Transaction *txn) {
   table_write_set->clear();
   index_write_set->clear();
 
+  {
+    std::scoped_lock latch(active_txns_latch_);
+    if (enable_logging) {
+      LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::ABORT);
+      txn->SetPrevLSN(log_manager_->AppendLogRecord(&log_record));
+    }
+    active_txns_.erase(txn->GetTransactionId());
+  }
+
   // Release all the locks.
   ReleaseLocks(txn);
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
 }
 
+std::vector<std::pair<txn_id_t, lsn_t>> TransactionManager::GetActiveTransactions(lsn_t *oldest_lsn) {
+  std::scoped_lock latch(active_txns_latch_);
+  std::vector<std::pair<txn_id_t, lsn_t>> active_txns;
+  active_txns.reserve(active_txns_.size());
+  lsn_t oldest = INVALID_LSN;
+  for (const auto &[txn_id, entry] : active_txns_) {
+    const auto &[txn, begin_lsn] = entry;
+    active_txns.emplace_back(txn_id, txn->GetPrevLSN());
+    if (begin_lsn != INVALID_LSN && (oldest == INVALID_LSN || begin_lsn < oldest)) {
+      oldest = begin_lsn;
+    }
+  }
+  if (oldest_lsn != nullptr) {
+    *oldest_lsn = oldest;
+  }
+  return active_txns;
+}
+
 void TransactionManager::BlockAllTransactions() { global_txn_latch_.WLock(); }
 
 void TransactionManager::ResumeTransactions() { global_txn_latch_.WUnlock(); }
@@ -49,7 +49,7 @@ bool InsertExecutor::Next([[maybe_unused]] Tuple *insert_tuple, RID *rid) {
   }
   RID insert_rid;
   // 无需添加write record,table_heap已经添加
-  bool insert_into_table = table_heap_->InsertTuple(*insert_tuple, &insert_rid, txn_);
+  bool insert_into_table = table_heap_->InsertTuple(*insert_tuple, &insert_rid, txn_, &strategy_);
   if (!insert_into_table) {
     throw Exception(ExceptionType::OUT_OF_MEMORY, "insert tuple faild");
   }
@@ -19,9 +19,13 @@ SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNod
       txn_(exec_ctx->GetTransaction()),
       table_info_(exec_ctx->GetCatalog()->GetTable(plan_->GetTableOid())),
       table_heap_(table_info_->table_.get()),
+      strategy_(exec_ctx->GetPrefetcher() == nullptr ? BULK_RING_SIZE
+                                                     : BULK_RING_SIZE + exec_ctx->GetPrefetcher()->GetMaxDistance()),
       next_itr_(table_heap_->End()) {}
 
-void SeqScanExecutor::Init() { next_itr_ = table_heap_->Begin(txn_); }
+void SeqScanExecutor::Init() {
+  next_itr_ = table_heap_->Begin(txn_, &strategy_, GetExecutorContext()->GetPrefetcher());
+}
 
 bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) {
   if (GetExecutorContext()->GetTransaction()->GetState() == TransactionState::ABORTED) {
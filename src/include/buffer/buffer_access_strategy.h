@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+
+/**
+ * BufferAccessStrategy confines the pages that a bulk operation (a sequential scan, a bulk insert or an index
+ * backfill) brings into the buffer pool to a small ring of frames. Once the ring is full, a miss recycles the oldest
+ * frame of the ring instead of evicting a page of the shared pool, so that one large scan cannot flush the working set
+ * of everyone else. Pages that are already resident are used in place and do not join the ring.
+ *
+ * A strategy belongs to a single operation, but may be shared with the prefetcher reading ahead for that operation.
+ * Every buffer pool instance keeps its own ring.
+ */
+class BufferAccessStrategy {
+ public:
+  /**
+   * Create a new BufferAccessStrategy.
+   * @param ring_size the number of frames a bulk operation may occupy in every buffer pool instance
+   */
+  explicit BufferAccessStrategy(size_t ring_size = BULK_RING_SIZE);
+
+  ~BufferAccessStrategy() = default;
+
+  /**
+   * Get the frame of the ring that the next miss in a buffer pool instance should recycle.
+   * @param bpm the buffer pool instance
+   * @param[out] frame_id the frame to recycle
+   * @param[out] page_id the page that this strategy loaded into the frame, the frame may hold another page by now
+   * @return false while the ring of the instance is not full yet, true otherwise
+   */
+  bool GetRecycleCandidate(const BufferPoolManager *bpm, frame_id_t *frame_id, page_id_t *page_id);
+
+  /**
+   * Record that a miss loaded a page into a frame. Once the ring is full, the frame takes the slot of the recycle
+   * candidate, whether or not the candidate itself was recycled.
+   * @param bpm the buffer pool instance
+   * @param frame_id the frame that was loaded
+   * @param page_id the page that was loaded
+   */
+  void AddFrame(const BufferPoolManager *bpm, frame_id_t frame_id, page_id_t page_id);
+
+ private:
+  struct Ring {
+    /** Frames loaded by this strategy together with the page they were loaded with. */
+    std::vector<std::pair<frame_id_t, page_id_t>> slots_;
+    /** Slot of the oldest frame, valid once the ring is full. */
+    size_t next_{0};
+  };
+
+  size_t ring_size_;
+  std::mutex latch_;
+  std::unordered_map<const BufferPoolManager *, Ring> rings_;
+};
+
+}  // namespace bustub
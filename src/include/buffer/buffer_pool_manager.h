@@ -15,7 +15,10 @@
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
@@ -84,6 +87,35 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Fetch a page on behalf of a bulk operation: a miss recycles a frame of the strategy's ring instead of evicting a
+   * page of the shared pool. A null strategy behaves like FetchPage.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the bulk operation, or nullptr
+   * @return the requested page
+   */
+  Page *FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) {
+    return FetchPgWithStrategyImp(page_id, strategy);
+  }
+
+  /**
+   * Create a new page on behalf of a bulk operation, in a frame of the strategy's ring once that ring is full.
+   * @param[out] page_id id of created page
+   * @param strategy the access strategy of the bulk operation, or nullptr
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy) {
+    return NewPgWithStrategyImp(page_id, strategy);
+  }
+
+  /**
+   * Snapshot the dirty page table for a checkpoint: every page whose changes may not all be on disk yet, with its
+   * recLSN. Every change logged before the call is either on disk or not older than its page's recLSN. The caller
+   * must not hold any page latch.
+   * @return (page id, recLSN) pairs
+   */
+  std::vector<std::pair<page_id_t, lsn_t>> GetDirtyPageTable() { return GetDirtyPageTableImp(); }
+
   /** @return size of the buffer pool */
   virtual size_t GetPoolSize() = 0;
 
@@ -108,6 +140,17 @@ class BufferPoolManager {
    */
   virtual Page *FetchPgImp(page_id_t page_id) = 0;
 
+  /**
+   * Fetch the requested page from the buffer pool on behalf of a bulk operation. Buffer pools without ring support
+   * ignore the strategy.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the bulk operation, or nullptr
+   * @return the requested page
+   */
+  virtual Page *FetchPgWithStrategyImp(page_id_t page_id, BufferAccessStrategy *strategy) {
+    return FetchPgImp(page_id);
+  }
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -130,6 +173,15 @@ class BufferPoolManager {
    */
   virtual Page *NewPgImp(page_id_t *page_id) = 0;
 
+  /**
+   * Creates a new page in the buffer pool on behalf of a bulk operation. Buffer pools without ring support ignore the
+   * strategy.
+   * @param[out] page_id id of created page
+   * @param strategy the access strategy of the bulk operation, or nullptr
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual Page *NewPgWithStrategyImp(page_id_t *page_id, BufferAccessStrategy *strategy) { return NewPgImp(page_id); }
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
@@ -141,5 +193,11 @@ class BufferPoolManager {
    * Flushes all the pages in the buffer pool to disk.
    */
   virtual void FlushAllPgsImp() = 0;
+
+  /**
+   * Snapshot the dirty page table.
+   * @return (page id, recLSN) pairs
+   */
+  virtual std::vector<std::pair<page_id_t, lsn_t>> GetDirtyPageTableImp() = 0;
 };
 }  // namespace bustub
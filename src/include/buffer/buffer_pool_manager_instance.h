@@ -12,12 +12,20 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
 #include <list>
-#include <mutex>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/page_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -34,8 +42,10 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
    */
-  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU);
   /**
    * Creates a new BufferPoolManagerInstance.
    * @param pool_size the size of the buffer pool
@@ -43,9 +53,11 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param instance_index index of this BPI in the parallel BPM
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
    */
   BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                            DiskManager *disk_manager, LogManager *log_manager = nullptr);
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU);
 
   /**
    * Destroys an existing BufferPoolManagerInstance.
@@ -58,6 +70,60 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @return pointer to all the pages in the buffer pool */
   Page *GetPages() { return pages_; }
 
+  /**
+   * Start the background writer. It writes dirty pages ahead of their eviction, so that the frames next in line for
+   * eviction stay clean and foreground threads rarely have to write a victim back themselves.
+   */
+  void RunBackgroundWriter();
+
+  /**
+   * Stop and join the background writer. Does nothing if it is not running.
+   */
+  void StopBackgroundWriter();
+
+  /** @return the number of evictions that had to force the log before writing back their victim */
+  size_t GetEvictionLogWaits() const { return eviction_log_waits_; }
+
+  /** @return the number of dirty victims passed over because their log records were not durable yet */
+  size_t GetEvictionLogSkips() const { return eviction_log_skips_; }
+
+  /** @return the number of page writes by FlushPage, FlushAllPages or the background writer that forced the log */
+  size_t GetFlushLogWaits() const { return flush_log_waits_; }
+
+  /** The dirty pages of an instance, copied to be written by a flush of all pages. */
+  struct FlushBatch {
+    /** The ids of the copied pages, in ascending order. */
+    std::vector<page_id_t> page_ids_;
+    /** The copies, PAGE_SIZE bytes for every page of page_ids_ in the same order. */
+    std::vector<char> copies_;
+    /** The copied pages, pinned until the batch is finished, with their page LSNs at the time of the copy. */
+    std::vector<std::pair<Page *, lsn_t>> written_;
+
+    /** @return the copy of every page of page_ids_ */
+    std::vector<const char *> GetPageData() const {
+      std::vector<const char *> page_data;
+      page_data.reserve(page_ids_.size());
+      for (size_t i = 0; i < page_ids_.size(); ++i) {
+        page_data.push_back(copies_.data() + i * PAGE_SIZE);
+      }
+      return page_data;
+    }
+  };
+
+  /**
+   * Copy every dirty page in page id order and force the log up to the copies, for the caller to write them. The
+   * pages stay pinned until FinishFlush. latch_ is only held to collect the dirty page ids, so lookups go on while
+   * the pages are copied and written.
+   * @param[out] batch the copied pages
+   */
+  void PrepareFlush(FlushBatch *batch);
+
+  /**
+   * Unpin the pages of a batch once its copies are on disk, and forget the recLSNs of those not changed since.
+   * @param batch the written pages
+   */
+  void FinishFlush(const FlushBatch &batch);
+
  protected:
   /**
    * Fetch the requested page from the buffer pool.
@@ -66,6 +132,14 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   Page *FetchPgImp(page_id_t page_id) override;
 
+  /**
+   * Fetch the requested page from the buffer pool on behalf of a bulk operation.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the bulk operation, or nullptr
+   * @return the requested page
+   */
+  Page *FetchPgWithStrategyImp(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -88,6 +162,14 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   Page *NewPgImp(page_id_t *page_id) override;
 
+  /**
+   * Creates a new page in the buffer pool on behalf of a bulk operation.
+   * @param[out] page_id id of created page
+   * @param strategy the access strategy of the bulk operation, or nullptr
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPgWithStrategyImp(page_id_t *page_id, BufferAccessStrategy *strategy) override;
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
@@ -100,6 +182,12 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   void FlushAllPgsImp() override;
 
+  /**
+   * Snapshot the dirty page table.
+   * @return (page id, recLSN) pairs
+   */
+  std::vector<std::pair<page_id_t, lsn_t>> GetDirtyPageTableImp() override;
+
   /**
    * Allocate a page on disk.∂
    * @return the id of the allocated page
@@ -121,6 +209,98 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   void ValidatePageId(page_id_t page_id) const;
 
+  /**
+   * Pin a page if it is already resident. Only takes the page table bucket latch of page_id, never latch_. The frame
+   * may still have I/O in progress, so callers that touch the page data must WaitForIO first.
+   * @param page_id the page to pin
+   * @param[out] frame_id the frame holding the page
+   * @param reference false for internal pins such as flushes, which are not accesses to the page. The replacer is not
+   * told about them, so the page keeps its place in the victim order; a victim search drops it while it is pinned and
+   * it comes back on its unpin.
+   * @return true if the page was resident and has been pinned, false otherwise
+   */
+  bool PinResident(page_id_t page_id, frame_id_t *frame_id, bool reference = true);
+
+  /**
+   * Find a frame to hold a new page: the recycle candidate of the strategy's ring if it can be reused, otherwise from
+   * the free list first and then from the replacer. Up to EVICTION_LOG_LOOKAHEAD dirty victims whose log records are
+   * not durable yet are passed over for one that can be written back right away. The victim's mapping is removed from
+   * the page table, but a dirty victim is not written back here: its page id is registered in writing_back_ and
+   * returned so that the caller can write it once latch_ is released. Must be called with latch_ held.
+   * @param[out] frame_id the frame that can be reused
+   * @param[out] dirty_page_id the page that must be written back from the frame, or INVALID_PAGE_ID if it is clean
+   * @param strategy the access strategy of the bulk operation, or nullptr
+   * @return false if every frame is pinned, true otherwise
+   */
+  bool GetVictimFrame(frame_id_t *frame_id, page_id_t *dirty_page_id, BufferAccessStrategy *strategy);
+
+  /**
+   * Remove the page held by an unpinned frame from the page table. Must be called with latch_ held.
+   * @param frame_id the frame to evict
+   * @param[out] dirty_page_id the page that must be written back from the frame, left untouched if it is clean
+   * @return false if the frame is empty or its page is pinned, true otherwise
+   */
+  bool EvictFrame(frame_id_t frame_id, page_id_t *dirty_page_id);
+
+  /**
+   * Write back the previous contents of a reserved frame and unregister it from writing_back_. Must be called without
+   * latch_ held. Does nothing if dirty_page_id is INVALID_PAGE_ID.
+   */
+  void WriteBack(frame_id_t frame_id, page_id_t dirty_page_id);
+
+  /**
+   * @return true if the log records of all changes up to a page LSN are durable, or if logging is disabled. The log
+   * manager only advances its persistent LSN once the log is synced, not when it has merely been written.
+   */
+  bool IsLogDurable(lsn_t page_lsn) const;
+
+  /**
+   * WAL: force the log up to a page LSN before the page is written, blocking until the log is synced that far.
+   * @param page_lsn the LSN of the page to be written
+   * @return true if the log had to be forced, false if it was durable already
+   */
+  bool ForceLog(lsn_t page_lsn);
+
+  /**
+   * Forget the recLSN of a page once a write of it has reached the disk, unless the page has been changed since the
+   * write started. Takes the page read latch.
+   * @param page the written page
+   * @param written_lsn the page LSN when the write started
+   */
+  void ResetRecLSN(Page *page, lsn_t written_lsn);
+
+  /** Block until the I/O that loads the frame's page has finished. */
+  void WaitForIO(frame_id_t frame_id);
+
+  /** Mark the I/O on a frame as finished and wake up everyone waiting on it. */
+  void FinishIO(frame_id_t frame_id);
+
+  /** Main loop of the background writer thread. */
+  void RunBackgroundWriterLoop();
+
+  /**
+   * Write back the dirty pages among the next frames to be evicted, until BGWRITER_LOW_WATERMARK percent of the pool
+   * is free or clean and evictable.
+   * @return the number of pages written
+   */
+  size_t CleanVictimFrames();
+
+  /**
+   * Write back the page held by an unpinned frame without evicting it. The log is forced first if the page is ahead
+   * of it; a page that has been changed again meanwhile is skipped.
+   * @param frame_id the frame to clean
+   * @return true if the page was written, false otherwise
+   */
+  bool CleanFrame(frame_id_t frame_id);
+
+  /** Per-frame state of a read or write-back that is running without latch_. */
+  struct FrameIO {
+    /** True while the frame is reserved for a page whose contents are not in memory yet. */
+    std::atomic<bool> in_progress_{false};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+  };
+
   /** Number of pages in the buffer pool. */
   const size_t pool_size_;
   /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
@@ -136,13 +316,34 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  /** Page table for keeping track of buffer pool pages, latched per bucket. */
+  PageTable page_table_;
   /** Replacer to find unpinned pages for replacement. */
   Replacer *replacer_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /** I/O state of every frame, indexed like pages_. */
+  FrameIO *frame_io_;
+  /** Evicted dirty pages whose write-back has not reached the disk yet, with their recLSN. Protected by latch_. */
+  std::unordered_map<page_id_t, lsn_t> writing_back_;
+  /** Signalled with latch_ whenever a page leaves writing_back_. */
+  std::condition_variable write_back_cv_;
+  /** The background writer thread, nullptr if it is not running. */
+  std::thread *bgwriter_thread_{nullptr};
+  /** Protects enable_bgwriter_ and pairs with bgwriter_cv_. */
+  std::mutex bgwriter_latch_;
+  /** Wakes up the background writer early, when a foreground thread had to write back its victim or on shutdown. */
+  std::condition_variable bgwriter_cv_;
+  bool enable_bgwriter_{false};
+  /** WAL statistics, see GetEvictionLogWaits, GetEvictionLogSkips and GetFlushLogWaits. */
+  std::atomic<size_t> eviction_log_waits_{0};
+  std::atomic<size_t> eviction_log_skips_{0};
+  std::atomic<size_t> flush_log_waits_{0};
+  /**
+   * This latch serializes changes to the set of resident pages: the free list, victim selection, writing_back_ and every
+   * insertion or removal in the page table. Pinning and unpinning a resident page only takes the page table bucket
+   * latch, and disk I/O is never performed while holding it.
+   */
   std::mutex latch_;
 };
 }  // namespace bustub
@@ -12,8 +12,8 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -23,6 +23,9 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Every frame owns an atomic state word holding an "in replacer" bit and a reference bit, and the clock hand is an
+ * atomic counter, so Pin, Unpin and Victim never take a lock or allocate. Frame ids must be smaller than num_pages.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -45,8 +48,18 @@ class ClockReplacer : public Replacer {
 
   size_t Size() override;
 
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) override;
+
  private:
-  // TODO(student): implement me!
+  /** The frame can be victimized. */
+  static constexpr uint8_t IN_REPLACER = 0x1;
+  /** The frame was unpinned since the clock hand last passed it. */
+  static constexpr uint8_t REFERENCED = 0x2;
+
+  size_t num_pages_;
+  std::unique_ptr<std::atomic<uint8_t>[]> states_;
+  std::atomic<size_t> clock_hand_{0};
+  std::atomic<size_t> size_{0};
 };
 
 }  // namespace bustub
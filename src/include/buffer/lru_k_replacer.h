@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <mutex>  // NOLINT
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy. The victim is the evictable frame whose K-th most recent
+ * reference is the oldest (its backward K-distance is the largest). Frames with fewer than K references have an
+ * infinite backward K-distance and are evicted first, oldest first reference first, so pages touched once by a
+ * sequential scan leave the pool before pages that are referenced repeatedly.
+ *
+ * Every Pin counts as a reference. References that follow the previous one within the correlated reference period
+ * are considered part of the same burst (e.g. a scan reading every tuple of a page) and count only once.
+ *
+ * A victim keeps its history until it is pinned for its next page. A victim that the caller passes over and unpins
+ * again returns to its old place.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of references kept in the history of every frame
+   * @param correlated_reference_period number of references (to any frame) within which a repeated reference to the
+   * same frame is treated as correlated
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K,
+                        uint64_t correlated_reference_period = LRUK_CORRELATED_REFERENCE_PERIOD);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) override;
+
+ private:
+  /** Eviction order of a frame: frames with fewer than k references first, then by their oldest kept reference. */
+  using EvictionKey = std::tuple<bool, uint64_t, frame_id_t>;
+
+  struct FrameHistory {
+    /** Timestamps of the last (at most k) uncorrelated references, oldest first. */
+    std::deque<uint64_t> references_;
+    /** Timestamp of the last reference, correlated or not. */
+    uint64_t last_reference_{0};
+    bool evictable_{false};
+    /** Handed out by Victim and neither pinned nor unpinned since. */
+    bool victim_{false};
+  };
+
+  /** Record a reference to a frame. Must be called with mu_ held. */
+  void RecordReference(frame_id_t frame_id);
+
+  /** @return the eviction key of a frame with at least one reference */
+  EvictionKey GetEvictionKey(frame_id_t frame_id) const;
+
+  size_t k_;
+  uint64_t correlated_reference_period_;
+  std::mutex mu_;
+  /** Logical clock, advanced on every reference. */
+  uint64_t current_timestamp_{0};
+  std::vector<FrameHistory> frames_;
+  /** Evictable frames ordered by eviction priority. */
+  std::set<EvictionKey> evictable_;
+};
+
+}  // namespace bustub
@@ -46,6 +46,8 @@ class LRUReplacer : public Replacer {
 
   size_t Size() override;
 
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) override;
+
  private:
   size_t capcity_;
   std::mutex mu_;
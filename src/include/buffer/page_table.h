@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/rwlatch.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps resident page ids to the frames that hold them. The table is split into a fixed number of buckets,
+ * each protected by its own reader-writer latch, so that lookups for different pages never contend on a shared
+ * latch and lookups for the same page only contend with a writer that is remapping a page in that bucket.
+ *
+ * Callers latch the bucket of a page id explicitly (mirroring the latch interface of Page) and perform Find / Insert /
+ * Remove while holding it. This lets the buffer pool manager pin a frame atomically with respect to its eviction.
+ */
+class PageTable {
+ public:
+  /**
+   * Creates a new page table.
+   * @param num_buckets number of latched buckets, rounded up to the next power of two
+   */
+  explicit PageTable(size_t num_buckets);
+
+  ~PageTable() = default;
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  /** Acquire the read latch of the bucket holding page_id. */
+  inline void RLatch(page_id_t page_id) { GetBucket(page_id)->latch_.RLock(); }
+
+  /** Release the read latch of the bucket holding page_id. */
+  inline void RUnlatch(page_id_t page_id) { GetBucket(page_id)->latch_.RUnlock(); }
+
+  /** Acquire the write latch of the bucket holding page_id. */
+  inline void WLatch(page_id_t page_id) { GetBucket(page_id)->latch_.WLock(); }
+
+  /** Release the write latch of the bucket holding page_id. */
+  inline void WUnlatch(page_id_t page_id) { GetBucket(page_id)->latch_.WUnlock(); }
+
+  /**
+   * Look up the frame holding a page. The caller must hold the bucket latch of page_id in either mode.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame holding the page, if any
+   * @return true if the page is resident, false otherwise
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id);
+
+  /**
+   * Map a page to a frame. The caller must hold the bucket write latch of page_id.
+   * @param page_id the page being installed
+   * @param frame_id the frame that holds it
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Remove the mapping of a page. The caller must hold the bucket write latch of page_id.
+   * @param page_id the page being removed
+   * @return true if a mapping was removed, false if the page was not resident
+   */
+  bool Remove(page_id_t page_id);
+
+  /** @return the number of buckets in this table */
+  size_t GetNumBuckets() const { return num_buckets_; }
+
+ private:
+  struct Bucket {
+    ReaderWriterLatch latch_;
+    std::unordered_map<page_id_t, frame_id_t> map_;
+  };
+
+  /**
+   * Page ids handed out by a parallel buffer pool are strided by the number of instances, so a plain modulo would
+   * leave most buckets of an instance empty. Fibonacci hashing spreads any stride evenly over the buckets.
+   */
+  inline Bucket *GetBucket(page_id_t page_id) {
+    return &buckets_[static_cast<uint64_t>(static_cast<uint32_t>(page_id) * 2654435769U) >> shift_];
+  }
+
+  size_t num_buckets_;
+  uint32_t shift_;
+  std::unique_ptr<Bucket[]> buckets_;
+};
+
+}  // namespace bustub
@@ -12,6 +12,10 @@
 
 #pragma once
 
+#include <functional>
+#include <utility>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "buffer/buffer_pool_manager_instance.h"
 #include "recovery/log_manager.h"
@@ -40,6 +44,21 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   /** @return size of the buffer pool */
   size_t GetPoolSize() override;
 
+  /** Start the background writer of every BufferPoolManagerInstance. */
+  void RunBackgroundWriter();
+
+  /** Stop the background writer of every BufferPoolManagerInstance. */
+  void StopBackgroundWriter();
+
+  /** @return the evictions that forced the log, summed over every BufferPoolManagerInstance */
+  size_t GetEvictionLogWaits();
+
+  /** @return the dirty victims passed over for their log, summed over every BufferPoolManagerInstance */
+  size_t GetEvictionLogSkips();
+
+  /** @return the page flushes that forced the log, summed over every BufferPoolManagerInstance */
+  size_t GetFlushLogWaits();
+
  protected:
   /**
    * @param page_id id of page
@@ -54,6 +73,14 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   Page *FetchPgImp(page_id_t page_id) override;
 
+  /**
+   * Fetch the requested page from the buffer pool on behalf of a bulk operation.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the bulk operation, or nullptr
+   * @return the requested page
+   */
+  Page *FetchPgWithStrategyImp(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -76,6 +103,14 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   Page *NewPgImp(page_id_t *page_id) override;
 
+  /**
+   * Creates a new page in the buffer pool on behalf of a bulk operation.
+   * @param[out] page_id id of created page
+   * @param strategy the access strategy of the bulk operation, or nullptr
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPgWithStrategyImp(page_id_t *page_id, BufferAccessStrategy *strategy) override;
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
@@ -84,12 +119,25 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   bool DeletePgImp(page_id_t page_id) override;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the pages in the buffer pool to disk. The instances copy their dirty pages in parallel. Since page
+   * ids are striped over the instances, the copies are merged in page id order and written by one thread per
+   * instance, each a contiguous slice of them, so that adjacent pages are written sequentially.
    */
   void FlushAllPgsImp() override;
 
+  /**
+   * Snapshot the dirty page table.
+   * @return (page id, recLSN) pairs
+   */
+  std::vector<std::pair<page_id_t, lsn_t>> GetDirtyPageTableImp() override;
+
  private:
   uint32_t GetIdx(page_id_t page_id) { return page_id % num_instances_; }
+
+  /** Run a task for every instance index, each on its own thread, and wait for all of them. */
+  void RunPerInstance(const std::function<void(size_t)> &task);
+
+  DiskManager *disk_manager_;
   size_t num_instances_;
   uint32_t next_idx_{0};
   BufferPoolManager **buffer_pool_;
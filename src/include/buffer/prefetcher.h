@@ -0,0 +1,164 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// prefetcher.h
+//
+// Identification: src/include/buffer/prefetcher.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+class Prefetcher;
+
+/**
+ * PrefetchStream is the consumer side of one read-ahead sequence. The consumer fetches and unpins pages through the
+ * buffer pool as usual and reports every page it has reached with Consume. The prefetcher keeps up to GetDistance()
+ * pages beyond that point pinned in the pool, so those fetches are hits.
+ *
+ * A stream is handed out as a shared_ptr; releasing the last copy stops the read-ahead and unpins its pages.
+ */
+class PrefetchStream {
+  friend class Prefetcher;
+
+ public:
+  /**
+   * Report that the consumer has reached a page. The consumer must have pinned the page itself before calling this.
+   * @param page_id the page the consumer is at
+   */
+  void Consume(page_id_t page_id);
+
+  /** @return the current read-ahead distance in pages */
+  size_t GetDistance();
+
+ private:
+  PrefetchStream(Prefetcher *prefetcher, BufferAccessStrategy *strategy)
+      : prefetcher_(prefetcher), strategy_(strategy) {}
+
+  /** @return true if the stream has a page to read and room in its window, must be called with the prefetcher latch */
+  bool NeedsRead() const;
+
+  Prefetcher *prefetcher_;
+  BufferAccessStrategy *strategy_;
+
+  /** For a page chain: returns the successor of a page, which is read latched during the call. */
+  std::function<page_id_t(Page *)> next_page_fn_;
+  /** For a page chain: the next page to read, INVALID_PAGE_ID at the end of the chain. */
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  /** For a page chain: the next page is only read to learn its successor, the consumer is already past it. */
+  bool skip_next_page_{false};
+
+  /** For a page list: the pages in consumption order and the index of the next one to read. */
+  std::vector<page_id_t> page_ids_;
+  size_t next_index_{0};
+
+  /** Pages read ahead and pinned by the prefetcher, in consumption order. */
+  std::deque<page_id_t> pinned_;
+  /** The page being read by the worker, INVALID_PAGE_ID if none. */
+  page_id_t in_flight_{INVALID_PAGE_ID};
+  /** The consumer reached the in-flight page before its read finished. */
+  bool in_flight_consumed_{false};
+  /** Bumped whenever the consumer overtakes the prefetcher and the read position moves. */
+  uint64_t position_version_{0};
+
+  size_t distance_{1};
+  /** Consecutive hits with a full window, used to shrink the distance when the consumer is slow. */
+  size_t idle_hits_{0};
+  /** The buffer pool had no frame left for the next page; retried on the next Consume. */
+  bool stalled_{false};
+  bool closed_{false};
+};
+
+/**
+ * Prefetcher is a read-ahead service for sequential consumers such as table heap scans. A single background thread
+ * reads the pages of every open stream ahead of its consumer into the buffer pool and keeps them pinned until they
+ * are consumed, so that the consumer's I/O overlaps with its processing.
+ *
+ * The read-ahead distance of every stream adapts to its consumer: it doubles whenever the consumer has to wait for a
+ * page, up to the maximum distance, and shrinks by one after the consumer has repeatedly found the window full.
+ *
+ * All streams must be released before the prefetcher is destroyed.
+ */
+class Prefetcher {
+  friend class PrefetchStream;
+
+ public:
+  /**
+   * Creates a new Prefetcher and starts its worker thread.
+   * @param bpm the buffer pool manager pages are read into
+   * @param max_distance the maximum number of pages a stream keeps pinned ahead of its consumer
+   */
+  explicit Prefetcher(BufferPoolManager *bpm, size_t max_distance = PREFETCH_MAX_DISTANCE);
+
+  /**
+   * Stops the worker thread and unpins every page that is still read ahead.
+   */
+  ~Prefetcher();
+
+  DISALLOW_COPY_AND_MOVE(Prefetcher);
+
+  /**
+   * Read ahead along a chain of pages, e.g. the pages of a table heap.
+   * @param first_page_id the first page of the chain
+   * @param next_page_fn returns the successor of a page, INVALID_PAGE_ID at the end of the chain
+   * @param strategy the access strategy the pages are read with, or nullptr. It must outlive the stream.
+   * @return the stream
+   */
+  std::shared_ptr<PrefetchStream> PrefetchChain(page_id_t first_page_id, std::function<page_id_t(Page *)> next_page_fn,
+                                                BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Read ahead a list of pages in order.
+   * @param page_ids the pages in the order they will be consumed
+   * @param strategy the access strategy the pages are read with, or nullptr. It must outlive the stream.
+   * @return the stream
+   */
+  std::shared_ptr<PrefetchStream> PrefetchPages(std::vector<page_id_t> page_ids,
+                                                BufferAccessStrategy *strategy = nullptr);
+
+  /** @return the maximum number of pages a stream keeps pinned ahead of its consumer */
+  size_t GetMaxDistance() const { return max_distance_; }
+
+ private:
+  /** Wrap a new stream so that releasing it closes it. */
+  std::shared_ptr<PrefetchStream> Open(PrefetchStream *stream);
+
+  /** Stop the read-ahead of a stream and unpin its pages. */
+  void Close(PrefetchStream *stream);
+
+  /** Main loop of the worker thread. */
+  void RunWorker();
+
+  BufferPoolManager *bpm_;
+  size_t max_distance_;
+  /** Protects the state of every stream and the list of streams. */
+  std::mutex latch_;
+  /** Signalled whenever a stream may need a read, or on shutdown. */
+  std::condition_variable cv_;
+  /** Signalled whenever the worker has finished a read. */
+  std::condition_variable read_done_cv_;
+  std::list<PrefetchStream *> streams_;
+  bool enable_worker_{true};
+  std::thread worker_;
+};
+
+}  // namespace bustub
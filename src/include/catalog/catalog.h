@@ -35,6 +35,9 @@ using table_oid_t = uint32_t;
 using column_oid_t = uint32_t;
 using index_oid_t = uint32_t;
 
+/** The kinds of index that the catalog can create */
+enum class IndexType { EXTENDIBLE_HASH, B_PLUS_TREE };
+
 /**
  * The TableInfo class maintains metadata about a table.
  */
@@ -187,12 +190,18 @@ class Catalog {
    * @param key_attrs Key attributes
    * @param keysize Size of the key
    * @param hash_function The hash function for the index
+   * @param index_type The kind of index; a B+ tree is bulk loaded from the sorted keys of the table
+   * @param key_compression How a B+ tree stores the keys in its nodes
+   * @param key_format How the index stores its keys; NORMALIZED keys are compared with memcmp
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
-                         std::size_t keysize, HashFunction<KeyType> hash_function) {
+                         std::size_t keysize, HashFunction<KeyType> hash_function,
+                         IndexType index_type = IndexType::EXTENDIBLE_HASH,
+                         KeyCompression key_compression = KeyCompression::NONE,
+                         KeyFormat key_format = KeyFormat::TUPLE) {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
@@ -209,20 +218,33 @@ class Catalog {
     }
 
     // Construct index metdata
-    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
-
-    // Construct the index, take ownership of metadata
-    // TODO(Kyle): We should update the API for CreateIndex
-    // to allow specification of the index type itself, not
-    // just the key, value, and comparator types
-    auto index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
-                                                                                               hash_function);
+    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs, key_format);
 
-    // Populate the index with all tuples in table heap
+    // Construct the index, take ownership of metadata, and populate it with all tuples in table heap
+    std::unique_ptr<Index> index;
     auto *table_meta = GetTable(table_name);
     auto *heap = table_meta->table_.get();
-    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
-      index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
+    BufferAccessStrategy strategy;
+    if (index_type == IndexType::B_PLUS_TREE) {
+      auto tree_index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                          key_compression);
+      auto tuple = heap->Begin(txn, &strategy);
+      tree_index->BulkLoad([&](Tuple *key, RID *rid) {
+        if (tuple == heap->End()) {
+          return false;
+        }
+        *key = tuple->KeyFromTuple(schema, key_schema, key_attrs);
+        *rid = tuple->GetRid();
+        ++tuple;
+        return true;
+      });
+      index = std::move(tree_index);
+    } else {
+      index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                            hash_function);
+      for (auto tuple = heap->Begin(txn, &strategy); tuple != heap->End(); ++tuple) {
+        index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
+      }
     }
 
     // Get the next OID for the new index
@@ -25,7 +25,10 @@ extern std::chrono::milliseconds cycle_detection_interval;
 extern std::atomic<bool> enable_logging;
 
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
-extern std::chrono::duration<int64_t> log_timeout;
+extern std::chrono::milliseconds log_timeout;
+
+/** A running background writer cleans the frames next in line for eviction every BGWRITER_INTERVAL. */
+extern std::chrono::milliseconds bgwriter_interval;
 
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
@@ -34,7 +37,19 @@ static constexpr int HEADER_PAGE_ID = 0;                                      //
 static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
+static constexpr int LOG_SEGMENT_SIZE = 16 * LOG_BUFFER_SIZE;                 // log bytes per WAL segment file
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int LRUK_REPLACER_K = 2;                                     // history length of lru-k replacer
+static constexpr int LRUK_CORRELATED_REFERENCE_PERIOD = 8;                    // lru-k correlated reference window
+static constexpr int BULK_RING_SIZE = 4;                                      // frames per ring of bulk operations
+static constexpr int PREFETCH_MAX_DISTANCE = 4;                               // max pages read ahead by a scan
+static constexpr int BGWRITER_LOW_WATERMARK = 10;                             // % of frames bgwriter keeps clean
+static constexpr int EVICTION_LOG_LOOKAHEAD = 4;                              // dirty victims passed over for their log
+static constexpr int DOUBLE_WRITE_BATCH_SIZE = 64;                            // pages per double-write file batch
+static constexpr int ASYNC_IO_QUEUE_DEPTH = 32;                               // max async disk I/O requests in flight
+static constexpr int RECOVERY_REDO_WORKERS = 4;                               // threads replaying the log in redo
+static constexpr int EXTERNAL_SORT_BUFFER_PAGES = 64;                         // pages of entries sorted in memory
+static constexpr double BULK_LOAD_FILL_FACTOR = 0.9;                          // fraction of a node a bulk load fills
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
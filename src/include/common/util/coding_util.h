@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// coding_util.h
+//
+// Identification: src/include/common/util/coding_util.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * CodingUtil provides the variable-length integer encoding and the checksum of the compact log record format, and the
+ * codec of compressed log blocks.
+ */
+class CodingUtil {
+ public:
+  /** The maximum number of bytes of a varint-encoded 32-bit integer. */
+  static constexpr int MAX_VARINT32_LENGTH = 5;
+
+  /** @return the number of bytes value takes as a varint */
+  static inline int VarintLength(uint32_t value) {
+    int length = 1;
+    while (value >= 0x80) {
+      value >>= 7;
+      length++;
+    }
+    return length;
+  }
+
+  /**
+   * Write value as a varint: 7 bits per byte, least significant first, the high bit set on all but the last byte.
+   * @return the position after the varint
+   */
+  static inline char *PutVarint32(char *dest, uint32_t value) {
+    auto *pos = reinterpret_cast<uint8_t *>(dest);
+    while (value >= 0x80) {
+      *pos++ = static_cast<uint8_t>(value | 0x80);
+      value >>= 7;
+    }
+    *pos++ = static_cast<uint8_t>(value);
+    return reinterpret_cast<char *>(pos);
+  }
+
+  /**
+   * Read a varint written by PutVarint32.
+   * @return the position after the varint, or nullptr if it is longer than limit - src or than a 32-bit integer
+   */
+  static inline const char *GetVarint32(const char *src, const char *limit, uint32_t *value) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 7 * MAX_VARINT32_LENGTH && src < limit; shift += 7) {
+      auto byte = static_cast<uint8_t>(*src++);
+      result |= static_cast<uint32_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        *value = result;
+        return src;
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * Compute the CRC-32C (Castagnoli) checksum of a byte range, with the SSE 4.2 crc32 instruction where available.
+   * @param data the bytes
+   * @param size the number of bytes
+   * @param crc the checksum of the preceding bytes, to checksum several ranges as one
+   * @return the checksum
+   */
+  static uint32_t Crc32c(const char *data, size_t size, uint32_t crc = 0);
+
+  /**
+   * Compress a byte range with a byte-oriented LZ77 codec. The output is a series of sequences
+   * | literal length varint | literals | match length - LZ_MIN_MATCH varint | match offset varint |, where the last
+   * sequence ends after its literals. A match repeats the bytes that start match offset bytes before it.
+   * @param data the bytes
+   * @param size the number of bytes
+   * @param[out] dest the compressed bytes
+   * @param capacity the size of dest
+   * @return the number of compressed bytes, or 0 if they do not fit into capacity
+   */
+  static size_t Compress(const char *data, size_t size, char *dest, size_t capacity);
+
+  /**
+   * Decompress bytes written by Compress.
+   * @param src the compressed bytes
+   * @param src_size the number of compressed bytes
+   * @param[out] dest the decompressed bytes
+   * @param size the number of bytes the compressed ones decompress into
+   * @return true if src is valid and decompresses into exactly size bytes
+   */
+  static bool Decompress(const char *src, size_t src_size, char *dest, size_t size);
+
+ private:
+  /** The shortest match the codec emits: shorter ones cost about as much as their literals. */
+  static constexpr size_t LZ_MIN_MATCH = 4;
+  /** The codec finds matches through a hash table of 2^LZ_HASH_BITS recent 4-byte sequences. */
+  static constexpr int LZ_HASH_BITS = 13;
+};
+
+}  // namespace bustub
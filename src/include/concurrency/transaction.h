@@ -63,8 +63,8 @@ using index_oid_t = uint32_t;
  */
 class TableWriteRecord {
  public:
-  TableWriteRecord(RID rid, WType wtype, const Tuple &tuple, TableHeap *table)
-      : rid_(rid), wtype_(wtype), tuple_(tuple), table_(table) {}
+  TableWriteRecord(RID rid, WType wtype, const Tuple &tuple, TableHeap *table, lsn_t undo_next_lsn = INVALID_LSN)
+      : rid_(rid), wtype_(wtype), tuple_(tuple), table_(table), undo_next_lsn_(undo_next_lsn) {}
 
   RID rid_;
   WType wtype_;
@@ -72,6 +72,8 @@ class TableWriteRecord {
   Tuple tuple_;
   /** The table heap specifies which table this write record is for. */
   TableHeap *table_;
+  /** The LSN of the transaction's last log record before the write, where its rollback continues once undone. */
+  lsn_t undo_next_lsn_;
 };
 
 /**
@@ -246,6 +248,15 @@ class Transaction {
    */
   inline void SetPrevLSN(lsn_t prev_lsn) { prev_lsn_ = prev_lsn; }
 
+  /** @return the undo-next LSN of the CLR of the change being rolled back, while the transaction aborts */
+  inline lsn_t GetUndoNextLSN() { return undo_next_lsn_; }
+
+  /**
+   * Set the undo-next LSN for the CLR of the next change the rollback undoes.
+   * @param undo_next_lsn the LSN of the log record before the one of the undone change
+   */
+  inline void SetUndoNextLSN(lsn_t undo_next_lsn) { undo_next_lsn_ = undo_next_lsn; }
+
  private:
   /** The current transaction state. */
   TransactionState state_;
@@ -260,8 +271,10 @@ class Transaction {
   std::shared_ptr<std::deque<TableWriteRecord>> table_write_set_;
   /** The undo set of indexes. */
   std::shared_ptr<std::deque<IndexWriteRecord>> index_write_set_;
-  /** The LSN of the last record written by the transaction. */
-  lsn_t prev_lsn_;
+  /** The LSN of the last record written by the transaction. Atomic because checkpoints read it concurrently. */
+  std::atomic<lsn_t> prev_lsn_;
+  /** The undo-next LSN of the CLRs logged while the transaction rolls back. */
+  lsn_t undo_next_lsn_{INVALID_LSN};
 
   /** Concurrent index: the pages that were latched during index operation. */
   std::shared_ptr<std::deque<Page *>> page_set_;
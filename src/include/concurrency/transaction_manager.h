@@ -13,8 +13,11 @@
 #pragma once
 
 #include <atomic>
+#include <mutex>  // NOLINT
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
@@ -73,6 +76,15 @@ class TransactionManager {
     return res;
   }
 
+  /**
+   * Snapshot the active transaction table for a checkpoint. A transaction is in it from before its BEGIN record is
+   * appended until after its COMMIT or ABORT record is appended.
+   * @param[out] oldest_lsn if not null, set to the LSN of the oldest BEGIN record of the active transactions, or
+   * INVALID_LSN if none of them has one
+   * @return (transaction id, LSN of the transaction's last record) pairs
+   */
+  std::vector<std::pair<txn_id_t, lsn_t>> GetActiveTransactions(lsn_t *oldest_lsn = nullptr);
+
   /** Prevents all transactions from performing operations, used for checkpointing. */
   void BlockAllTransactions();
 
@@ -103,6 +115,11 @@ class TransactionManager {
 
   /** The global transaction latch is used for checkpointing. */
   ReaderWriterLatch global_txn_latch_;
+
+  /** The transactions that have begun and not yet committed or aborted, with the LSN of their BEGIN record. */
+  std::unordered_map<txn_id_t, std::pair<Transaction *, lsn_t>> active_txns_;
+  /** Protects active_txns_. Held across appending BEGIN, COMMIT and ABORT records, so snapshots match the log. */
+  std::mutex active_txns_latch_;
 };
 
 }  // namespace bustub
@@ -16,6 +16,7 @@
 #include <utility>
 #include <vector>
 
+#include "buffer/prefetcher.h"
 #include "catalog/catalog.h"
 #include "concurrency/transaction.h"
 #include "storage/page/tmp_tuple_page.h"
@@ -33,10 +34,16 @@ class ExecutorContext {
    * @param bpm The buffer pool manager that the executor uses
    * @param txn_mgr The transaction manager that the executor uses
    * @param lock_mgr The lock manager that the executor uses
+   * @param prefetcher The prefetcher that sequential scans read ahead with, nullptr to disable read-ahead
    */
   ExecutorContext(Transaction *transaction, Catalog *catalog, BufferPoolManager *bpm, TransactionManager *txn_mgr,
-                  LockManager *lock_mgr)
-      : transaction_(transaction), catalog_{catalog}, bpm_{bpm}, txn_mgr_(txn_mgr), lock_mgr_(lock_mgr) {}
+                  LockManager *lock_mgr, Prefetcher *prefetcher = nullptr)
+      : transaction_(transaction),
+        catalog_{catalog},
+        bpm_{bpm},
+        txn_mgr_(txn_mgr),
+        lock_mgr_(lock_mgr),
+        prefetcher_(prefetcher) {}
 
   ~ExecutorContext() = default;
 
@@ -60,6 +67,9 @@ class ExecutorContext {
   /** @return the transaction manager */
   TransactionManager *GetTransactionManager() { return txn_mgr_; }
 
+  /** @return the prefetcher, nullptr if read-ahead is disabled */
+  Prefetcher *GetPrefetcher() { return prefetcher_; }
+
  private:
   /** The transaction context associated with this executor context */
   Transaction *transaction_;
@@ -71,6 +81,8 @@ class ExecutorContext {
   TransactionManager *txn_mgr_;
   /** The lock manager associated with this executor context */
   LockManager *lock_mgr_;
+  /** The prefetcher associated with this executor context */
+  Prefetcher *prefetcher_;
 };
 
 }  // namespace bustub
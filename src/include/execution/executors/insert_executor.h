@@ -16,6 +16,7 @@
 #include <utility>
 #include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/insert_plan.h"
@@ -66,6 +67,8 @@ class InsertExecutor : public AbstractExecutor {
   TableHeap *table_heap_;
   uint32_t now_row_{0};
   std::vector<bustub::IndexInfo *> indexs_;
+  /** Every insert walks the table heap, keep the pages it visits in a small ring. */
+  BufferAccessStrategy strategy_;
 };
 
 }  // namespace bustub
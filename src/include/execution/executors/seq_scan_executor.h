@@ -14,6 +14,7 @@
 
 #include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
@@ -53,6 +54,11 @@ class SeqScanExecutor : public AbstractExecutor {
   Transaction *txn_;
   TableInfo *table_info_;
   TableHeap *table_heap_;
+  /**
+   * Keeps the pages of the scan in a small ring instead of spreading them over the whole buffer pool. The ring also
+   * has room for the pages the prefetcher holds ahead of the scan.
+   */
+  BufferAccessStrategy strategy_;
   TableIterator next_itr_;
 };
 }  // namespace bustub
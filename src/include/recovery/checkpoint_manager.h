@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <thread>  // NOLINT
+
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/transaction_manager.h"
 #include "recovery/log_manager.h"
@@ -19,7 +21,11 @@
 namespace bustub {
 
 /**
- * CheckpointManager creates consistent checkpoints by blocking all other transactions temporarily.
+ * CheckpointManager takes fuzzy checkpoints without blocking transactions. A checkpoint logs a CHECKPOINT_BEGIN
+ * record, then a CHECKPOINT_END record with snapshots of the active transaction table and the dirty page table, and
+ * writes the dirty pages back in the background. Tables too large for one log record start in CHECKPOINT_PART records
+ * before the CHECKPOINT_END record. Recovery only has to redo the log from the oldest recLSN in the dirty page table of
+ * the last complete checkpoint.
  */
 class CheckpointManager {
  public:
@@ -29,15 +35,20 @@ class CheckpointManager {
         log_manager_(log_manager),
         buffer_pool_manager_(buffer_pool_manager) {}
 
-  ~CheckpointManager() = default;
+  ~CheckpointManager();
 
+  /** Log a checkpoint and start writing back the dirty pages in the background. Does nothing without logging. */
   void BeginCheckpoint();
+
+  /** Wait until the dirty pages of the last checkpoint are written back. */
   void EndCheckpoint();
 
  private:
   TransactionManager *transaction_manager_ __attribute__((__unused__));
   LogManager *log_manager_ __attribute__((__unused__));
   BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  /** Writes back the dirty pages of the current checkpoint. */
+  std::thread flush_thread_;
 };
 
 }  // namespace bustub
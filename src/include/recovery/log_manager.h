@@ -13,9 +13,11 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>  // NOLINT
 #include <future>              // NOLINT
 #include <mutex>               // NOLINT
+#include <thread>              // NOLINT
 
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
@@ -23,22 +25,35 @@
 namespace bustub {
 
 /**
- * LogManager maintains a separate thread that is awakened whenever the log buffer is full or whenever a timeout
- * happens. When the thread is awakened, the log buffer's content is written into the disk log file.
+ * LogManager is a group-commit write-ahead log with two log buffers. Appenders reserve space in the active buffer with
+ * a single atomic operation on the append state, which hands out the LSN and the buffer offset together, so LSNs are
+ * assigned in buffer order. A separate flush thread seals the active buffer, swaps in the other one and writes and
+ * syncs the sealed buffer to the disk log file. It is awakened whenever a timeout happens, the active buffer is full,
+ * or a transaction forces the log to disk to commit. Every commit that arrives while a write is in progress is made
+ * durable by the next write, so concurrent commits share their log writes and syncs.
  */
 class LogManager {
  public:
-  explicit LogManager(DiskManager *disk_manager)
-      : next_lsn_(0), persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
-    flush_buffer_ = new char[LOG_BUFFER_SIZE];
+  /**
+   * Creates a new LogManager. LSNs continue after the last log record on disk.
+   * @param disk_manager the disk manager the log is written to
+   * @param log_buffer_size the size of each of the two log buffers in bytes
+   */
+  explicit LogManager(DiskManager *disk_manager, uint32_t log_buffer_size = LOG_BUFFER_SIZE)
+      : log_buffer_size_(log_buffer_size), disk_manager_(disk_manager) {
+    log_buffers_[0] = new char[log_buffer_size_];
+    log_buffers_[1] = new char[log_buffer_size_];
+    lsn_t next_lsn = FindNextLSN();
+    append_state_ = static_cast<uint64_t>(next_lsn) << LSN_SHIFT;
+    persistent_lsn_ = next_lsn - 1;
   }
 
   ~LogManager() {
-    delete[] log_buffer_;
-    delete[] flush_buffer_;
-    log_buffer_ = nullptr;
-    flush_buffer_ = nullptr;
+    StopFlushThread();
+    delete[] log_buffers_[0];
+    delete[] log_buffers_[1];
+    log_buffers_[0] = nullptr;
+    log_buffers_[1] = nullptr;
   }
 
   void RunFlushThread();
@@ -46,29 +61,84 @@ class LogManager {
 
   lsn_t AppendLogRecord(LogRecord *log_record);
 
-  inline lsn_t GetNextLSN() { return next_lsn_; }
-  inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
-  inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
-  inline char *GetLogBuffer() { return log_buffer_; }
+  /**
+   * Force the log to disk up to and including the given LSN, and block until it is durable. Calls that arrive while
+   * the flush thread is writing are served together by its next write.
+   * @param lsn the LSN that must be durable when this returns
+   */
+  void Flush(lsn_t lsn);
 
- private:
-  // TODO(students): you may add your own member variables
+  /**
+   * Delete the log segments that only hold records older than the given LSN, which recovery no longer needs.
+   * @param lsn the oldest LSN that must stay in the log
+   */
+  inline void TruncateLog(lsn_t lsn) { disk_manager_->TruncateLog(lsn); }
 
-  /** The atomic counter which records the next log sequence number. */
-  std::atomic<lsn_t> next_lsn_;
-  /** The log records before and including the persistent lsn have been written to disk. */
-  std::atomic<lsn_t> persistent_lsn_;
+  /** @return the maximum size of a log record, LSN fields included; recovery reads the log in LOG_BUFFER_SIZE chunks */
+  inline uint32_t GetMaxLogRecordSize() const { return std::min<uint32_t>(log_buffer_size_, LOG_BUFFER_SIZE); }
 
-  char *log_buffer_;
-  char *flush_buffer_;
+  inline lsn_t GetNextLSN() { return LSNOf(append_state_.load()); }
+  inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
+  inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
+  inline char *GetLogBuffer() { return log_buffers_[BufferIndexOf(append_state_.load())]; }
 
+ private:
+  /** The append state packs the next LSN (high 32 bits), the active buffer index (bit 31) and its offset. */
+  static constexpr int LSN_SHIFT = 32;
+  static constexpr uint64_t BUFFER_INDEX_BIT = uint64_t{1} << 31;
+  static constexpr uint64_t OFFSET_MASK = BUFFER_INDEX_BIT - 1;
+
+  static inline lsn_t LSNOf(uint64_t state) { return static_cast<lsn_t>(state >> LSN_SHIFT); }
+  static inline int BufferIndexOf(uint64_t state) { return (state & BUFFER_INDEX_BIT) != 0 ? 1 : 0; }
+  static inline uint32_t OffsetOf(uint64_t state) { return static_cast<uint32_t>(state & OFFSET_MASK); }
+
+  /** Serialize a log record into the log format documented in log_record.h. */
+  static void SerializeLogRecord(const LogRecord &log_record, char *dest);
+
+  /**
+   * @return the LSN after the last log record in the newest log segment, the start LSN of that segment if it holds no
+   * intact record, 0 if there is no log
+   */
+  lsn_t FindNextLSN();
+
+  /** Block until the active buffer has room for size more bytes, asking the flush thread to swap buffers. */
+  void WaitForRoom(uint32_t size);
+
+  /** Main loop of the flush thread. */
+  void RunFlushLoop();
+
+  /**
+   * Seal the active buffer and swap in the other one, must be called with latch_ held.
+   * @return true if the sealed buffer holds any log records
+   */
+  bool SwapBuffers(int *index, uint32_t *size, lsn_t *last_lsn);
+
+  /** The next LSN, the index of the active buffer and the number of bytes reserved in it. */
+  std::atomic<uint64_t> append_state_{0};
+  /** The log records before and including the persistent lsn have been written to disk and synced. */
+  std::atomic<lsn_t> persistent_lsn_{INVALID_LSN};
+
+  const uint32_t log_buffer_size_;
+  char *log_buffers_[2];
+  /** The number of bytes appenders have finished copying into each buffer. */
+  std::atomic<uint32_t> filled_[2] = {0, 0};
+
+  /** Protects the flush requests and buffer swaps below. */
   std::mutex latch_;
 
-  std::thread *flush_thread_ __attribute__((__unused__));
+  std::thread *flush_thread_{nullptr};
+  bool enable_flush_{false};
+  /** A committing transaction or a full buffer asks for a flush before the timeout. */
+  bool force_flush_{false};
 
+  /** Signalled to wake up the flush thread. */
   std::condition_variable cv_;
+  /** Signalled whenever the buffers have been swapped. */
+  std::condition_variable swap_cv_;
+  /** Signalled whenever the persistent LSN has advanced or the flush thread stops. */
+  std::condition_variable flushed_cv_;
 
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
 };
 
 }  // namespace bustub
@@ -14,8 +14,11 @@
 
 #include <cassert>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "common/util/coding_util.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -32,15 +35,26 @@ enum class LogRecordType {
   ABORT,
   /** Creating a new page in the table heap. */
   NEWPAGE,
+  /** The start of a fuzzy checkpoint. */
+  CHECKPOINT_BEGIN,
+  /** The end of a fuzzy checkpoint, with the active transaction table and the dirty page table. */
+  CHECKPOINT_END,
+  /** A compensation log record: the redo-only record of a change that undid an earlier change of its transaction. */
+  CLR,
+  /** A part of the tables of a fuzzy checkpoint that did not fit into its CHECKPOINT_END record. */
+  CHECKPOINT_PART,
 };
 
 /**
  * For every write operation on the table page, you should write ahead a corresponding log record.
  *
- * For EACH log record, HEADER is like (5 fields in common, 20 bytes in total).
- *---------------------------------------------
- * | size | LSN | transID | prevLSN | LogType |
- *---------------------------------------------
+ * For EACH log record, HEADER is like (3 fixed fields of 9 bytes in total, then 3 varints).
+ *-------------------------------------------------------------------
+ * | size | checksum | LogType | LSN | transID + 1 | LSN - prevLSN |
+ *-------------------------------------------------------------------
+ * size (4 bytes) is the size of the whole record and checksum (4 bytes) the CRC-32C of the rest of it, so that a
+ * torn or corrupt record at the end of the log is detected. transID and prevLSN are 0 if invalid. Since prevLSN is
+ * stored as the distance back from LSN, the three varints mostly take one or two bytes each.
  * For insert type log record
  *---------------------------------------------------------------
  * | HEADER | tuple_rid | tuple_size | tuple_data(char[] array) |
@@ -49,25 +63,52 @@ enum class LogRecordType {
  *----------------------------------------------------------------
  * | HEADER | tuple_rid | tuple_size | tuple_data(char[] array) |
  *---------------------------------------------------------------
- * For update type log record
- *-----------------------------------------------------------------------------------
- * | HEADER | tuple_rid | tuple_size | old_tuple_data | tuple_size | new_tuple_data |
- *-----------------------------------------------------------------------------------
+ * For update type log record, only the byte ranges the update changed, each with its offset in the old tuple, the
+ * lengths of its old and new bytes (all varints) and the bytes themselves
+ *-------------------------------------------------------------------------------------------------
+ * | HEADER | tuple_rid | range_count | (offset, old_length, new_length, old_bytes, new_bytes) ... |
+ *-------------------------------------------------------------------------------------------------
  * For new page type log record
- *--------------------------
- * | HEADER | prev_page_id |
- *--------------------------
+ *------------------------------------
+ * | HEADER | prev_page_id | page_id |
+ *------------------------------------
+ * For checkpoint begin type log record
+ *----------
+ * | HEADER |
+ *----------
+ * For checkpoint end type log record, every active transaction with the LSN of its latest log record and every dirty
+ * page with its recLSN, the LSN of its oldest change that may not be on disk
+ *-------------------------------------------------------------------------------------------
+ * | HEADER | txn_count | (txn_id, last_lsn) ... | page_count | (page_id, rec_lsn) ... |
+ *-------------------------------------------------------------------------------------------
+ * Tables too large for one log buffer are split: CHECKPOINT_PART records of the same layout hold the first entries and
+ * the CHECKPOINT_END record that follows them the rest.
+ * For compensation log record, the LSN of the next record of the transaction to undo (plus one, as a varint, 0 if
+ * there is none) and the type of the compensating change followed by the rest of a record of that type. A CLR is
+ * redone like the change it carries and never undone, so that an interrupted rollback resumes at undo_next_lsn.
+ *-------------------------------------------------------------------------------
+ * | HEADER | undo_next_lsn + 1 | change_type | rest of a record of change_type |
+ *-------------------------------------------------------------------------------
  */
 class LogRecord {
   friend class LogManager;
   friend class LogRecovery;
 
  public:
+  /** A byte range changed by an update: old_bytes_ at offset_ in the old tuple were replaced by new_bytes_. */
+  struct UpdateRange {
+    uint32_t offset_;
+    std::string old_bytes_;
+    std::string new_bytes_;
+  };
+
   LogRecord() = default;
 
   // constructor for Transaction type(BEGIN/COMMIT/ABORT)
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type)
-      : size_(HEADER_SIZE), txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type) {}
+      : txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type) {
+    size_ = HeaderSizeWithoutLSN();
+  }
 
   // constructor for INSERT/DELETE type
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, const RID &rid, const Tuple &tuple)
@@ -82,7 +123,7 @@ class LogRecord {
       delete_tuple_ = tuple;
     }
     // calculate log record size
-    size_ = HEADER_SIZE + sizeof(RID) + sizeof(int32_t) + tuple.GetLength();
+    size_ = HeaderSizeWithoutLSN() + sizeof(RID) + sizeof(int32_t) + tuple.GetLength();
   }
 
   // constructor for UPDATE type
@@ -93,25 +134,62 @@ class LogRecord {
         log_record_type_(log_record_type),
         update_rid_(update_rid),
         old_tuple_(old_tuple),
-        new_tuple_(new_tuple) {
-    // calculate log record size
-    size_ = HEADER_SIZE + sizeof(RID) + old_tuple.GetLength() + new_tuple.GetLength() + 2 * sizeof(int32_t);
+        new_tuple_(new_tuple),
+        update_ranges_(DiffTuples(old_tuple, new_tuple)) {
+    // calculate log record size, header size + rid + the changed byte ranges
+    size_ = HeaderSizeWithoutLSN() + sizeof(RID) + CodingUtil::VarintLength(update_ranges_.size());
+    for (const auto &range : update_ranges_) {
+      size_ += CodingUtil::VarintLength(range.offset_) + CodingUtil::VarintLength(range.old_bytes_.size()) +
+               CodingUtil::VarintLength(range.new_bytes_.size()) + range.old_bytes_.size() + range.new_bytes_.size();
+    }
   }
 
   // constructor for NEWPAGE type
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, page_id_t prev_page_id, page_id_t page_id)
-      : size_(HEADER_SIZE),
-        txn_id_(txn_id),
+      : txn_id_(txn_id),
         prev_lsn_(prev_lsn),
         log_record_type_(log_record_type),
         prev_page_id_(prev_page_id),
         page_id_(page_id) {
     // calculate log record size, header size + sizeof(prev_page_id) + sizeof(page_id)
-    size_ = HEADER_SIZE + sizeof(page_id_t) * 2;
+    size_ = HeaderSizeWithoutLSN() + sizeof(page_id_t) * 2;
+  }
+
+  // constructor for CHECKPOINT_END and CHECKPOINT_PART type
+  LogRecord(LogRecordType log_record_type, std::vector<std::pair<txn_id_t, lsn_t>> active_txns,
+            std::vector<std::pair<page_id_t, lsn_t>> dirty_pages)
+      : log_record_type_(log_record_type), active_txns_(std::move(active_txns)), dirty_pages_(std::move(dirty_pages)) {
+    // calculate log record size, header size + two counts + the table entries
+    size_ = HeaderSizeWithoutLSN() + 2 * sizeof(int32_t) +
+            (active_txns_.size() + dirty_pages_.size()) * 2 * sizeof(int32_t);
   }
 
   ~LogRecord() = default;
 
+  /**
+   * Split the tables of a checkpoint into CHECKPOINT_PART records followed by one CHECKPOINT_END record, each of them
+   * small enough to be appended to a log whose records may take up to max_size bytes.
+   * @param active_txns the active transaction table
+   * @param dirty_pages the dirty page table
+   * @param max_size the maximum size of a log record, LSN fields included
+   * @return the records in the order they must be appended
+   */
+  static std::vector<LogRecord> MakeCheckpointEnd(std::vector<std::pair<txn_id_t, lsn_t>> active_txns,
+                                                  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages,
+                                                  uint32_t max_size);
+
+  /**
+   * Turn a record of an INSERT/DELETE/UPDATE change into the compensation log record of that change.
+   * @param undo_next_lsn the LSN of the next record to undo, the prevLSN of the record the change undoes
+   */
+  void MakeCompensation(lsn_t undo_next_lsn) {
+    assert(log_record_type_ >= LogRecordType::INSERT && log_record_type_ <= LogRecordType::UPDATE);
+    change_type_ = log_record_type_;
+    log_record_type_ = LogRecordType::CLR;
+    undo_next_lsn_ = undo_next_lsn;
+    size_ += CodingUtil::VarintLength(undo_next_lsn_ + 1) + sizeof(char);
+  }
+
   inline Tuple &GetDeleteTuple() { return delete_tuple_; }
 
   inline RID &GetDeleteRID() { return delete_rid_; }
@@ -120,14 +198,35 @@ class LogRecord {
 
   inline RID &GetInsertRID() { return insert_rid_; }
 
+  /** The old and new tuples of an update are only known to the record it was logged with, not to a deserialized one. */
   inline Tuple &GetOriginalTuple() { return old_tuple_; }
 
   inline Tuple &GetUpdateTuple() { return new_tuple_; }
 
+  inline std::vector<UpdateRange> &GetUpdateRanges() { return update_ranges_; }
+
+  /**
+   * Apply the changed byte ranges of an UPDATE record to the tuple before the update.
+   * @param old_tuple the tuple before the update
+   * @return the tuple after the update
+   */
+  Tuple RedoUpdate(const Tuple &old_tuple) const { return ApplyUpdateRanges(old_tuple, true); }
+
+  /**
+   * Revert the changed byte ranges of an UPDATE record in the tuple after the update.
+   * @param new_tuple the tuple after the update
+   * @return the tuple before the update
+   */
+  Tuple UndoUpdate(const Tuple &new_tuple) const { return ApplyUpdateRanges(new_tuple, false); }
+
   inline RID &GetUpdateRID() { return update_rid_; }
 
   inline page_id_t GetNewPageRecord() { return prev_page_id_; }
 
+  inline std::vector<std::pair<txn_id_t, lsn_t>> &GetActiveTxns() { return active_txns_; }
+
+  inline std::vector<std::pair<page_id_t, lsn_t>> &GetDirtyPages() { return dirty_pages_; }
+
   inline int32_t GetSize() { return size_; }
 
   inline lsn_t GetLSN() { return lsn_; }
@@ -138,6 +237,13 @@ class LogRecord {
 
   inline LogRecordType &GetLogRecordType() { return log_record_type_; }
 
+  /** @return the type of the change a record makes, which for a CLR is the type of its compensating change */
+  inline LogRecordType GetChangeType() const {
+    return log_record_type_ == LogRecordType::CLR ? change_type_ : log_record_type_;
+  }
+
+  inline lsn_t GetUndoNextLSN() { return undo_next_lsn_; }
+
   // For debug purpose
   inline std::string ToString() const {
     std::ostringstream os;
@@ -152,7 +258,38 @@ class LogRecord {
   }
 
  private:
-  // the length of log record(for serialization, in bytes)
+  /** @return the size of the header without the LSN and prevLSN fields, which depend on the LSN */
+  int32_t HeaderSizeWithoutLSN() const { return HEADER_SIZE + CodingUtil::VarintLength(txn_id_ + 1); }
+
+  /** @return the serialized size of the record once it has the given LSN */
+  int32_t SizeWithLSN(lsn_t lsn) const {
+    return size_ + CodingUtil::VarintLength(lsn) +
+           CodingUtil::VarintLength(prev_lsn_ == INVALID_LSN ? 0 : lsn - prev_lsn_);
+  }
+
+  /**
+   * Compute the checksum of a serialized log record. It covers the whole record but the checksum field itself.
+   * @param data the serialized log record
+   * @param size the size of the record
+   * @return the checksum
+   */
+  static uint32_t Checksum(const char *data, int32_t size);
+
+  /** @return the LSN of a serialized log record */
+  static lsn_t GetSerializedLSN(const char *data) {
+    uint32_t lsn = 0;
+    CodingUtil::GetVarint32(data + HEADER_SIZE, data + HEADER_SIZE + CodingUtil::MAX_VARINT32_LENGTH, &lsn);
+    return static_cast<lsn_t>(lsn);
+  }
+
+  /** @return the byte ranges that differ between the old and the new tuple of an update */
+  static std::vector<UpdateRange> DiffTuples(const Tuple &old_tuple, const Tuple &new_tuple);
+
+  /** Turn the old tuple of an update into the new one if redo, the new one into the old one otherwise. */
+  Tuple ApplyUpdateRanges(const Tuple &tuple, bool redo) const;
+
+  // the length of log record(for serialization, in bytes); until the record is appended or deserialized, the LSN and
+  // prevLSN fields are left out, since their size depends on the LSN
   int32_t size_{0};
   // must have fields
   lsn_t lsn_{INVALID_LSN};
@@ -168,15 +305,29 @@ class LogRecord {
   RID insert_rid_;
   Tuple insert_tuple_;
 
-  // case3: for update operation
+  // case3: for update operation, only the changed byte ranges are serialized
   RID update_rid_;
   Tuple old_tuple_;
   Tuple new_tuple_;
+  std::vector<UpdateRange> update_ranges_;
 
   // case4: for new page operation
   page_id_t prev_page_id_{INVALID_PAGE_ID};
   page_id_t page_id_{INVALID_PAGE_ID};
-  static const int HEADER_SIZE = 20;
+
+  // case5: for checkpoint end
+  std::vector<std::pair<txn_id_t, lsn_t>> active_txns_;
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages_;
+
+  // case6: for compensation log record, the change is kept in the fields of its type
+  LogRecordType change_type_{LogRecordType::INVALID};
+  lsn_t undo_next_lsn_{INVALID_LSN};
+  /** The size of the fixed fields of the header: size, checksum and log type. */
+  static const int HEADER_SIZE = 9;
+  static const int CHECKSUM_OFFSET = 4;
+  static const int TYPE_OFFSET = 8;
+  /** The maximum size of the LSN and prevLSN fields. */
+  static const int MAX_LSN_FIELDS_SIZE = 2 * CodingUtil::MAX_VARINT32_LENGTH;
 };  // namespace bustub
 
 }  // namespace bustub
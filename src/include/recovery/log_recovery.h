@@ -13,22 +13,51 @@
 #pragma once
 
 #include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <unordered_map>
 
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
+#include "recovery/log_manager.h"
 #include "recovery/log_record.h"
 
 namespace bustub {
 
 /**
  * Read log file from disk, redo and undo.
+ *
+ * Redo first analyzes the log that has not been truncated to find the transactions that did not finish and the last
+ * complete checkpoint. It then reads the log again from the minimum recLSN of that checkpoint's dirty page table,
+ * sequentially in chunks of LOG_BUFFER_SIZE bytes, and hands every record to one of several redo workers, chosen by
+ * the page the record modifies. Each worker replays the records of its pages in LSN order, while different pages are
+ * replayed in parallel. Log records are checked against their checksums, so the log ends at a record a crash left torn.
+ *
+ * Undo then rolls back all transactions that did not finish in a single backward pass, latest record first across
+ * them. Given a log manager, every change it undoes is logged as a compensation log record (CLR), and a transaction
+ * rolled back completely gets its ABORT record. A CLR is redone but never undone: its undo-next LSN skips the changes
+ * that were undone before it, by an abort or by an earlier recovery that crashed, so no change is undone twice and
+ * repeated crashes do not repeat the undo work.
  */
 class LogRecovery {
  public:
-  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
-      : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), offset_(0) {
+  /**
+   * @param disk_manager the disk manager the log is read from
+   * @param buffer_pool_manager the buffer pool manager the pages are replayed in
+   * @param log_manager the log manager undo logs its CLRs with, which must be running its flush thread; undo logs
+   * nothing if it is nullptr
+   * @param num_redo_workers the number of threads that replay the log
+   */
+  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, LogManager *log_manager = nullptr,
+              size_t num_redo_workers = RECOVERY_REDO_WORKERS)
+      : disk_manager_(disk_manager),
+        buffer_pool_manager_(buffer_pool_manager),
+        log_manager_(log_manager),
+        num_redo_workers_(std::max<size_t>(1, num_redo_workers)),
+        offset_(0) {
     log_buffer_ = new char[LOG_BUFFER_SIZE];
   }
 
@@ -39,18 +68,61 @@ class LogRecovery {
 
   void Redo();
   void Undo();
-  bool DeserializeLogRecord(const char *data, LogRecord *log_record);
+
+  /**
+   * Deserialize a log record.
+   * @param data the serialized log record
+   * @param size the number of valid bytes at data
+   * @param[out] log_record the deserialized log record
+   * @return false if data does not hold a complete log record
+   */
+  bool DeserializeLogRecord(const char *data, int size, LogRecord *log_record);
 
  private:
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  /** A log record to replay on one page. */
+  struct RedoTask {
+    std::shared_ptr<LogRecord> log_record_;
+    page_id_t page_id_;
+  };
+
+  /** The queue of one redo worker. */
+  struct RedoWorker {
+    std::mutex latch_;
+    std::condition_variable cv_;
+    std::deque<RedoTask> tasks_;
+    bool done_{false};
+  };
+
+  /**
+   * Read the log from a file offset to its end, a log buffer at a time.
+   * @param offset the file offset of the first record
+   * @param on_record called with every record and its file offset
+   * @param on_buffer called after the records of every log buffer
+   */
+  void ScanLog(int64_t offset, const std::function<void(const std::shared_ptr<LogRecord> &, int64_t)> &on_record,
+               const std::function<void()> &on_buffer);
+
+  /** Main loop of a redo worker thread. */
+  void RunRedoWorker(RedoWorker *worker);
+
+  /** Replay a log record on one of the pages it modifies, unless the page already reflects it. */
+  void RedoOnPage(const LogRecord &log_record, page_id_t page_id);
+
+  /** Revert the change of a log record of an uncommitted transaction, and log the CLR of the reverting change. */
+  void UndoLogRecord(LogRecord *log_record);
+
+  DiskManager *disk_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  LogManager *log_manager_;
+  size_t num_redo_workers_;
 
   /** Maintain active transactions and its corresponding latest lsn. */
   std::unordered_map<txn_id_t, lsn_t> active_txn_;
   /** Mapping the log sequence number to log file offset for undos. */
-  std::unordered_map<lsn_t, int> lsn_mapping_;
+  std::unordered_map<lsn_t, int64_t> lsn_mapping_;
 
-  int offset_ __attribute__((__unused__));
+  /** The log offset of the data in the log buffer. */
+  int64_t offset_;
   char *log_buffer_;
 };
 
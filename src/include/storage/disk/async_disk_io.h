@@ -0,0 +1,149 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_io.h
+//
+// Identification: src/include/storage/disk/async_disk_io.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/uio.h>
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace bustub {
+
+/** A read or write of one page of the database file. */
+struct DiskRequest {
+  /** True for a write, false for a read. */
+  bool is_write_;
+  page_id_t page_id_;
+  /** The page contents to write, or the buffer to read into. It must stay valid until the request completes. */
+  char *data_;
+  /** Set to true once the request has completed, or to false on an I/O error. */
+  std::promise<bool> callback_;
+};
+
+/**
+ * AsyncDiskIO keeps many page reads and writes of a database file in flight at once. Requests are submitted in batches
+ * and complete asynchronously through the promise of each request.
+ *
+ * The requests go through io_uring: a batch costs a single system call, and a completion thread reaps the results.
+ * Where io_uring is not available, a pool of threads performs the requests with pread and pwrite instead.
+ *
+ * The file is opened with O_DIRECT if the file system supports it, bypassing the OS page cache. Page buffers that are
+ * not aligned for direct I/O are copied through an aligned bounce buffer.
+ */
+class AsyncDiskIO {
+ public:
+  /**
+   * Opens the database file for asynchronous I/O. The file must exist.
+   * @param file_name the database file
+   * @param queue_depth the maximum number of requests in flight, further submissions wait for a free slot
+   * @param use_io_uring false to use the pread/pwrite fallback even if io_uring is available
+   */
+  explicit AsyncDiskIO(const std::string &file_name, size_t queue_depth = ASYNC_IO_QUEUE_DEPTH,
+                       bool use_io_uring = true);
+
+  /**
+   * Waits for every request in flight and closes the file.
+   */
+  ~AsyncDiskIO();
+
+  DISALLOW_COPY_AND_MOVE(AsyncDiskIO);
+
+  /**
+   * Submit a batch of requests. Returns as soon as every request has been handed to the kernel or to a worker; the
+   * promise of each request is fulfilled once it has completed.
+   * @param requests the requests, moved from
+   */
+  void Submit(std::vector<DiskRequest> *requests);
+
+  /** @return true if requests go through io_uring, false if they are served by the pread/pwrite fallback */
+  bool UsesIOUring() const { return ring_fd_ >= 0; }
+
+  /** @return true if the file was opened with O_DIRECT */
+  bool UsesDirectIO() const { return direct_io_; }
+
+ private:
+  /** A submitted request, with the state it needs until it completes. */
+  struct InFlight {
+    DiskRequest request_;
+    /** The buffer handed to the kernel: request_.data_ or the bounce buffer. */
+    struct iovec iov_;
+    /** An aligned copy of the page for O_DIRECT, nullptr if request_.data_ is used directly. */
+    char *bounce_{nullptr};
+  };
+
+  /** Number of threads serving requests when io_uring is not available. */
+  static constexpr size_t FALLBACK_WORKERS = 4;
+
+  /** Set up the submission and completion rings. @return false if io_uring is not available */
+  bool SetUpRing(size_t queue_depth);
+
+  /** Push the requests onto the submission ring and enter them with one system call. */
+  void SubmitToRing(const std::vector<InFlight *> &batch);
+
+  /** Main loop of the completion thread of the ring. */
+  void RunReaper();
+
+  /** Main loop of a fallback worker thread. */
+  void RunWorker();
+
+  /** Finish a request with the result of its read or write, a negative errno on failure. */
+  void Complete(InFlight *in_flight, ssize_t result);
+
+  int fd_{-1};
+  bool direct_io_{false};
+  size_t queue_depth_;
+
+  /** Protects in_flight_ and, for the fallback, queue_ and shutdown_. */
+  std::mutex latch_;
+  /** Signalled whenever a request completes, or a fallback request is queued. */
+  std::condition_variable cv_;
+  /** Number of requests submitted and not yet completed. */
+  size_t in_flight_{0};
+
+  /** io_uring instance, -1 if the fallback is used. Submissions are serialized by submit_latch_. */
+  int ring_fd_{-1};
+  std::mutex submit_latch_;
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  unsigned *sq_head_{nullptr};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+  std::thread reaper_;
+
+  /** Requests waiting for a fallback worker. */
+  std::deque<InFlight *> queue_;
+  bool shutdown_{false};
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace bustub
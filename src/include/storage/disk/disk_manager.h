@@ -15,26 +15,93 @@
 #include <atomic>
 #include <fstream>
 #include <future>  // NOLINT
-#include <mutex>   // NOLINT
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/async_disk_io.h"
 
 namespace bustub {
 
+/** How a DiskManager reads and writes the pages of the database file. */
+enum class DiskIOBackend {
+  /** One buffered file stream, every request is served synchronously under a latch. */
+  FSTREAM,
+  /** A file descriptor accessed with positional pread/pwrite, so requests from different threads run in parallel. */
+  PREAD_PWRITE,
+  /** Many requests in flight at once through AsyncDiskIO: io_uring, or pread/pwrite if it is not available. */
+  ASYNC
+};
+
+/** How a DiskManager stores the log. */
+enum class LogCompression {
+  /** Log buffers are written as they are. */
+  NONE,
+  /** Every log buffer is written as one block, compressed with the LZ77 codec of CodingUtil. */
+  LZ
+};
+
+/** How a DiskManager protects the pages of the database file against torn writes and corruption. */
+enum class PageProtection {
+  /** Pages are written and read as they are. */
+  NONE,
+  /**
+   * A CRC-32C of every page written is kept in a checksum file next to the database file, and every page read is
+   * verified against it. This detects a torn page, but cannot repair it. The checksum file is not synced along with
+   * the pages, so after a crash a page whose checksum did not reach the disk is reported as a failure as well.
+   */
+  CHECKSUM,
+  /**
+   * Checksums, and every batch of pages is written to a double-write file and synced before it is written in place,
+   * so that the pages a crash tore are restored from their copies when the database is opened. Needs PREAD_PWRITE.
+   */
+  DOUBLE_WRITE
+};
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * The log is stored in segment files named after the log file with a sequence number appended, e.g. test.log.00000003.
+ * Every segment starts with a header that records its sequence number, the log offset of its first byte and the LSN of
+ * its first record. Log offsets count the bytes of the whole log, so they stay valid when old segments are truncated.
+ *
+ * With log compression, segments have a header with their own magic and hold one block per log write:
+ * | raw size (4) | stored size (4) | checksum (4) | stored bytes |, where a block that does not compress is stored as
+ * it is. Log offsets still count uncompressed bytes and ReadLog decompresses, so readers like LogRecovery do not see
+ * the blocks. A new segment is started whenever the newest one was written with the other setting.
+ *
+ * The checksums of the pages are stored in a file named after the database file with the extension .crc, four bytes
+ * per page id; 0 marks a page without a checksum. The double-write file has the extension .dwb and holds the last
+ * batch of pages written: a header page | magic (4) | number of pages (4) | header checksum (4) | followed by a
+ * | page id (4) | page checksum (4) | pair per page, then the pages themselves.
+ *
+ * The disk manager does not order page writes after the log. The buffer pool waits for the log to be synced up to the
+ * LSN of every page it writes (WriteLog syncs before it returns), so a page synced to the double-write file or the
+ * database file, and any page restored from the double-write file, never runs ahead of the durable log.
  */
 class DiskManager {
  public:
   /**
-   * Creates a new disk manager that writes to the specified database file.
+   * Creates a new disk manager that writes to the specified database file. If the database file does not exist yet,
+   * log segments left behind by an earlier database with the same name are deleted.
    * @param db_file the file name of the database file to write to
+   * @param io_backend how the pages of the database file are read and written
+   * @param log_segment_size the number of log bytes after which a new log segment is started
+   * @param page_protection how the pages are protected against torn writes
+   * @param log_compression how the log is written
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, DiskIOBackend io_backend = DiskIOBackend::PREAD_PWRITE,
+                       int64_t log_segment_size = LOG_SEGMENT_SIZE,
+                       PageProtection page_protection = PageProtection::NONE,
+                       LogCompression log_compression = LogCompression::NONE);
 
-  ~DiskManager() = default;
+  /** Closes the files that are still open. */
+  ~DiskManager() { ShutDown(); }
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -49,37 +116,124 @@ class DiskManager {
   void WritePage(page_id_t page_id, const char *page_data);
 
   /**
-   * Read a page from the database file.
+   * Read a page from the database file, and verify its checksum.
    * @param page_id id of the page
    * @param[out] page_data output buffer
    */
   void ReadPage(page_id_t page_id, char *page_data);
 
   /**
-   * Flush the entire log buffer into disk.
+   * Write several pages to the database file, with all of the writes in flight at once. Without the ASYNC backend,
+   * every run of consecutive page ids is written with a single sequential write, so callers sort the pages first.
+   * @param page_ids ids of the pages
+   * @param page_data raw data of each page
+   */
+  void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data);
+
+  /**
+   * Read several pages from the database file, with all of the reads in flight at once, and verify their checksums.
+   * @param page_ids ids of the pages
+   * @param[out] page_data output buffer of each page
+   */
+  void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data);
+
+  /**
+   * Start writing a page to the database file. The page data must stay unchanged until the write has completed.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   * @return a future that becomes true once the write has completed, or false on an I/O error
+   */
+  std::future<bool> WritePageAsync(page_id_t page_id, const char *page_data);
+
+  /**
+   * Start reading a page from the database file. With the ASYNC backend, the checksum of the page is not verified.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, which must not be touched until the read has completed
+   * @return a future that becomes true once the read has completed, or false on an I/O error
+   */
+  std::future<bool> ReadPageAsync(page_id_t page_id, char *page_data);
+
+  /**
+   * Flush the entire log buffer into disk. The data goes into a new segment if it does not fit into the current one.
+   * Returns once the data is synced, so the log records in it are durable.
    * @param log_data raw log data
    * @param size size of log entry
+   * @param first_lsn the LSN of the first log record in log_data, recorded in the header of a new segment
    */
-  void WriteLog(char *log_data, int size);
+  void WriteLog(char *log_data, int size, lsn_t first_lsn = INVALID_LSN);
 
   /**
-   * Read a log entry from the log file.
+   * Read a log entry from the log file. The part of the output buffer past the end of the log is zeroed.
    * @param[out] log_data output buffer
    * @param size size of the log entry
-   * @param offset offset of the log entry in the file
-   * @return true if the read was successful, false otherwise
+   * @param offset log offset of the log entry
+   * @return true if the read was successful, false if offset is past the end of the log or has been truncated
    */
-  bool ReadLog(char *log_data, int size, int offset);
+  bool ReadLog(char *log_data, int size, int64_t offset);
+
+  /**
+   * Delete the log segments whose log records all have LSNs below the given one. The newest segment is always kept.
+   * @param lsn the oldest LSN that must stay readable
+   */
+  void TruncateLog(lsn_t lsn);
+
+  /**
+   * Cut the log off at a log offset in its newest segment, e.g. to drop a record that a crash left torn.
+   * @param offset the log offset where the log ends from now on
+   */
+  void TruncateLogTail(int64_t offset);
+
+  /** @return the log offset of the oldest log byte that has not been truncated */
+  int64_t GetLogStartOffset();
+
+  /** @return the log offset after the newest log byte, 0 if there is no log */
+  int64_t GetLogEndOffset();
+
+  /** @return the log offset where the newest log segment starts, -1 if there is no log */
+  int64_t GetLastLogSegmentOffset();
+
+  /** @return the LSN of the first log record in the newest log segment, from its header; INVALID_LSN without log */
+  lsn_t GetLastLogSegmentStartLSN();
+
+  /** @return the number of bytes written to the log segment files, after compression */
+  int64_t GetNumLogBytesWritten() const;
+
+  /** @return the number of log segment files */
+  size_t GetNumLogSegments();
+
+  /**
+   * Delete all log segment files of a database, which must not be open.
+   * @param db_file the file name of the database file
+   */
+  static void RemoveLogFiles(const std::string &db_file);
 
   /** @return the number of disk flushes */
   int GetNumFlushes() const;
 
+  /** @return the number of syncs of the log segment files and their directory */
+  int GetNumLogSyncs() const;
+
   /** @return true iff the in-memory content has not been flushed yet */
   bool GetFlushState() const;
 
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the number of disk reads */
+  int GetNumReads() const;
+
+  /** @return the number of write requests to the database file, where a run of pages written at once counts once */
+  int GetNumWriteCalls() const;
+
+  /** @return the number of pages read whose checksum did not match */
+  int GetNumChecksumFailures() const;
+
+  /** @return the number of torn pages restored from the double-write file when the database was opened */
+  int GetNumRestoredPages() const;
+
+  /** @return the number of times a file was synced to make the pages written durable */
+  int GetNumSyncs() const;
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -90,19 +244,171 @@ class DiskManager {
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
  private:
-  int GetFileSize(const std::string &file_name);
-  // stream to write log file
-  std::fstream log_io_;
+  /** A block of a compressed log segment. */
+  struct LogBlock {
+    /** The log offset of the first byte of the block, relative to the start of its segment. */
+    int64_t offset_;
+    /** The position of the block header in the segment file. */
+    int64_t position_;
+    uint32_t raw_size_;
+    uint32_t stored_size_;
+  };
+
+  /** An open log segment file. */
+  struct LogSegment {
+    int64_t segment_no_;
+    lsn_t start_lsn_;
+    int fd_;
+    /** The number of log bytes after the header, uncompressed. */
+    int64_t size_;
+    /** The size of the segment file. */
+    int64_t file_size_;
+    bool compressed_;
+    /** The blocks of a compressed segment, in log order. */
+    std::vector<LogBlock> blocks_;
+  };
+
+  /** | magic (4) | start lsn (4) | segment number (8) | start offset (8) | */
+  static constexpr int LOG_SEGMENT_HEADER_SIZE = 24;
+  static constexpr uint32_t LOG_SEGMENT_MAGIC = 0x4c415742;
+  static constexpr uint32_t LOG_SEGMENT_COMPRESSED_MAGIC = 0x4c5a5742;
+  /** | raw size (4) | stored size (4) | checksum (4) | */
+  static constexpr int LOG_BLOCK_HEADER_SIZE = 12;
+  static constexpr uint32_t DOUBLE_WRITE_MAGIC = 0x44574246;
+  /** | magic (4) | number of pages (4) | header checksum (4) | */
+  static constexpr int DOUBLE_WRITE_HEADER_SIZE = 12;
+  static_assert(DOUBLE_WRITE_HEADER_SIZE + 8 * DOUBLE_WRITE_BATCH_SIZE <= PAGE_SIZE,
+                "The header of the double-write file must fit into a page.");
+
+  int64_t GetFileSize(const std::string &file_name);
+
+  /** @return the log file name of a database file, empty if it has no extension */
+  static std::string LogFileName(const std::string &db_file);
+
+  /** @return the name of a database file with its extension replaced, empty if it has no extension */
+  static std::string SiblingFileName(const std::string &db_file, const char *extension);
+
+  /** @return the checksum of a page, which is never 0 */
+  static uint32_t PageChecksum(const char *page_data);
+
+  /** @return the paths of the log segment files that exist for a log file name, with their sequence numbers */
+  static std::vector<std::pair<int64_t, std::string>> FindLogSegmentFiles(const std::string &log_name);
+
+  /** @return the file name of a log segment */
+  std::string LogSegmentName(int64_t segment_no) const;
+
+  /** Open the existing log segments, dropping files without a valid header. */
+  void OpenLogSegments();
+
+  /** Start a new log segment after the newest one, must be called with log_latch_ held. */
+  void AddLogSegment(lsn_t start_lsn);
+
+  /** Find the blocks of a compressed segment that is being opened, and cut off a last block that a crash tore. */
+  void ScanLogBlocks(LogSegment *segment);
+
+  /** Compress log data into a block at the end of a compressed segment, must be called with log_latch_ held. */
+  void AppendLogBlock(LogSegment *segment, const char *log_data, uint32_t size);
+
+  /**
+   * Read log bytes from one segment, must be called with log_latch_ held.
+   * @return false on an I/O error or a corrupted block
+   */
+  bool ReadLogSegment(const LogSegment &segment, char *log_data, int64_t segment_offset, int64_t count);
+
+  /**
+   * Decompress a block of a compressed segment into cached_block_, must be called with log_latch_ held.
+   * @return false on an I/O error or a corrupted block
+   */
+  bool LoadLogBlock(const LogSegment &segment, size_t index);
+
+  /** @return true if all size bytes at position were read */
+  static bool PreadFully(int fd, char *data, size_t size, int64_t position);
+
+  /**
+   * Write pages with consecutive ids to the database file in one request, without the ASYNC backend.
+   * @param first_page_id id of the first page
+   * @param page_data raw data of each page
+   * @param num_pages the number of pages
+   */
+  void WritePageRun(page_id_t first_page_id, const char *const *page_data, size_t num_pages);
+
+  /** Write pages with WritePageRun, one run of consecutive page ids at a time. */
+  void WritePageRuns(const page_id_t *page_ids, const char *const *page_data, size_t num_pages);
+
+  /**
+   * Write pages to the double-write file in batches. Every batch is synced there before it is written in place, and
+   * the database and checksum files are synced before the double-write file is overwritten by the next batch.
+   */
+  void DoubleWritePages(const page_id_t *page_ids, const char *const *page_data, size_t num_pages);
+
+  /** Read a page with pread, zero-filling what lies past the end of the database file. */
+  void PreadPage(page_id_t page_id, char *page_data);
+
+  /** Open the checksum file and load its checksums, or empty it if the database file is new. */
+  void OpenChecksumFile(bool new_db);
+
+  /** Store the checksums of pages with consecutive ids, in memory and in the checksum file. */
+  void RecordChecksums(page_id_t first_page_id, const char *const *page_data, size_t num_pages);
+
+  /** Count and report a page read whose checksum does not match the one stored for it. */
+  void VerifyChecksum(page_id_t page_id, const char *page_data);
+
+  /** Open the double-write file, or empty it if the database file is new. */
+  void OpenDoubleWriteFile(bool new_db);
+
+  /** Rewrite the pages of the last double-write batch that do not match their copies in the double-write file. */
+  void RestoreTornPages();
+
+  /** fdatasync a file. */
+  void SyncFile(int fd);
+
+  /** fdatasync a log segment file, or fsync it with its metadata, and count it as a log sync. */
+  void SyncLogFile(int fd, bool metadata);
+
+  /** fsync the directory of the log segment files, so that a segment created in it survives a crash. */
+  void SyncLogDirectory();
+
   std::string log_name_;
+  int64_t log_segment_size_;
+  /** The log segments, keyed by the log offset of their first byte. Protected by log_latch_. */
+  std::map<int64_t, LogSegment> log_segments_;
+  std::mutex log_latch_;
+  LogCompression log_compression_;
+  // The last log block decompressed, identified by its segment number and index; protected by log_latch_
+  std::vector<char> cached_block_;
+  int64_t cached_block_segment_no_{-1};
+  size_t cached_block_index_{0};
+  std::atomic<int64_t> num_log_bytes_written_{0};
   // stream to write db file
   std::fstream db_io_;
   std::string file_name_;
   int num_flushes_;
-  int num_writes_;
+  std::atomic<int> num_log_syncs_{0};
+  std::atomic<int> num_writes_;
+  std::atomic<int> num_reads_;
+  std::atomic<int> num_write_calls_{0};
   bool flush_log_;
   std::future<void> *flush_log_f_;
-  // With multiple buffer pool instances, need to protect file access
+  // With multiple buffer pool instances, need to protect file access through db_io_
   std::mutex db_io_latch_;
+  // Database file of the PREAD_PWRITE and ASYNC backends, -1 with FSTREAM or after shut down
+  int db_fd_{-1};
+  // Serves the page requests of the ASYNC backend, nullptr with FSTREAM or after shut down
+  std::unique_ptr<AsyncDiskIO> async_io_;
+
+  PageProtection page_protection_;
+  // The checksum of every page id, 0 if it has none; protected by checksum_latch_
+  std::vector<uint32_t> checksums_;
+  std::mutex checksum_latch_;
+  // The checksum file, -1 without checksums or after shut down
+  int checksum_fd_{-1};
+  // The double-write file, -1 without DOUBLE_WRITE or after shut down
+  int double_write_fd_{-1};
+  // Lets one batch at a time use the double-write file
+  std::mutex double_write_latch_;
+  std::atomic<int> num_checksum_failures_{0};
+  int num_restored_pages_{0};
+  std::atomic<int> num_syncs_{0};
 };
 
 }  // namespace bustub
@@ -10,8 +10,11 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "concurrency/transaction.h"
@@ -32,6 +35,15 @@ enum class LockType { READ, INSERT, DELETE, NOLOCK };
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * With KeyCompression PREFIX, all pages of the tree store the prefix that their
+ * keys share once, and keep their keys without trailing zero bytes, which lets
+ * a page hold many more short keys than whole GenericKeys. Separators in inner
+ * nodes are cut down to the shortest key that still separates the two leaves.
+ * Such pages are split when the next key does not fit, and their max size is
+ * only a bound on the number of entries, e.g. LEAF_PAGE_PREFIX_SIZE. Removes
+ * do not merge or redistribute PREFIX pages while they hold entries, so they
+ * may become small, but free a leaf that becomes empty, see RemoveEmptyLeaf.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -40,7 +52,8 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     KeyCompression key_compression = KeyCompression::NONE);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -54,6 +67,12 @@ class BPlusTree {
   // return the value associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
+  // build an empty tree bottom up from key & value pairs sorted by key
+  bool BulkLoad(const std::function<bool(MappingType *)> &next, double fill_factor = BULK_LOAD_FILL_FACTOR);
+
+  // number of optimistic descents of GetValue and Begin(key) that a concurrent writer forced to restart
+  size_t GetNumOptimisticRestarts() const { return num_optimistic_restarts_; }
+
   // index iterator
   INDEXITERATOR_TYPE Begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
@@ -81,12 +100,53 @@ class BPlusTree {
                      Transaction *transcation = nullptr);
 
  private:
+  /** Optimistic descents that restart this often in a row fall back to latch crabbing. */
+  static constexpr int MAX_OPTIMISTIC_RESTARTS = 8;
+
+  Page *OptimisticFindLeafPage(const KeyType &key, char *copy, uint64_t *leaf_version, bool *restart);
+  BPlusTreePage *CopyNode(Page *page, char *copy);
+
+  using ChildList = std::vector<std::pair<KeyType, page_id_t>>;
+  /** The layout that the pending entries of a level of a bulk load would take in a PREFIX page. */
+  struct PendingLayout {
+    size_t prefix_size_{sizeof(KeyType)};
+    size_t key_end_{0};
+    /**
+     * Take the key as the next of size pending entries if they all fit into budget bytes.
+     * @param first the first pending key, or the key itself if there are none
+     * @return false if it does not fit, in which case nothing changes
+     */
+    bool Add(const KeyType &first, const KeyType &key, int size, size_t value_size, size_t budget);
+  };
+  /** A bulk load in progress. */
+  struct BulkLoadState {
+    /** Sorted entries that are not in a leaf yet. */
+    std::vector<MappingType> entries_;
+    /** children_[i] holds the nodes i levels above the leaves that have no parent yet, with their smallest key. */
+    std::vector<ChildList> children_;
+    /** The last leaf written, kept pinned until the next leaf is linked to it. */
+    Page *prev_leaf_{nullptr};
+    /** Every node written so far. */
+    std::vector<page_id_t> page_ids_;
+    int leaf_fill_;
+    int internal_fill_;
+    /** PREFIX trees fill their nodes up to a number of bytes instead, as far as it is tracked by these layouts. */
+    size_t leaf_budget_;
+    size_t internal_budget_;
+    PendingLayout leaf_layout_;
+    std::vector<PendingLayout> child_layouts_;
+  };
+  void BulkLoadLeaf(BulkLoadState *state, int count);
+  void BulkLoadInternal(BulkLoadState *state, size_t level, int count);
+  void BulkLoadAddChild(BulkLoadState *state, size_t level, const KeyType &key, page_id_t page_id);
   Page *FetchPage(page_id_t page_id, LockType lock_type = LockType::NOLOCK);
   Page *NewPage(page_id_t *page_id);
   int LuckyInsert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
   bool SadInsert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
   int LuckyRemove(const KeyType &key, Transaction *transaction = nullptr);
   void SadRemove(const KeyType &key, Transaction *transaction = nullptr);
+  void RemoveEmptyLeaf(Page *leaf_page, Transaction *transaction);
+  Page *FetchOuterLeaf(page_id_t page_id, size_t height, bool leftmost, Page **parent_page = nullptr);
   void PopLockedPage(LockType lock_type, Transaction *transcation);
   void UnpinPage(Page *page, bool dirty = false, LockType lock_type = LockType::NOLOCK);
   void StartNewTree(const KeyType &key, const ValueType &value);
@@ -96,6 +156,9 @@ class BPlusTree {
 
   template <typename N>
   N *Split(N *node);
+  template <typename N, typename V>
+  void SplitInsert(N *node, std::vector<std::pair<KeyType, V>> *items, int index);
+  KeyType Separator(const KeyType &left, const KeyType &right) const;
   template <typename N>
   bool IsSafe(N *node, LockType lock_type);
 
@@ -120,11 +183,14 @@ class BPlusTree {
   // member variable
   std::mutex mu_;
   std::string index_name_;
-  page_id_t root_page_id_;
+  // atomic so that optimistic readers can read it without mu_, which still serializes the writers
+  std::atomic<page_id_t> root_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  KeyCompression key_compression_;
+  std::atomic<size_t> num_optimistic_restarts_{0};
 };
 
 }  // namespace bustub
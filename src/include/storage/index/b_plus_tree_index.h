@@ -11,12 +11,14 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "storage/index/b_plus_tree.h"
+#include "storage/index/external_sort.h"
 #include "storage/index/index.h"
 
 namespace bustub {
@@ -26,7 +28,13 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
+  /**
+   * Create a new BPlusTreeIndex.
+   * @param key_compression PREFIX stores the keys of each node prefix compressed, so that a node holds as many entries
+   * as fit into its page
+   */
+  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                 KeyCompression key_compression = KeyCompression::NONE);
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
@@ -34,6 +42,14 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /**
+   * Fill the empty index from (key, rid) pairs in any order. They are sorted with an external sort that spills to
+   * the buffer pool, and the tree is then bulk loaded bottom up.
+   * @param next produces the next pair, returns false once there are no more
+   * @return false if the index is not empty
+   */
+  bool BulkLoad(const std::function<bool(Tuple *key, RID *rid)> &next);
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
@@ -43,6 +59,8 @@ class BPlusTreeIndex : public Index {
  protected:
   // comparator for key
   KeyComparator comparator_;
+  // buffer pool that holds the tree and the runs of a bulk load
+  BufferPoolManager *buffer_pool_manager_;
   // container
   BPlusTree<KeyType, ValueType, KeyComparator> container_;
 };
@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort.h
+//
+// Identification: src/include/storage/index/external_sort.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define EXTERNAL_SORT_TYPE ExternalSort<KeyType, ValueType, KeyComparator>
+
+/**
+ * ExternalSort sorts (key, value) entries that need not fit in memory, e.g. to bulk load a B+ tree.
+ *
+ * Added entries are collected in a buffer of a few pages. A full buffer is sorted and written out as a run of buffer
+ * pool pages; the pages go through a ring of frames, so that a large sort does not flush the rest of the pool. Once
+ * all entries are added, Next merges the runs, which pins the current page of every run. A merge may pin at most half
+ * of the frames of the pool, so Finish first merges groups of that many runs into longer runs, in as many passes as it
+ * takes. Entries with equal keys come out in the order they were added. If all entries fit into the buffer, nothing
+ * is written at all.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExternalSort {
+ public:
+  /**
+   * Create a new ExternalSort.
+   * @param buffer_pool_manager the buffer pool that holds the runs
+   * @param comparator the key comparator
+   * @param buffer_pages the number of pages of entries that are sorted in memory at a time
+   */
+  ExternalSort(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+               size_t buffer_pages = EXTERNAL_SORT_BUFFER_PAGES);
+
+  /** Unpin and delete all the pages of the runs. */
+  ~ExternalSort();
+
+  DISALLOW_COPY_AND_MOVE(ExternalSort);
+
+  /** Add an entry. Must not be called after Finish. */
+  void Add(const KeyType &key, const ValueType &value);
+
+  /** Sort the entries that are left in memory and start the merge. */
+  void Finish();
+
+  /**
+   * Get the next entry in key order. Must only be called after Finish.
+   * @param[out] item the entry
+   * @return false once all entries have been returned
+   */
+  bool Next(MappingType *item);
+
+  /** @return the number of runs written out of the buffer, 0 if all entries were sorted in memory */
+  size_t GetNumRuns() const { return num_runs_; }
+
+  /** @return the number of merge passes that wrote longer runs before the final merge */
+  size_t GetNumMergePasses() const { return num_merge_passes_; }
+
+ private:
+  static constexpr size_t ENTRIES_PER_PAGE = PAGE_SIZE / sizeof(MappingType);
+
+  /** A sorted run of entries, stored in buffer pool pages of ENTRIES_PER_PAGE entries each. */
+  struct Run {
+    std::vector<page_id_t> page_ids_;
+    /** The number of entries in the run. */
+    size_t size_{0};
+    /** The index of the next entry to merge. */
+    size_t position_{0};
+    /** The page that holds the next entry, pinned while the run is merged. */
+    Page *page_{nullptr};
+  };
+
+  /** Sort the buffer and write it out as a new run. */
+  void SpillBuffer();
+
+  /** @return the next entry of a run that is being merged */
+  const MappingType &Head(const Run &run) const {
+    return reinterpret_cast<const MappingType *>(run.page_->GetData())[run.position_ % ENTRIES_PER_PAGE];
+  }
+
+  /** Pin the first page of the runs [first, last) and build the merge heap of them. */
+  void StartMerge(size_t first, size_t last);
+
+  /**
+   * Take the smallest next entry of the runs that are being merged.
+   * @param[out] item the entry
+   * @return false once the runs are merged
+   */
+  bool NextMerged(MappingType *item);
+
+  /** Merge groups of merge_fan_in_ runs into longer runs until there are no more than merge_fan_in_ runs left. */
+  void MergePass();
+
+  /** Move a run to its next entry, unpinning and deleting the pages it is done with. */
+  void Advance(Run *run);
+
+  /** Order of the merge heap: the run with the smallest next entry comes first, earlier runs first on ties. */
+  bool RunAfter(size_t lhs, size_t rhs) const;
+
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  /** The ring that the run pages go through. */
+  BufferAccessStrategy strategy_;
+  size_t buffer_capacity_;
+  /** The maximum number of runs merged at once. */
+  size_t merge_fan_in_;
+  /** Entries not written out yet; after Finish without runs, the sorted entries themselves. */
+  std::vector<MappingType> buffer_;
+  size_t buffer_position_{0};
+  std::vector<Run> runs_;
+  /** Heap of the runs that still have entries, ordered by RunAfter. */
+  std::vector<size_t> merge_heap_;
+  bool finished_{false};
+  size_t num_runs_{0};
+  size_t num_merge_passes_{0};
+};
+
+}  // namespace bustub
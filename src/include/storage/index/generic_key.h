@@ -12,8 +12,11 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstring>
 
+#include "storage/index/integer_key_search.h"
+#include "storage/index/normalized_key.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -35,6 +38,16 @@ class GenericKey {
     memcpy(data_, tuple.GetData(), tuple.GetLength());
   }
 
+  /** Set the key from a key tuple, stored in the given format. */
+  inline void SetFromKey(const Tuple &tuple, const Schema *key_schema, KeyFormat key_format) {
+    if (key_format == KeyFormat::TUPLE) {
+      SetFromKey(tuple);
+      return;
+    }
+    memset(data_, 0, KeySize);
+    NormalizedKey::Encode(tuple, key_schema, data_, KeySize);
+  }
+
   // NOTE: for test purpose only
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
@@ -72,11 +85,23 @@ class GenericKey {
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * Keys of a single integer column are compared as integers directly, without
+ * going through Value. NULL sorts first then, as its integer is the smallest.
+ * NORMALIZED keys are compared with memcmp.
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline int operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const {
+    if (key_format_ == KeyFormat::NORMALIZED) {
+      return memcmp(lhs.data_, rhs.data_, KeySize);
+    }
+    if (integer_key_width_ != 0) {
+      int64_t lhs_integer = IntegerKeySearch::Normalize(lhs.data_, integer_key_width_);
+      int64_t rhs_integer = IntegerKeySearch::Normalize(rhs.data_, integer_key_width_);
+      return lhs_integer < rhs_integer ? -1 : static_cast<int>(lhs_integer > rhs_integer);
+    }
     uint32_t column_count = key_schema_->GetColumnCount();
 
     for (uint32_t i = 0; i < column_count; i++) {
@@ -94,13 +119,30 @@ class GenericComparator {
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  GenericComparator(const GenericComparator &other)
+      : key_schema_{other.key_schema_},
+        key_format_{other.key_format_},
+        integer_key_width_{other.integer_key_width_} {}
 
   // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  explicit GenericComparator(Schema *key_schema, KeyFormat key_format = KeyFormat::TUPLE)
+      : key_schema_(key_schema), key_format_(key_format) {
+    if (key_format != KeyFormat::TUPLE || key_schema->GetColumnCount() != 1) {
+      return;
+    }
+    TypeId type = key_schema->GetColumn(0).GetType();
+    if (type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT) {
+      integer_key_width_ = std::min<size_t>(Type::GetTypeSize(type), KeySize);
+    }
+  }
+
+  /** @return the width of the key if it is a single integer column, which IntegerKeySearch can search; 0 if not */
+  inline size_t GetIntegerKeyWidth() const { return integer_key_width_; }
 
  private:
   Schema *key_schema_;
+  KeyFormat key_format_;
+  size_t integer_key_width_{0};
 };
 
 }  // namespace bustub
@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "storage/index/normalized_key.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -43,10 +44,14 @@ class IndexMetadata {
    * @param table_name The name of the table on which the index is created
    * @param tuple_schema The schema of the indexed key
    * @param key_attrs The mapping from indexed columns to base table columns
+   * @param key_format How the index stores its keys
    */
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, KeyFormat key_format = KeyFormat::TUPLE)
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        key_format_(key_format) {
     key_schema_ = Schema::CopySchema(tuple_schema, key_attrs_);
   }
 
@@ -61,6 +66,9 @@ class IndexMetadata {
   /** @return A schema object pointer that represents the indexed key */
   inline Schema *GetKeySchema() const { return key_schema_; }
 
+  /** @return How the index stores its keys */
+  inline KeyFormat GetKeyFormat() const { return key_format_; }
+
   /**
    * @return The number of columns inside index key (not in tuple key)
    *
@@ -94,6 +102,8 @@ class IndexMetadata {
   const std::vector<uint32_t> key_attrs_;
   /** The schema of the indexed key */
   Schema *key_schema_;
+  /** How the index stores its keys */
+  KeyFormat key_format_;
 };
 
 /////////////////////////////////////////////////////////////////////
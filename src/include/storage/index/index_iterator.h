@@ -47,12 +47,17 @@ class IndexIterator {
   bool operator!=(const IndexIterator &itr) const { return !operator==(itr); }
 
  private:
+  // move on to the next leaf while the index is past the end of the current one, which may be empty
+  void SkipFinishedLeaves();
+
   // add your own private member variables here
   Page *page_;
   LeafPage *cur_node_;
   int cur_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   int now_index_;
+  // the current item, copied out of the leaf as a PREFIX leaf does not store it as a whole
+  MappingType item_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// integer_key_search.h
+//
+// Identification: src/include/storage/index/integer_key_search.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace bustub {
+
+/**
+ * IntegerKeySearch searches the sorted keys of a B+ tree page whose key is a single integer column, without going
+ * through Value and the type system for every probe.
+ *
+ * Keys are compared in a normalized form: the little-endian integer of 1, 2, 4 or 8 bytes is moved to the top of an
+ * int64_t, which keeps its sign and order, so that keys of every width compare as plain int64_t. The search narrows
+ * the range with a branchless binary search and scans the last few keys linearly, with AVX2 where it is available.
+ */
+class IntegerKeySearch {
+ public:
+  /** The number of keys left at which the binary search stops and the linear scan takes over. */
+  static constexpr int LINEAR_SEARCH_SIZE = 16;
+
+  /** @return the normalized form of the integer of width bytes at key */
+  static inline int64_t Normalize(const char *key, size_t width) {
+    uint64_t value = 0;
+    memcpy(&value, key, width);
+    return static_cast<int64_t>(value << (64 - 8 * width));
+  }
+
+  /**
+   * Search count sorted keys of width bytes, the first at data and each next one stride bytes after the one before.
+   * At least 8 bytes must be readable from every key.
+   * @param key the normalized key to search for
+   * @param upper whether to find the first key greater than key, rather than the first key not less than it
+   * @return the index of the key found, count if there is none
+   */
+  static int Search(const char *data, size_t stride, int count, size_t width, int64_t key, bool upper);
+
+ private:
+  /** @return the number of the count keys from data on that are less than key, or not greater if upper */
+  static int CountBelow(const char *data, size_t stride, int count, size_t width, int64_t key, bool upper);
+};
+
+}  // namespace bustub
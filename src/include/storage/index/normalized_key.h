@@ -0,0 +1,46 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// normalized_key.h
+//
+// Identification: src/include/storage/index/normalized_key.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "catalog/schema.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * How an index stores its keys.
+ * TUPLE: the bytes of the key tuple, compared column by column through Value.
+ * NORMALIZED: the encoding of NormalizedKey, compared with memcmp.
+ */
+enum class KeyFormat { TUPLE = 0, NORMALIZED };
+
+/**
+ * NormalizedKey encodes a key tuple into bytes whose memcmp order is the order of the key, column by column:
+ *  - integers are big-endian with the sign bit flipped,
+ *  - decimals are the bits of the double, all flipped for negative ones and only the sign bit for the others,
+ *  - varchars are their characters, each zero byte followed by 0xff, and 0x00 0x01 at the end; 0x00 0x00 is NULL.
+ * NULL integers, booleans and decimals sort first, as their values are the smallest of their types.
+ * The encoding of a key is never a prefix of the encoding of a different one, so keys padded with zeros compare alike.
+ */
+class NormalizedKey {
+ public:
+  /**
+   * Encode the key into dest, cut at capacity bytes; keys that differ only after that compare equal then.
+   * @return the length of the whole encoding, which may be larger than capacity
+   */
+  static size_t Encode(const Tuple &key, const Schema *key_schema, char *dest, size_t capacity);
+};
+
+}  // namespace bustub
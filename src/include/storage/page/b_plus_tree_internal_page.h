@@ -11,14 +11,18 @@
 #pragma once
 
 #include <queue>
+#include <utility>
+#include <vector>
 
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 24
+#define INTERNAL_PAGE_HEADER_SIZE 32
 #define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+// a PREFIX internal page holds at most this many entries, each of which takes its page id and one key byte at least
+#define INTERNAL_PAGE_PREFIX_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(page_id_t) + 1))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -31,17 +35,31 @@ namespace bustub {
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * With KeyCompression PREFIX, the entries are stored as described in KeyPrefixEntries instead, first key included,
+ * and the page can be full before it reaches max size: see HasRoomFor. MoveAllTo, MoveFirstToEndOf and
+ * MoveLastToFrontOf, which only merges and redistributions use, support NONE pages only.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
   // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE,
+            KeyCompression key_compression = KeyCompression::NONE);
 
   KeyType KeyAt(int index) const;
+  std::vector<MappingType> GetItems() const;
+  // whether the key can be inserted without a split, and whether any count more keys could
+  bool HasRoomFor(const KeyType &key) const;
+  bool HasRoomForAny(int count) const;
+  // bytes of the page in use, header included
+  size_t GetUsedBytes() const;
+  // whether the items fit into one PREFIX page
+  static bool PrefixItemsFit(const MappingType *items, int size);
   void SetKeyAt(int index, const KeyType &key);
   int ValueIndex(const ValueType &value) const;
   ValueType ValueAt(int index) const;
+  void SetValueAt(int index, const ValueType &value);
 
   ValueType Lookup(const KeyType &key, const KeyComparator &comparator) const;
   void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
@@ -56,11 +74,20 @@ class BPlusTreeInternalPage : public BPlusTreePage {
                         BufferPoolManager *buffer_pool_manager);
   void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                          BufferPoolManager *buffer_pool_manager);
+  void CopyNFrom(const MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
+  void SetItems(const MappingType *items, int size);
 
  private:
+  using PrefixEntries = KeyPrefixEntries<KeyType, ValueType>;
+  static constexpr size_t CAPACITY = PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE;
+
+  bool IsPrefixPage() const { return GetKeyCompression() == KeyCompression::PREFIX; }
+  char *Data() { return reinterpret_cast<char *>(array_); }
+  const char *Data() const { return reinterpret_cast<const char *>(array_); }
+  int CompareAt(int index, const KeyType &key, const KeyComparator &comparator) const;
+  // on NONE pages, keys of a single integer column are searched by IntegerKeySearch
   int UpperBound(int l, int r, const KeyType &key, const KeyComparator &comparator) const;
   int LowerBound(int l, int r, const KeyType &key, const KeyComparator &comparator) const;
-  void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
   void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
   void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
   MappingType array_[0];
@@ -18,8 +18,10 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
+#define LEAF_PAGE_HEADER_SIZE 36
 #define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+// a PREFIX leaf holds at most this many entries, each of which takes its value and one key byte at least
+#define LEAF_PAGE_PREFIX_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (sizeof(ValueType) + 1))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
@@ -31,26 +33,44 @@ namespace bustub {
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ *  Header format (size in byte, 36 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ *  --------------------------------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | KeyCompression (4) | KeyPrefixSize (2) | KeySuffixSize (2) |
+ *  --------------------------------------------------------------------------------------------
+ *  -----------------
+ * | NextPageId (4) |
+ *  -----------------
+ *
+ * With KeyCompression PREFIX, the entries are stored as described in KeyPrefixEntries instead, and the page can be
+ * full before it reaches max size: see HasRoomFor. MoveAllTo moves PREFIX entries only into a page that they fit
+ * into along with its own, e.g. an empty one. MoveFirstToEndOf and MoveLastToFrontOf, which only redistributions use,
+ * support NONE pages only.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE,
+            KeyCompression key_compression = KeyCompression::NONE);
   // helper methods
   page_id_t GetNextPageId() const;
   void SetNextPageId(page_id_t next_page_id);
   KeyType KeyAt(int index) const;
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
-  const MappingType &GetItem(int index);
+  MappingType GetItem(int index) const;
+  std::vector<MappingType> GetItems() const;
+
+  // whether the key can be inserted without a split, and whether any count more keys could
+  bool HasRoomFor(const KeyType &key) const;
+  bool HasRoomForAny(int count) const;
+  // bytes of the page in use, header included
+  size_t GetUsedBytes() const;
+  // whether the items fit into one PREFIX page
+  static bool PrefixItemsFit(const MappingType *items, int size);
 
   // insert and delete methods
   int Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
@@ -62,11 +82,20 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void MoveAllTo(BPlusTreeLeafPage *recipient);
   void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
+  void CopyNFrom(const MappingType *items, int size);
 
  private:
+  using PrefixEntries = KeyPrefixEntries<KeyType, ValueType>;
+  static constexpr size_t CAPACITY = PAGE_SIZE - LEAF_PAGE_HEADER_SIZE;
+
+  bool IsPrefixPage() const { return GetKeyCompression() == KeyCompression::PREFIX; }
+  char *Data() { return reinterpret_cast<char *>(array_); }
+  const char *Data() const { return reinterpret_cast<const char *>(array_); }
+  int CompareAt(int index, const KeyType &key, const KeyComparator &comparator) const;
+  ValueType ValueAt(int index) const;
+  // on NONE pages, keys of a single integer column are searched by IntegerKeySearch
   int UpperBound(int l, int r, const KeyType &key, const KeyComparator &comparator) const;
   int LowerBound(int l, int r, const KeyType &key, const KeyComparator &comparator) const;
-  void CopyNFrom(MappingType *items, int size);
   void CopyLastFrom(const MappingType &item);
   void CopyFirstFrom(const MappingType &item);
   page_id_t next_page_id_;
@@ -10,10 +10,13 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <climits>
 #include <cstdlib>
+#include <cstring>
 #include <string>
+#include <utility>
 
 #include "buffer/buffer_pool_manager.h"
 #include "storage/index/generic_key.h"
@@ -27,18 +30,53 @@ namespace bustub {
 // define page type enum
 enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
 
+/**
+ * How a B+ tree page stores its keys.
+ * NONE: every entry holds the whole key.
+ * PREFIX: the prefix that all keys of the page share is stored once, and each entry holds the rest of its key up to
+ * the last byte that is not zero in any key of the page. All entries of a page have the same width, which shrinks and
+ * grows with the keys of the page, so a page holds as many entries as fit into it rather than a fixed number.
+ */
+enum class KeyCompression : int32_t { NONE = 0, PREFIX };
+
+/** @return the number of leading bytes that the two keys share */
+template <typename KeyType>
+inline size_t KeyPrefixLength(const KeyType &lhs, const KeyType &rhs) {
+  const char *l = reinterpret_cast<const char *>(&lhs);
+  const char *r = reinterpret_cast<const char *>(&rhs);
+  size_t length = 0;
+  while (length < sizeof(KeyType) && l[length] == r[length]) {
+    length++;
+  }
+  return length;
+}
+
+/** @return the length of the key without its trailing zero bytes */
+template <typename KeyType>
+inline size_t KeyTrimmedLength(const KeyType &key) {
+  const char *data = reinterpret_cast<const char *>(&key);
+  size_t length = sizeof(KeyType);
+  while (length > 0 && data[length - 1] == 0) {
+    length--;
+  }
+  return length;
+}
+
 /**
  * Both internal and leaf page are inherited from this page.
  *
  * It actually serves as a header part for each B+ tree page and
  * contains information shared by both leaf page and internal page.
  *
- * Header format (size in byte, 24 bytes in total):
+ * Header format (size in byte, 32 bytes in total):
  * ----------------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  * ----------------------------------------------------------------------------
- * | ParentPageId (4) | PageId(4) |
+ * | ParentPageId (4) | PageId(4) | KeyCompression (4) | KeyPrefixSize (2) |
+ * ----------------------------------------------------------------------------
+ * | KeySuffixSize (2) |
  * ----------------------------------------------------------------------------
+ * KeyPrefixSize and KeySuffixSize describe the entries of PREFIX pages only.
  */
 class BPlusTreePage {
  public:
@@ -62,6 +100,14 @@ class BPlusTreePage {
 
   void SetLSN(lsn_t lsn = INVALID_LSN);
 
+  KeyCompression GetKeyCompression() const;
+  void SetKeyCompression(KeyCompression key_compression);
+
+  // the number of key bytes stored once for all entries, and the number of key bytes after them in each entry
+  int GetKeyPrefixSize() const;
+  int GetKeySuffixSize() const;
+  void SetKeyLayout(int prefix_size, int suffix_size);
+
  private:
   // member variable, attributes that both internal and leaf page share
   IndexPageType page_type_ __attribute__((__unused__));
@@ -70,6 +116,128 @@ class BPlusTreePage {
   int max_size_ __attribute__((__unused__));
   page_id_t parent_page_id_ __attribute__((__unused__));
   page_id_t page_id_ __attribute__((__unused__));
+  KeyCompression key_compression_ __attribute__((__unused__));
+  uint16_t key_prefix_size_ __attribute__((__unused__));
+  uint16_t key_suffix_size_ __attribute__((__unused__));
+};
+
+/**
+ * Reads and writes the entries of a PREFIX page, which start at data:
+ *  ------------------------------------------------------------------------------
+ * | KEY PREFIX | KEY SUFFIX(1) + VALUE(1) | ... | KEY SUFFIX(n) + VALUE(n) |
+ *  ------------------------------------------------------------------------------
+ * A key is its prefix, then its suffix, then zero bytes. The entries are not aligned, so they are only accessed through
+ * memcpy.
+ */
+template <typename KeyType, typename ValueType>
+class KeyPrefixEntries {
+ public:
+  using Item = std::pair<KeyType, ValueType>;
+
+  /** @return the bytes of size entries whose keys share prefix_size bytes and end after key_end bytes at most */
+  static size_t Bytes(size_t prefix_size, size_t key_end, int size) {
+    return prefix_size + size * (key_end - prefix_size + sizeof(ValueType));
+  }
+
+  /** @return the bytes that the entries of the page take; a page read without a latch may claim a negative size */
+  static size_t UsedBytes(const BPlusTreePage *page) {
+    return Bytes(page->GetKeyPrefixSize(), page->GetKeyPrefixSize() + page->GetKeySuffixSize(),
+                 std::max(page->GetSize(), 0));
+  }
+
+  /** @return the bytes that the entries of the page take with the key added, the page layout changed as needed */
+  static size_t BytesWith(const BPlusTreePage *page, const char *data, const KeyType &key) {
+    size_t prefix_size = page->GetKeyPrefixSize();
+    size_t key_end = std::max(prefix_size + page->GetKeySuffixSize(), KeyTrimmedLength(key));
+    if (page->GetSize() > 0) {
+      prefix_size = std::min(prefix_size, SharedLength(data, key, prefix_size));
+    } else {
+      prefix_size = key_end;
+    }
+    return Bytes(prefix_size, key_end, page->GetSize() + 1);
+  }
+
+  /** @return whether the key can be stored in the page without changing its layout */
+  static bool Fits(const BPlusTreePage *page, const char *data, const KeyType &key) {
+    size_t prefix_size = page->GetKeyPrefixSize();
+    return SharedLength(data, key, prefix_size) == prefix_size &&
+           KeyTrimmedLength(key) <= prefix_size + page->GetKeySuffixSize();
+  }
+
+  static KeyType KeyAt(const BPlusTreePage *page, const char *data, int index) {
+    KeyType key;
+    auto *key_data = reinterpret_cast<char *>(&key);
+    size_t prefix_size = page->GetKeyPrefixSize();
+    size_t suffix_size = page->GetKeySuffixSize();
+    memcpy(key_data, data, prefix_size);
+    memcpy(key_data + prefix_size, Entry(page, data, index), suffix_size);
+    memset(key_data + prefix_size + suffix_size, 0, sizeof(KeyType) - prefix_size - suffix_size);
+    return key;
+  }
+
+  static ValueType ValueAt(const BPlusTreePage *page, const char *data, int index) {
+    ValueType value;
+    memcpy(reinterpret_cast<char *>(&value), Entry(page, data, index) + page->GetKeySuffixSize(), sizeof(ValueType));
+    return value;
+  }
+
+  /** Store an entry whose key fits the layout of the page. */
+  static void SetAt(const BPlusTreePage *page, char *data, int index, const KeyType &key, const ValueType &value) {
+    char *entry = const_cast<char *>(Entry(page, data, index));
+    memcpy(entry, reinterpret_cast<const char *>(&key) + page->GetKeyPrefixSize(), page->GetKeySuffixSize());
+    memcpy(entry + page->GetKeySuffixSize(), reinterpret_cast<const char *>(&value), sizeof(ValueType));
+  }
+
+  /** Move count entries from index from to index to, which may overlap. */
+  static void MoveEntries(const BPlusTreePage *page, char *data, int from, int to, int count) {
+    memmove(const_cast<char *>(Entry(page, data, to)), Entry(page, data, from),
+            count * (page->GetKeySuffixSize() + sizeof(ValueType)));
+  }
+
+  /** @return the bytes that the items take when they are stored in a page by Encode */
+  static size_t EncodedBytes(const Item *items, int size) {
+    auto [prefix_size, key_end] = Layout(items, size);
+    return Bytes(prefix_size, key_end, size);
+  }
+
+  /** Replace the entries of the page with the items, in the layout that takes the fewest bytes. */
+  static void Encode(BPlusTreePage *page, char *data, const Item *items, int size) {
+    auto [prefix_size, key_end] = Layout(items, size);
+    page->SetKeyLayout(prefix_size, key_end - prefix_size);
+    page->SetSize(size);
+    if (size > 0) {
+      memcpy(data, reinterpret_cast<const char *>(&items[0].first), prefix_size);
+    }
+    for (int i = 0; i < size; i++) {
+      SetAt(page, data, i, items[i].first, items[i].second);
+    }
+  }
+
+ private:
+  static const char *Entry(const BPlusTreePage *page, const char *data, int index) {
+    return data + page->GetKeyPrefixSize() + index * (page->GetKeySuffixSize() + sizeof(ValueType));
+  }
+
+  /** @return how many of the first length bytes of the key are the same as in the stored prefix */
+  static size_t SharedLength(const char *data, const KeyType &key, size_t length) {
+    const auto *key_data = reinterpret_cast<const char *>(&key);
+    size_t shared = 0;
+    while (shared < length && data[shared] == key_data[shared]) {
+      shared++;
+    }
+    return shared;
+  }
+
+  /** @return the prefix size and the key end of the smallest layout of the items */
+  static std::pair<size_t, size_t> Layout(const Item *items, int size) {
+    size_t prefix_size = sizeof(KeyType);
+    size_t key_end = 0;
+    for (int i = 0; i < size; i++) {
+      prefix_size = std::min(prefix_size, KeyPrefixLength(items[0].first, items[i].first));
+      key_end = std::max(key_end, KeyTrimmedLength(items[i].first));
+    }
+    return {std::min(prefix_size, key_end), key_end};
+  }
 };
 
 }  // namespace bustub
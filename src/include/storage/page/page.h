@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -48,11 +49,17 @@ class Page {
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch. The page version stays odd until the latch is released. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -60,11 +67,31 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * @return the page version, which changes every time the write latch is taken or released. An optimistic reader
+   * reads the version before reading the page without a latch and validates it afterwards; an odd version means that a
+   * writer holds the latch.
+   */
+  inline uint64_t GetVersion() { return version_.load(std::memory_order_acquire); }
+
+  /** @return true if the page version is still the given one, i.e. no writer latched the page since it was read */
+  inline bool ValidateVersion(uint64_t version) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
-  /** Sets the page LSN. */
-  inline void SetLSN(lsn_t lsn) { memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t)); }
+  /** Sets the page LSN. The first LSN set since the page was last clean also becomes its recLSN. */
+  inline void SetLSN(lsn_t lsn) {
+    memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t));
+    lsn_t clean = INVALID_LSN;
+    rec_lsn_.compare_exchange_strong(clean, lsn);
+  }
+
+  /** @return the LSN of the oldest change that may not be on disk yet, INVALID_LSN if there is none */
+  inline lsn_t GetRecLSN() { return rec_lsn_; }
 
  protected:
   static_assert(sizeof(page_id_t) == 4);
@@ -82,12 +109,16 @@ class Page {
   char data_[PAGE_SIZE]{};
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /** The pin count of this page. Atomic so that resident pages can be pinned and unpinned without the pool latch. */
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
+  /** The recLSN of this page. Set by SetLSN and reset by the buffer pool manager once the page is written. */
+  std::atomic<lsn_t> rec_lsn_ = INVALID_LSN;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Page version for optimistic readers, bumped when the write latch is taken and when it is released. */
+  std::atomic<uint64_t> version_ = 0;
 };
 
 }  // namespace bustub
@@ -198,5 +198,14 @@ class TablePage : public Page {
 
   /** @return tuple size with the deleted flag unset */
   static uint32_t UnsetDeletedFlag(uint32_t tuple_size) { return static_cast<uint32_t>(tuple_size & (~DELETE_MASK)); }
+
+  /** @return whether changes are locked and logged: for a transaction while logging is on, not during recovery */
+  static bool IsLogged(Transaction *txn) { return enable_logging && txn != nullptr; }
+
+  /**
+   * Append the log record of a change to this page and make it the latest of the page and of the transaction. While
+   * the transaction aborts, the change undoes an earlier one and is logged as its CLR.
+   */
+  void AppendLogRecord(LogRecord *log_record, Transaction *txn, LogManager *log_manager);
 };
 }  // namespace bustub
@@ -12,7 +12,9 @@
 
 #pragma once
 
+#include "buffer/buffer_access_strategy.h"
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/prefetcher.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
 #include "storage/table/table_iterator.h"
@@ -55,9 +57,10 @@ class TableHeap {
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
+   * @param strategy the access strategy of a bulk insert, nullptr to go through the shared buffer pool
    * @return true iff the insert is successful
    */
-  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn);
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
@@ -99,8 +102,14 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
-  /** @return the begin iterator of this table */
-  TableIterator Begin(Transaction *txn);
+  /**
+   * @param txn the transaction performing the scan
+   * @param strategy the access strategy of the scan, nullptr to go through the shared buffer pool. It must outlive the
+   * iterator.
+   * @param prefetcher the prefetcher that reads the table pages ahead of the iterator, or nullptr
+   * @return the begin iterator of this table
+   */
+  TableIterator Begin(Transaction *txn, BufferAccessStrategy *strategy = nullptr, Prefetcher *prefetcher = nullptr);
 
   /** @return the end iterator of this table */
   TableIterator End();
@@ -13,7 +13,10 @@
 #pragma once
 
 #include <cassert>
+#include <memory>
 
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/prefetcher.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 #include "storage/table/tuple.h"
@@ -29,10 +32,15 @@ class TableIterator {
   friend class Cursor;
 
  public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr,
+                std::shared_ptr<PrefetchStream> prefetch_stream = nullptr);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        strategy_(other.strategy_),
+        prefetch_stream_(other.prefetch_stream_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -52,6 +60,8 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    strategy_ = other.strategy_;
+    prefetch_stream_ = other.prefetch_stream_;
     return *this;
   }
 
@@ -59,6 +69,10 @@ class TableIterator {
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** Access strategy of the scan, nullptr if the scan goes through the shared buffer pool. */
+  BufferAccessStrategy *strategy_;
+  /** Read-ahead of the pages of the scan, shared by all copies of the iterator, nullptr if there is none. */
+  std::shared_ptr<PrefetchStream> prefetch_stream_;
 };
 
 }  // namespace bustub
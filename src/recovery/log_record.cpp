@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_record.cpp
+//
+// Identification: src/recovery/log_record.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "recovery/log_record.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * Unchanged runs shorter than this between two changed bytes of equally long tuples stay inside one range: in both
+ * the old and the new bytes they cost less than the offset and lengths of another range.
+ */
+static constexpr uint32_t MIN_UNCHANGED_RUN = 2;
+
+uint32_t LogRecord::Checksum(const char *data, int32_t size) {
+  uint32_t crc = CodingUtil::Crc32c(data, CHECKSUM_OFFSET);
+  return CodingUtil::Crc32c(data + CHECKSUM_OFFSET + sizeof(uint32_t), size - CHECKSUM_OFFSET - sizeof(uint32_t), crc);
+}
+
+std::vector<LogRecord> LogRecord::MakeCheckpointEnd(std::vector<std::pair<txn_id_t, lsn_t>> active_txns,
+                                                    std::vector<std::pair<page_id_t, lsn_t>> dirty_pages,
+                                                    uint32_t max_size) {
+  const size_t entry_size = 2 * sizeof(int32_t);
+  const uint32_t empty_size = LogRecord(LogRecordType::CHECKPOINT_END, {}, {}).size_ + MAX_LSN_FIELDS_SIZE;
+  BUSTUB_ASSERT(empty_size + entry_size <= max_size, "A checkpoint record must fit at least one table entry.");
+  const size_t entries_per_record = (max_size - empty_size) / entry_size;
+
+  std::vector<LogRecord> records;
+  size_t txn_pos = 0;
+  size_t page_pos = 0;
+  do {
+    size_t num_txns = std::min(entries_per_record, active_txns.size() - txn_pos);
+    size_t num_pages = std::min(entries_per_record - num_txns, dirty_pages.size() - page_pos);
+    bool last = txn_pos + num_txns == active_txns.size() && page_pos + num_pages == dirty_pages.size();
+    records.emplace_back(last ? LogRecordType::CHECKPOINT_END : LogRecordType::CHECKPOINT_PART,
+                         std::vector<std::pair<txn_id_t, lsn_t>>(active_txns.begin() + txn_pos,
+                                                                 active_txns.begin() + txn_pos + num_txns),
+                         std::vector<std::pair<page_id_t, lsn_t>>(dirty_pages.begin() + page_pos,
+                                                                  dirty_pages.begin() + page_pos + num_pages));
+    txn_pos += num_txns;
+    page_pos += num_pages;
+  } while (records.back().log_record_type_ != LogRecordType::CHECKPOINT_END);
+  return records;
+}
+
+std::vector<LogRecord::UpdateRange> LogRecord::DiffTuples(const Tuple &old_tuple, const Tuple &new_tuple) {
+  const char *old_data = old_tuple.GetData();
+  const char *new_data = new_tuple.GetData();
+  uint32_t old_size = old_tuple.GetLength();
+  uint32_t new_size = new_tuple.GetLength();
+  std::vector<UpdateRange> ranges;
+
+  if (old_size != new_size) {
+    // The bytes have moved, e.g. behind a longer varchar. Keep only the common prefix and suffix out of the range.
+    uint32_t common = std::min(old_size, new_size);
+    uint32_t prefix = 0;
+    while (prefix < common && old_data[prefix] == new_data[prefix]) {
+      prefix++;
+    }
+    uint32_t suffix = 0;
+    while (suffix < common - prefix && old_data[old_size - suffix - 1] == new_data[new_size - suffix - 1]) {
+      suffix++;
+    }
+    ranges.push_back({prefix, std::string(old_data + prefix, old_size - prefix - suffix),
+                      std::string(new_data + prefix, new_size - prefix - suffix)});
+    return ranges;
+  }
+
+  for (uint32_t i = 0; i < old_size;) {
+    if (old_data[i] == new_data[i]) {
+      i++;
+      continue;
+    }
+    uint32_t begin = i;
+    uint32_t end = i + 1;
+    // Extend the range over later changes until an unchanged run long enough to split it.
+    for (uint32_t j = end; j < old_size && j - end < MIN_UNCHANGED_RUN; j++) {
+      if (old_data[j] != new_data[j]) {
+        end = j + 1;
+      }
+    }
+    ranges.push_back({begin, std::string(old_data + begin, end - begin), std::string(new_data + begin, end - begin)});
+    i = end;
+  }
+  return ranges;
+}
+
+Tuple LogRecord::ApplyUpdateRanges(const Tuple &tuple, bool redo) const {
+  const char *data = tuple.GetData();
+  uint32_t size = tuple.GetLength();
+  // The serialized tuple, its size followed by its data, to deserialize the result from.
+  std::vector<char> result(sizeof(uint32_t));
+  result.reserve(sizeof(uint32_t) + size);
+  uint32_t pos = 0;
+  // Offsets are in the old tuple; in the new one, every range moves by the growth of the ranges before it.
+  int64_t shift = 0;
+  for (const auto &range : update_ranges_) {
+    const std::string &from = redo ? range.old_bytes_ : range.new_bytes_;
+    const std::string &to = redo ? range.new_bytes_ : range.old_bytes_;
+    auto offset = static_cast<uint32_t>(range.offset_ + (redo ? 0 : shift));
+    BUSTUB_ASSERT(offset >= pos && offset + from.size() <= size, "The update ranges must lie within the tuple.");
+    result.insert(result.end(), data + pos, data + offset);
+    result.insert(result.end(), to.begin(), to.end());
+    pos = offset + from.size();
+    shift += static_cast<int64_t>(range.new_bytes_.size()) - static_cast<int64_t>(range.old_bytes_.size());
+  }
+  result.insert(result.end(), data + pos, data + size);
+
+  auto result_size = static_cast<uint32_t>(result.size() - sizeof(uint32_t));
+  memcpy(result.data(), &result_size, sizeof(uint32_t));
+  Tuple updated;
+  updated.DeserializeFrom(result.data());
+  return updated;
+}
+
+}  // namespace bustub
@@ -12,6 +12,15 @@
 
 #include "recovery/log_recovery.h"
 
+#include <algorithm>
+#include <cstring>
+#include <queue>
+#include <thread>  // NOLINT
+#include <unordered_set>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/util/coding_util.h"
 #include "storage/page/table_page.h"
 
 namespace bustub {
@@ -20,21 +29,440 @@ namespace bustub {
  * @return: true means deserialize succeed, otherwise can't deserialize cause
  * incomplete log record
  */
-bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) { return false; }
+bool LogRecovery::DeserializeLogRecord(const char *data, int size, LogRecord *log_record) {
+  if (size < LogRecord::HEADER_SIZE) {
+    return false;
+  }
+  int32_t record_size;
+  uint32_t checksum;
+  memcpy(&record_size, data, sizeof(int32_t));
+  memcpy(&checksum, data + LogRecord::CHECKSUM_OFFSET, sizeof(uint32_t));
+  // A record cut off at the end of the data, the zeroes after the end of the log, or a record torn by a crash.
+  if (record_size < LogRecord::HEADER_SIZE || record_size > size ||
+      checksum != LogRecord::Checksum(data, record_size)) {
+    return false;
+  }
+  auto log_record_type = static_cast<uint8_t>(data[LogRecord::TYPE_OFFSET]);
+  if (log_record_type <= static_cast<uint8_t>(LogRecordType::INVALID) ||
+      log_record_type > static_cast<uint8_t>(LogRecordType::CHECKPOINT_PART)) {
+    return false;
+  }
+  const char *limit = data + record_size;
+  const char *pos = data + LogRecord::HEADER_SIZE;
+  uint32_t lsn;
+  uint32_t txn_id;
+  uint32_t prev_lsn_distance;
+  if ((pos = CodingUtil::GetVarint32(pos, limit, &lsn)) == nullptr ||
+      (pos = CodingUtil::GetVarint32(pos, limit, &txn_id)) == nullptr ||
+      (pos = CodingUtil::GetVarint32(pos, limit, &prev_lsn_distance)) == nullptr) {
+    return false;
+  }
+  log_record->size_ = record_size;
+  log_record->lsn_ = static_cast<lsn_t>(lsn);
+  log_record->txn_id_ = static_cast<txn_id_t>(txn_id) - 1;
+  log_record->prev_lsn_ =
+      prev_lsn_distance == 0 ? INVALID_LSN : log_record->lsn_ - static_cast<lsn_t>(prev_lsn_distance);
+  log_record->log_record_type_ = static_cast<LogRecordType>(log_record_type);
+  if (log_record->log_record_type_ == LogRecordType::CLR) {
+    uint32_t undo_next_lsn;
+    if ((pos = CodingUtil::GetVarint32(pos, limit, &undo_next_lsn)) == nullptr || pos == limit) {
+      return false;
+    }
+    auto change_type = static_cast<LogRecordType>(*pos++);
+    if (change_type < LogRecordType::INSERT || change_type > LogRecordType::UPDATE) {
+      return false;
+    }
+    log_record->undo_next_lsn_ = static_cast<lsn_t>(undo_next_lsn) - 1;
+    log_record->change_type_ = change_type;
+  }
+
+  switch (log_record->GetChangeType()) {
+    case LogRecordType::INSERT:
+      memcpy(&log_record->insert_rid_, pos, sizeof(RID));
+      log_record->insert_tuple_.DeserializeFrom(pos + sizeof(RID));
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(&log_record->delete_rid_, pos, sizeof(RID));
+      log_record->delete_tuple_.DeserializeFrom(pos + sizeof(RID));
+      break;
+    case LogRecordType::UPDATE: {
+      memcpy(&log_record->update_rid_, pos, sizeof(RID));
+      pos += sizeof(RID);
+      uint32_t count;
+      pos = CodingUtil::GetVarint32(pos, limit, &count);
+      log_record->update_ranges_.resize(count);
+      for (auto &range : log_record->update_ranges_) {
+        uint32_t old_length;
+        uint32_t new_length;
+        pos = CodingUtil::GetVarint32(pos, limit, &range.offset_);
+        pos = CodingUtil::GetVarint32(pos, limit, &old_length);
+        pos = CodingUtil::GetVarint32(pos, limit, &new_length);
+        range.old_bytes_.assign(pos, old_length);
+        pos += old_length;
+        range.new_bytes_.assign(pos, new_length);
+        pos += new_length;
+      }
+      break;
+    }
+    case LogRecordType::NEWPAGE:
+      memcpy(&log_record->prev_page_id_, pos, sizeof(page_id_t));
+      memcpy(&log_record->page_id_, pos + sizeof(page_id_t), sizeof(page_id_t));
+      break;
+    case LogRecordType::CHECKPOINT_PART:
+    case LogRecordType::CHECKPOINT_END:
+      for (auto *table : {&log_record->active_txns_, &log_record->dirty_pages_}) {
+        int32_t count;
+        memcpy(&count, pos, sizeof(int32_t));
+        pos += sizeof(int32_t);
+        table->resize(count);
+        for (auto &[id, lsn] : *table) {
+          memcpy(&id, pos, sizeof(int32_t));
+          memcpy(&lsn, pos + sizeof(int32_t), sizeof(lsn_t));
+          pos += sizeof(int32_t) + sizeof(lsn_t);
+        }
+      }
+      break;
+    default:
+      break;
+  }
+  return true;
+}
 
 /*
  *redo phase on TABLE PAGE level(table/table_page.h)
- *read log file from the beginning to end (you must prefetch log records into
- *log buffer to reduce unnecessary I/O operations), remember to compare page's
- *LSN with log_record's sequence number, and also build active_txn_ table &
- *lsn_mapping_ table
+ *analysis: read the log from its oldest segment to the end to build active_txn_ table &
+ *lsn_mapping_ table and to find the last complete checkpoint, merging the tables of its CHECKPOINT_PART records
+ *redo: read the log again from the minimum recLSN of the checkpoint's dirty page
+ *table, and replay every record on a worker chosen by its page, comparing page's
+ *LSN with log_record's sequence number
  */
-void LogRecovery::Redo() {}
+void LogRecovery::Redo() {
+  // Analysis. Without a checkpoint, every record may have to be replayed.
+  lsn_t redo_lsn = INVALID_LSN;
+  // The redo point and active transactions of the checkpoint in progress, which only count once its END is read.
+  lsn_t checkpoint_redo_lsn = INVALID_LSN;
+  std::vector<std::pair<txn_id_t, lsn_t>> checkpoint_txns;
+  // A transaction may still be in the checkpoint's active transaction table after its COMMIT or ABORT record.
+  std::unordered_set<txn_id_t> finished_txns;
+  ScanLog(
+      disk_manager_->GetLogStartOffset(),
+      [&](const std::shared_ptr<LogRecord> &log_record, int64_t offset) {
+        lsn_mapping_[log_record->lsn_] = offset;
+        if (redo_lsn == INVALID_LSN) {
+          redo_lsn = log_record->lsn_;
+        }
+        switch (log_record->log_record_type_) {
+          case LogRecordType::CHECKPOINT_BEGIN:
+            checkpoint_redo_lsn = log_record->lsn_;
+            checkpoint_txns.clear();
+            break;
+          case LogRecordType::CHECKPOINT_PART:
+          case LogRecordType::CHECKPOINT_END:
+            // Changes logged before the checkpoint began are on disk unless their page was in the dirty page table,
+            // and then they are not older than the page's recLSN.
+            for (const auto &[page_id, rec_lsn] : log_record->dirty_pages_) {
+              checkpoint_redo_lsn = std::min(checkpoint_redo_lsn, rec_lsn);
+            }
+            checkpoint_txns.insert(checkpoint_txns.end(), log_record->active_txns_.begin(),
+                                   log_record->active_txns_.end());
+            if (log_record->log_record_type_ == LogRecordType::CHECKPOINT_PART) {
+              break;
+            }
+            redo_lsn = checkpoint_redo_lsn;
+            for (const auto &[txn_id, last_lsn] : checkpoint_txns) {
+              if (finished_txns.count(txn_id) == 0) {
+                active_txn_.emplace(txn_id, last_lsn);
+              }
+            }
+            break;
+          case LogRecordType::COMMIT:
+          case LogRecordType::ABORT:
+            active_txn_.erase(log_record->txn_id_);
+            finished_txns.insert(log_record->txn_id_);
+            break;
+          default:
+            active_txn_[log_record->txn_id_] = log_record->lsn_;
+            break;
+        }
+      },
+      [] {});
+  if (redo_lsn == INVALID_LSN) {
+    return;
+  }
+
+  std::vector<std::unique_ptr<RedoWorker>> workers;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < num_redo_workers_; ++i) {
+    workers.emplace_back(std::make_unique<RedoWorker>());
+    threads.emplace_back(&LogRecovery::RunRedoWorker, this, workers.back().get());
+  }
+
+  std::vector<std::vector<RedoTask>> batches(num_redo_workers_);
+  ScanLog(
+      lsn_mapping_[redo_lsn],
+      [&](const std::shared_ptr<LogRecord> &log_record, int64_t offset) {
+        auto dispatch = [&](page_id_t page_id) {
+          batches[page_id % num_redo_workers_].push_back({log_record, page_id});
+        };
+        switch (log_record->GetChangeType()) {
+          case LogRecordType::INSERT:
+            dispatch(log_record->insert_rid_.GetPageId());
+            break;
+          case LogRecordType::MARKDELETE:
+          case LogRecordType::APPLYDELETE:
+          case LogRecordType::ROLLBACKDELETE:
+            dispatch(log_record->delete_rid_.GetPageId());
+            break;
+          case LogRecordType::UPDATE:
+            dispatch(log_record->update_rid_.GetPageId());
+            break;
+          case LogRecordType::NEWPAGE:
+            // Creating a page also links it from its predecessor, which is a change to the predecessor.
+            dispatch(log_record->page_id_);
+            if (log_record->prev_page_id_ != INVALID_PAGE_ID) {
+              dispatch(log_record->prev_page_id_);
+            }
+            break;
+          default:
+            break;
+        }
+      },
+      [&] {
+        // Queue at most one buffer's worth of records ahead of every worker, while the next buffer is read meanwhile.
+        for (size_t i = 0; i < num_redo_workers_; ++i) {
+          if (batches[i].empty()) {
+            continue;
+          }
+          RedoWorker *worker = workers[i].get();
+          {
+            std::unique_lock latch(worker->latch_);
+            worker->cv_.wait(latch, [&] { return worker->tasks_.empty(); });
+            worker->tasks_.insert(worker->tasks_.end(), batches[i].begin(), batches[i].end());
+          }
+          worker->cv_.notify_all();
+          batches[i].clear();
+        }
+      });
+
+  for (auto &worker : workers) {
+    {
+      std::scoped_lock latch(worker->latch_);
+      worker->done_ = true;
+    }
+    worker->cv_.notify_all();
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
 
 /*
  *undo phase on TABLE PAGE level(table/table_page.h)
- *iterate through active txn map and undo each operation
+ *follow the chains of the unfinished transactions back from their latest
+ *records, all in one pass in descending LSN order, undoing every change and
+ *skipping over what a CLR already undid
  */
-void LogRecovery::Undo() {}
+void LogRecovery::Undo() {
+  // Undo the changes of all uncommitted transactions together, latest change first.
+  std::priority_queue<lsn_t> lsns;
+  for (const auto &[txn_id, lsn] : active_txn_) {
+    lsns.push(lsn);
+  }
+  while (!lsns.empty()) {
+    lsn_t lsn = lsns.top();
+    lsns.pop();
+    auto it = lsn_mapping_.find(lsn);
+    if (it == lsn_mapping_.end() || !disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, it->second)) {
+      continue;
+    }
+    LogRecord log_record;
+    if (!DeserializeLogRecord(log_buffer_, LOG_BUFFER_SIZE, &log_record)) {
+      continue;
+    }
+    lsn_t next_lsn = log_record.prev_lsn_;
+    if (log_record.log_record_type_ == LogRecordType::CLR) {
+      // The changes from the one the CLR undid up to the CLR are undone already.
+      next_lsn = log_record.undo_next_lsn_;
+    } else {
+      UndoLogRecord(&log_record);
+    }
+    if (next_lsn != INVALID_LSN) {
+      lsns.push(next_lsn);
+    } else if (log_manager_ != nullptr) {
+      // The transaction is rolled back completely, so that a later recovery leaves it alone.
+      LogRecord abort_record(log_record.txn_id_, active_txn_[log_record.txn_id_], LogRecordType::ABORT);
+      log_manager_->AppendLogRecord(&abort_record);
+    }
+  }
+  if (log_manager_ != nullptr) {
+    log_manager_->Flush(log_manager_->GetNextLSN() - 1);
+  }
+  active_txn_.clear();
+  lsn_mapping_.clear();
+}
+
+void LogRecovery::ScanLog(int64_t offset,
+                          const std::function<void(const std::shared_ptr<LogRecord> &, int64_t)> &on_record,
+                          const std::function<void()> &on_buffer) {
+  offset_ = offset;
+  // The number of bytes in log_buffer_. A record cut off at the end of the buffer is moved to its front and
+  // completed by the next read.
+  int size = 0;
+  while (disk_manager_->ReadLog(log_buffer_ + size, LOG_BUFFER_SIZE - size, offset_ + size)) {
+    size = LOG_BUFFER_SIZE;
+    int pos = 0;
+    while (true) {
+      auto log_record = std::make_shared<LogRecord>();
+      if (!DeserializeLogRecord(log_buffer_ + pos, size - pos, log_record.get())) {
+        break;
+      }
+      on_record(log_record, offset_ + pos);
+      pos += log_record->size_;
+    }
+    on_buffer();
+
+    if (pos == 0) {
+      // Not even one complete record in a full buffer, so the rest of the log is not readable.
+      break;
+    }
+    memmove(log_buffer_, log_buffer_ + pos, size - pos);
+    offset_ += pos;
+    size -= pos;
+  }
+}
+
+void LogRecovery::RunRedoWorker(RedoWorker *worker) {
+  std::unique_lock latch(worker->latch_);
+  while (true) {
+    worker->cv_.wait(latch, [&] { return worker->done_ || !worker->tasks_.empty(); });
+    if (worker->tasks_.empty()) {
+      return;
+    }
+    std::deque<RedoTask> tasks;
+    tasks.swap(worker->tasks_);
+    latch.unlock();
+    worker->cv_.notify_all();
+    for (const auto &task : tasks) {
+      RedoOnPage(*task.log_record_, task.page_id_);
+    }
+    latch.lock();
+  }
+}
+
+void LogRecovery::RedoOnPage(const LogRecord &log_record, page_id_t page_id) {
+  auto *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  BUSTUB_ASSERT(page != nullptr, "Redo needs a free frame for every worker.");
+  page->WLatch();
+  bool is_dirty = false;
+  if (log_record.log_record_type_ == LogRecordType::NEWPAGE && page_id != log_record.page_id_) {
+    // The link from the predecessor is not covered by the predecessor's LSN, but setting it again is harmless.
+    if (page->GetNextPageId() != log_record.page_id_) {
+      page->SetNextPageId(log_record.page_id_);
+      is_dirty = true;
+    }
+  } else if (page->GetLSN() < log_record.lsn_ ||
+             (log_record.log_record_type_ == LogRecordType::NEWPAGE && page->GetTablePageId() != page_id)) {
+    RID rid;
+    Tuple old_tuple;
+    // A CLR is replayed like the change it carries.
+    switch (log_record.GetChangeType()) {
+      case LogRecordType::NEWPAGE:
+        page->Init(page_id, PAGE_SIZE, log_record.prev_page_id_, nullptr, nullptr);
+        break;
+      case LogRecordType::INSERT:
+        page->InsertTuple(log_record.insert_tuple_, &rid, nullptr, nullptr, nullptr);
+        break;
+      case LogRecordType::MARKDELETE:
+        page->MarkDelete(log_record.delete_rid_, nullptr, nullptr, nullptr);
+        break;
+      case LogRecordType::APPLYDELETE:
+        page->ApplyDelete(log_record.delete_rid_, nullptr, nullptr);
+        break;
+      case LogRecordType::ROLLBACKDELETE:
+        page->RollbackDelete(log_record.delete_rid_, nullptr, nullptr);
+        break;
+      case LogRecordType::UPDATE:
+        // The page is in the state before the update, so its tuple is the old one the update ranges apply to.
+        page->GetTuple(log_record.update_rid_, &old_tuple, nullptr, nullptr);
+        page->UpdateTuple(log_record.RedoUpdate(old_tuple), &old_tuple, log_record.update_rid_, nullptr, nullptr,
+                          nullptr);
+        break;
+      default:
+        break;
+    }
+    page->SetLSN(log_record.lsn_);
+    is_dirty = true;
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, is_dirty);
+}
+
+void LogRecovery::UndoLogRecord(LogRecord *log_record) {
+  page_id_t page_id;
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      page_id = log_record->insert_rid_.GetPageId();
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      page_id = log_record->delete_rid_.GetPageId();
+      break;
+    case LogRecordType::UPDATE:
+      page_id = log_record->update_rid_.GetPageId();
+      break;
+    default:
+      // Transaction records change no page, and a new page stays in its table heap.
+      return;
+  }
+
+  auto *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  BUSTUB_ASSERT(page != nullptr, "Undo needs a free frame.");
+  page->WLatch();
+  RID rid;
+  Tuple old_tuple;
+  Tuple new_tuple;
+  // The record of the change that undoes the logged one, which becomes the next record of the transaction.
+  txn_id_t txn_id = log_record->txn_id_;
+  lsn_t prev_lsn = active_txn_[txn_id];
+  LogRecord clr;
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      page->ApplyDelete(log_record->insert_rid_, nullptr, nullptr);
+      clr = LogRecord(txn_id, prev_lsn, LogRecordType::APPLYDELETE, log_record->insert_rid_, log_record->insert_tuple_);
+      break;
+    case LogRecordType::MARKDELETE:
+      page->RollbackDelete(log_record->delete_rid_, nullptr, nullptr);
+      clr = LogRecord(txn_id, prev_lsn, LogRecordType::ROLLBACKDELETE, log_record->delete_rid_,
+                      log_record->delete_tuple_);
+      break;
+    case LogRecordType::APPLYDELETE:
+      page->InsertTuple(log_record->delete_tuple_, &rid, nullptr, nullptr, nullptr);
+      clr = LogRecord(txn_id, prev_lsn, LogRecordType::INSERT, rid, log_record->delete_tuple_);
+      break;
+    case LogRecordType::ROLLBACKDELETE:
+      page->MarkDelete(log_record->delete_rid_, nullptr, nullptr, nullptr);
+      clr = LogRecord(txn_id, prev_lsn, LogRecordType::MARKDELETE, log_record->delete_rid_, log_record->delete_tuple_);
+      break;
+    case LogRecordType::UPDATE:
+      page->GetTuple(log_record->update_rid_, &new_tuple, nullptr, nullptr);
+      old_tuple = log_record->UndoUpdate(new_tuple);
+      page->UpdateTuple(old_tuple, &new_tuple, log_record->update_rid_, nullptr, nullptr, nullptr);
+      clr = LogRecord(txn_id, prev_lsn, LogRecordType::UPDATE, log_record->update_rid_, new_tuple, old_tuple);
+      break;
+    default:
+      break;
+  }
+  if (log_manager_ != nullptr) {
+    clr.MakeCompensation(log_record->prev_lsn_);
+    lsn_t lsn = log_manager_->AppendLogRecord(&clr);
+    page->SetLSN(lsn);
+    active_txn_[txn_id] = lsn;
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
 
 }  // namespace bustub
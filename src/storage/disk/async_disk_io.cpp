@@ -0,0 +1,302 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_io.cpp
+//
+// Identification: src/storage/disk/async_disk_io.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_disk_io.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define BUSTUB_HAVE_IO_URING 1
+#endif
+
+namespace bustub {
+
+AsyncDiskIO::AsyncDiskIO(const std::string &file_name, size_t queue_depth, bool use_io_uring)
+    : queue_depth_(std::max<size_t>(1, queue_depth)) {
+  fd_ = open(file_name.c_str(), O_RDWR | O_DIRECT);
+  direct_io_ = fd_ >= 0;
+  if (fd_ < 0) {
+    // Some file systems, e.g. tmpfs, do not support O_DIRECT.
+    fd_ = open(file_name.c_str(), O_RDWR);
+  }
+  if (fd_ < 0) {
+    throw Exception("can't open db file for asynchronous I/O");
+  }
+  if (use_io_uring && SetUpRing(queue_depth_)) {
+    reaper_ = std::thread(&AsyncDiskIO::RunReaper, this);
+    return;
+  }
+  LOG_DEBUG("io_uring is not available, falling back to pread/pwrite");
+  for (size_t i = 0; i < FALLBACK_WORKERS; ++i) {
+    workers_.emplace_back(&AsyncDiskIO::RunWorker, this);
+  }
+}
+
+AsyncDiskIO::~AsyncDiskIO() {
+  {
+    std::unique_lock latch(latch_);
+    cv_.wait(latch, [&] { return in_flight_ == 0; });
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  if (UsesIOUring()) {
+    {
+      // A no-op without a request tells the completion thread to exit.
+      std::scoped_lock submit_latch(submit_latch_);
+      SubmitToRing({nullptr});
+    }
+    reaper_.join();
+    munmap(sqes_, sqes_size_);
+    if (cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    munmap(sq_ring_, sq_ring_size_);
+    close(ring_fd_);
+  }
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  close(fd_);
+}
+
+void AsyncDiskIO::Submit(std::vector<DiskRequest> *requests) {
+  std::vector<InFlight *> batch;
+  batch.reserve(requests->size());
+  for (auto &request : *requests) {
+    auto *in_flight = new InFlight{std::move(request), {}, nullptr};
+    in_flight->iov_.iov_base = in_flight->request_.data_;
+    in_flight->iov_.iov_len = PAGE_SIZE;
+    if (direct_io_ && reinterpret_cast<uintptr_t>(in_flight->request_.data_) % PAGE_SIZE != 0) {
+      in_flight->bounce_ = static_cast<char *>(std::aligned_alloc(PAGE_SIZE, PAGE_SIZE));
+      if (in_flight->request_.is_write_) {
+        memcpy(in_flight->bounce_, in_flight->request_.data_, PAGE_SIZE);
+      }
+      in_flight->iov_.iov_base = in_flight->bounce_;
+    }
+    batch.push_back(in_flight);
+  }
+  requests->clear();
+
+  size_t next = 0;
+  while (next < batch.size()) {
+    // Take as many of the free slots as the batch needs, waiting for at least one.
+    size_t count;
+    {
+      std::unique_lock latch(latch_);
+      cv_.wait(latch, [&] { return in_flight_ < queue_depth_; });
+      count = std::min(batch.size() - next, queue_depth_ - in_flight_);
+      in_flight_ += count;
+    }
+    std::vector<InFlight *> chunk(batch.begin() + next, batch.begin() + next + count);
+    next += count;
+    if (UsesIOUring()) {
+      std::scoped_lock submit_latch(submit_latch_);
+      SubmitToRing(chunk);
+    } else {
+      {
+        std::scoped_lock latch(latch_);
+        queue_.insert(queue_.end(), chunk.begin(), chunk.end());
+      }
+      cv_.notify_all();
+    }
+  }
+}
+
+void AsyncDiskIO::Complete(InFlight *in_flight, ssize_t result) {
+  DiskRequest &request = in_flight->request_;
+  bool success;
+  if (request.is_write_) {
+    success = result == PAGE_SIZE;
+  } else {
+    success = result >= 0;
+    if (success) {
+      if (in_flight->bounce_ != nullptr) {
+        memcpy(request.data_, in_flight->bounce_, result);
+      }
+      // A read past the end of the file returns less than a page, the rest of the page reads as zeroes.
+      memset(request.data_ + result, 0, PAGE_SIZE - result);
+    }
+  }
+  if (!success) {
+    LOG_DEBUG("I/O error on page %d: %s", request.page_id_, result < 0 ? strerror(-result) : "short write");
+  }
+  std::free(in_flight->bounce_);
+  request.callback_.set_value(success);
+  delete in_flight;
+  {
+    std::scoped_lock latch(latch_);
+    in_flight_--;
+  }
+  cv_.notify_all();
+}
+
+void AsyncDiskIO::RunWorker() {
+  std::unique_lock latch(latch_);
+  while (true) {
+    cv_.wait(latch, [&] { return shutdown_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+    InFlight *in_flight = queue_.front();
+    queue_.pop_front();
+    latch.unlock();
+
+    auto offset = static_cast<off_t>(in_flight->request_.page_id_) * PAGE_SIZE;
+    ssize_t result = in_flight->request_.is_write_
+                         ? pwrite(fd_, in_flight->iov_.iov_base, PAGE_SIZE, offset)
+                         : pread(fd_, in_flight->iov_.iov_base, PAGE_SIZE, offset);
+    Complete(in_flight, result < 0 ? -errno : result);
+    latch.lock();
+  }
+}
+
+#ifdef BUSTUB_HAVE_IO_URING
+
+bool AsyncDiskIO::SetUpRing(size_t queue_depth) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(queue_depth), &params));
+  if (ring_fd < 0) {
+    return false;
+  }
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+  cq_ring_ = sq_ring_;
+  if (!single_mmap) {
+    cq_ring_ =
+        mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+  if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes == MAP_FAILED) {
+    if (sqes != MAP_FAILED) {
+      munmap(sqes, sqes_size_);
+    }
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != MAP_FAILED) {
+      munmap(sq_ring_, sq_ring_size_);
+    }
+    close(ring_fd);
+    return false;
+  }
+
+  auto *sq = static_cast<char *>(sq_ring_);
+  auto *cq = static_cast<char *>(cq_ring_);
+  sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  sqes_ = static_cast<io_uring_sqe *>(sqes);
+  ring_fd_ = ring_fd;
+  // The completion ring holds at least as many entries as the submission ring, so capping the requests in flight at
+  // the submission ring size also keeps completions from overflowing.
+  queue_depth_ = std::min<size_t>(queue_depth_, params.sq_entries);
+  return true;
+}
+
+void AsyncDiskIO::SubmitToRing(const std::vector<InFlight *> &batch) {
+  // Only submitters, serialized by submit_latch_, move the tail; the kernel moves the head once it has consumed the
+  // entries, which happens before io_uring_enter below returns.
+  unsigned tail = *sq_tail_;
+  for (auto *in_flight : batch) {
+    unsigned index = tail & *sq_mask_;
+    io_uring_sqe *sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    if (in_flight == nullptr) {
+      sqe->opcode = IORING_OP_NOP;
+      sqe->user_data = 0;
+    } else {
+      sqe->opcode = in_flight->request_.is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+      sqe->fd = fd_;
+      sqe->addr = reinterpret_cast<uint64_t>(&in_flight->iov_);
+      sqe->len = 1;
+      sqe->off = static_cast<uint64_t>(in_flight->request_.page_id_) * PAGE_SIZE;
+      sqe->user_data = reinterpret_cast<uint64_t>(in_flight);
+    }
+    sq_array_[index] = index;
+    tail++;
+  }
+  __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+  size_t submitted = 0;
+  while (submitted < batch.size()) {
+    auto ret = syscall(__NR_io_uring_enter, ring_fd_, static_cast<unsigned>(batch.size() - submitted), 0, 0,
+                       nullptr, 0);
+    if (ret < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+        continue;
+      }
+      throw Exception("io_uring_enter failed to submit disk requests");
+    }
+    submitted += ret;
+  }
+}
+
+void AsyncDiskIO::RunReaper() {
+  while (true) {
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+      syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+      continue;
+    }
+    bool shutdown = false;
+    for (; head != tail; ++head) {
+      io_uring_cqe *cqe = &cqes_[head & *cq_mask_];
+      if (cqe->user_data == 0) {
+        shutdown = true;
+      } else {
+        Complete(reinterpret_cast<InFlight *>(cqe->user_data), cqe->res);
+      }
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    if (shutdown) {
+      return;
+    }
+  }
+}
+
+#else
+
+bool AsyncDiskIO::SetUpRing(size_t /*queue_depth*/) { return false; }
+
+void AsyncDiskIO::SubmitToRing(const std::vector<InFlight *> & /*batch*/) {}
+
+void AsyncDiskIO::RunReaper() {}
+
+#endif
+
+}  // namespace bustub
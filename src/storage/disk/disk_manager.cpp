@@ -10,16 +10,29 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <cinttypes>
+#include <climits>
+#include <cstdio>
 #include <cstring>
+#include <filesystem>
 #include <iostream>
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/util/coding_util.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
@@ -30,67 +43,149 @@ static char *buffer_used;
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
-  std::string::size_type n = file_name_.rfind('.');
-  if (n == std::string::npos) {
+DiskManager::DiskManager(const std::string &db_file, DiskIOBackend io_backend, int64_t log_segment_size,
+                         PageProtection page_protection, LogCompression log_compression)
+    : log_segment_size_(log_segment_size),
+      log_compression_(log_compression),
+      file_name_(db_file),
+      num_flushes_(0),
+      num_writes_(0),
+      num_reads_(0),
+      flush_log_(false),
+      flush_log_f_(nullptr),
+      page_protection_(page_protection) {
+  log_name_ = LogFileName(file_name_);
+  if (log_name_.empty()) {
     LOG_DEBUG("wrong file format");
     return;
   }
-  log_name_ = file_name_.substr(0, n) + ".log";
-
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::app | std::ios::out);
-    log_io_.close();
-    // reopen with original mode
-    log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
-    }
+  if (page_protection_ == PageProtection::DOUBLE_WRITE && io_backend != DiskIOBackend::PREAD_PWRITE) {
+    throw Exception("the double-write file needs the PREAD_PWRITE backend");
   }
+  // The log segments of an earlier database with the same name must not be continued or replayed. An existing but
+  // empty database file keeps its log, which may hold the only copy of changes that were never written to a page.
+  if (GetFileSize(db_file) < 0) {
+    RemoveLogFiles(db_file);
+  }
+  OpenLogSegments();
+  // The checksums and the double-write batch of an earlier database with the same name must not be applied.
+  bool new_db = GetFileSize(db_file) <= 0;
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
+  buffer_used = nullptr;
+  if (io_backend != DiskIOBackend::FSTREAM) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+    if (db_fd_ < 0) {
+      throw Exception("can't open db file");
+    }
+    if (io_backend == DiskIOBackend::ASYNC) {
+      async_io_ = std::make_unique<AsyncDiskIO>(db_file);
+    }
+  } else {
+    std::scoped_lock scoped_db_io_latch(db_io_latch_);
     db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+    // directory or file does not exist
     if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+      db_io_.clear();
+      // create a new file
+      db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
+      db_io_.close();
+      // reopen with original mode
+      db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+      if (!db_io_.is_open()) {
+        throw Exception("can't open db file");
+      }
     }
   }
-  buffer_used = nullptr;
+
+  if (page_protection_ != PageProtection::NONE) {
+    OpenChecksumFile(new_db);
+  }
+  if (page_protection_ == PageProtection::DOUBLE_WRITE) {
+    OpenDoubleWriteFile(new_db);
+  }
 }
 
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
+  async_io_.reset();
+  for (int *fd : {&db_fd_, &checksum_fd_, &double_write_fd_}) {
+    if (*fd >= 0) {
+      close(*fd);
+      *fd = -1;
+    }
+  }
   {
     std::scoped_lock scoped_db_io_latch(db_io_latch_);
     db_io_.close();
   }
-  log_io_.close();
+  std::scoped_lock log_latch(log_latch_);
+  for (auto &[start_offset, segment] : log_segments_) {
+    close(segment.fd_);
+  }
+  log_segments_.clear();
 }
 
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  if (async_io_ != nullptr) {
+    WritePageAsync(page_id, page_data).wait();
+    return;
+  }
+  if (double_write_fd_ >= 0) {
+    DoubleWritePages(&page_id, &page_data, 1);
+    return;
+  }
+  WritePageRun(page_id, &page_data, 1);
+}
+
+/**
+ * Write the contents of pages with consecutive ids into disk file with one request
+ */
+void DiskManager::WritePageRun(page_id_t first_page_id, const char *const *page_data, size_t num_pages) {
+  num_writes_ += num_pages;
+  num_write_calls_ += 1;
+  RecordChecksums(first_page_id, page_data, num_pages);
+  if (db_fd_ >= 0) {
+    // pwritev does not move a shared cursor, so writers need no latch
+    std::vector<iovec> iov(num_pages);
+    for (size_t i = 0; i < num_pages; ++i) {
+      iov[i].iov_base = const_cast<char *>(page_data[i]);
+      iov[i].iov_len = PAGE_SIZE;
+    }
+    auto offset = static_cast<off_t>(first_page_id) * PAGE_SIZE;
+    for (size_t next = 0; next < num_pages;) {
+      ssize_t ret = pwritev(db_fd_, iov.data() + next, static_cast<int>(std::min<size_t>(num_pages - next, IOV_MAX)),
+                            offset);
+      if (ret < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        LOG_DEBUG("I/O error while writing");
+        return;
+      }
+      offset += ret;
+      // Skip the pages written completely and continue a partially written one where the write stopped.
+      for (; next < num_pages && static_cast<size_t>(ret) >= iov[next].iov_len; ++next) {
+        ret -= static_cast<ssize_t>(iov[next].iov_len);
+      }
+      if (ret > 0) {
+        iov[next].iov_base = static_cast<char *>(iov[next].iov_base) + ret;
+        iov[next].iov_len -= ret;
+      }
+    }
+    return;
+  }
   std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
+  size_t offset = static_cast<size_t>(first_page_id) * PAGE_SIZE;
   // set write cursor to offset
-  num_writes_ += 1;
   db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
+  for (size_t i = 0; i < num_pages; ++i) {
+    db_io_.write(page_data[i], PAGE_SIZE);
+  }
   // check for I/O error
   if (db_io_.bad()) {
     LOG_DEBUG("I/O error while writing");
@@ -104,8 +199,20 @@ void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  if (async_io_ != nullptr) {
+    ReadPageAsync(page_id, page_data).wait();
+    VerifyChecksum(page_id, page_data);
+    return;
+  }
+  if (db_fd_ >= 0) {
+    num_reads_ += 1;
+    PreadPage(page_id, page_data);
+    VerifyChecksum(page_id, page_data);
+    return;
+  }
   std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * PAGE_SIZE;
+  int64_t offset = static_cast<int64_t>(page_id) * PAGE_SIZE;
+  num_reads_ += 1;
   // check if read beyond file length
   if (offset > GetFileSize(file_name_)) {
     LOG_DEBUG("I/O error reading past end of file");
@@ -126,14 +233,190 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
       // std::cerr << "Read less than a page" << std::endl;
       memset(page_data + read_count, 0, PAGE_SIZE - read_count);
     }
+    VerifyChecksum(page_id, page_data);
+  }
+}
+
+/**
+ * Read the contents of the specified page with pread
+ */
+void DiskManager::PreadPage(page_id_t page_id, char *page_data) {
+  auto offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+  ssize_t read_count = 0;
+  while (read_count < PAGE_SIZE) {
+    ssize_t ret = pread(db_fd_, page_data + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret < 0) {
+      LOG_DEBUG("I/O error while reading");
+      return;
+    }
+    if (ret == 0) {
+      break;
+    }
+    read_count += ret;
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  }
+}
+
+/**
+ * Write several pages into disk file, and wait until all of them are written
+ */
+void DiskManager::WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data) {
+  if (double_write_fd_ >= 0) {
+    DoubleWritePages(page_ids.data(), page_data.data(), page_ids.size());
+    return;
+  }
+  if (async_io_ == nullptr) {
+    WritePageRuns(page_ids.data(), page_data.data(), page_ids.size());
+    return;
+  }
+  std::vector<DiskRequest> requests(page_ids.size());
+  std::vector<std::future<bool>> futures;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    requests[i].is_write_ = true;
+    requests[i].page_id_ = page_ids[i];
+    requests[i].data_ = const_cast<char *>(page_data[i]);
+    futures.push_back(requests[i].callback_.get_future());
+    RecordChecksums(page_ids[i], &page_data[i], 1);
+  }
+  num_writes_ += page_ids.size();
+  num_write_calls_ += page_ids.size();
+  async_io_->Submit(&requests);
+  for (auto &future : futures) {
+    future.wait();
   }
 }
 
+/**
+ * Read several pages into the given memory areas, and wait until all of them are read
+ */
+void DiskManager::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) {
+  if (async_io_ == nullptr) {
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+      ReadPage(page_ids[i], page_data[i]);
+    }
+    return;
+  }
+  std::vector<DiskRequest> requests(page_ids.size());
+  std::vector<std::future<bool>> futures;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    requests[i].is_write_ = false;
+    requests[i].page_id_ = page_ids[i];
+    requests[i].data_ = page_data[i];
+    futures.push_back(requests[i].callback_.get_future());
+  }
+  num_reads_ += page_ids.size();
+  async_io_->Submit(&requests);
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    futures[i].wait();
+    VerifyChecksum(page_ids[i], page_data[i]);
+  }
+}
+
+/**
+ * Write pages into disk file, one run of consecutive page ids at a time
+ */
+void DiskManager::WritePageRuns(const page_id_t *page_ids, const char *const *page_data, size_t num_pages) {
+  size_t begin = 0;
+  while (begin < num_pages) {
+    size_t end = begin + 1;
+    while (end < num_pages && page_ids[end] == page_ids[end - 1] + 1) {
+      end++;
+    }
+    WritePageRun(page_ids[begin], page_data + begin, end - begin);
+    begin = end;
+  }
+}
+
+/**
+ * Write pages into disk file through the double-write file, one batch at a time
+ */
+void DiskManager::DoubleWritePages(const page_id_t *page_ids, const char *const *page_data, size_t num_pages) {
+  std::vector<char> header(PAGE_SIZE);
+  for (size_t begin = 0; begin < num_pages; begin += DOUBLE_WRITE_BATCH_SIZE) {
+    auto count = static_cast<uint32_t>(std::min<size_t>(num_pages - begin, DOUBLE_WRITE_BATCH_SIZE));
+    std::fill(header.begin(), header.end(), 0);
+    memcpy(header.data(), &DOUBLE_WRITE_MAGIC, sizeof(uint32_t));
+    memcpy(header.data() + 4, &count, sizeof(uint32_t));
+    std::vector<iovec> iov(count + 1);
+    iov[0] = {header.data(), PAGE_SIZE};
+    for (uint32_t i = 0; i < count; ++i) {
+      uint32_t checksum = PageChecksum(page_data[begin + i]);
+      memcpy(header.data() + DOUBLE_WRITE_HEADER_SIZE + 8 * i, &page_ids[begin + i], sizeof(page_id_t));
+      memcpy(header.data() + DOUBLE_WRITE_HEADER_SIZE + 8 * i + 4, &checksum, sizeof(uint32_t));
+      iov[i + 1] = {const_cast<char *>(page_data[begin + i]), PAGE_SIZE};
+    }
+    uint32_t header_checksum = CodingUtil::Crc32c(header.data() + DOUBLE_WRITE_HEADER_SIZE, 8 * count);
+    memcpy(header.data() + 8, &header_checksum, sizeof(uint32_t));
+
+    std::scoped_lock double_write_latch(double_write_latch_);
+    // Every write request here is at most DOUBLE_WRITE_BATCH_SIZE + 1 pages, well below IOV_MAX.
+    ssize_t expected = static_cast<ssize_t>(count + 1) * PAGE_SIZE;
+    ssize_t ret;
+    do {
+      ret = pwritev(double_write_fd_, iov.data(), static_cast<int>(iov.size()), 0);
+    } while (ret < 0 && errno == EINTR);
+    if (ret != expected) {
+      LOG_DEBUG("I/O error while writing the double-write file");
+      return;
+    }
+    SyncFile(double_write_fd_);
+    WritePageRuns(page_ids + begin, page_data + begin, count);
+    SyncFile(db_fd_);
+    SyncFile(checksum_fd_);
+  }
+}
+
+/**
+ * Start writing the contents of the specified page into disk file
+ * Without the ASYNC backend, the write is done before this returns
+ */
+std::future<bool> DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) {
+  std::promise<bool> done;
+  std::future<bool> future = done.get_future();
+  if (async_io_ == nullptr) {
+    WritePage(page_id, page_data);
+    done.set_value(true);
+    return future;
+  }
+  std::vector<DiskRequest> requests;
+  requests.push_back({true, page_id, const_cast<char *>(page_data), std::move(done)});
+  RecordChecksums(page_id, &page_data, 1);
+  num_writes_ += 1;
+  num_write_calls_ += 1;
+  async_io_->Submit(&requests);
+  return future;
+}
+
+/**
+ * Start reading the contents of the specified page into the given memory area
+ * Without the ASYNC backend, the read is done before this returns
+ */
+std::future<bool> DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) {
+  std::promise<bool> done;
+  std::future<bool> future = done.get_future();
+  if (async_io_ == nullptr) {
+    ReadPage(page_id, page_data);
+    done.set_value(true);
+    return future;
+  }
+  std::vector<DiskRequest> requests;
+  requests.push_back({false, page_id, page_data, std::move(done)});
+  num_reads_ += 1;
+  async_io_->Submit(&requests);
+  return future;
+}
+
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
  */
-void DiskManager::WriteLog(char *log_data, int size) {
+void DiskManager::WriteLog(char *log_data, int size, lsn_t first_lsn) {
   // enforce swap log buffer
   assert(log_data != buffer_used);
   buffer_used = log_data;
@@ -149,45 +432,522 @@ void DiskManager::WriteLog(char *log_data, int size) {
     assert(flush_log_f_->wait_for(std::chrono::seconds(10)) == std::future_status::ready);
   }
 
+  std::scoped_lock log_latch(log_latch_);
   num_flushes_ += 1;
-  // sequence write
-  log_io_.write(log_data, size);
-
-  // check for I/O error
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while writing log");
-    return;
+  bool compressed = log_compression_ == LogCompression::LZ;
+  // A log buffer never spans two segments, so every segment starts with a whole log record.
+  if (log_segments_.empty() || log_segments_.rbegin()->second.compressed_ != compressed ||
+      (log_segments_.rbegin()->second.size_ > 0 && log_segments_.rbegin()->second.size_ + size > log_segment_size_)) {
+    AddLogSegment(first_lsn);
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
+  LogSegment &segment = log_segments_.rbegin()->second;
+  if (compressed) {
+    AppendLogBlock(&segment, log_data, size);
+    segment.size_ += size;
+  } else {
+    // sequence write
+    for (int written = 0; written < size;) {
+      ssize_t ret = pwrite(segment.fd_, log_data + written, size - written, segment.file_size_ + written);
+      if (ret < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        // check for I/O error
+        LOG_DEBUG("I/O error while writing log");
+        return;
+      }
+      written += ret;
+    }
+    segment.size_ += size;
+    segment.file_size_ += size;
+    num_log_bytes_written_ += size;
+  }
+  // The log manager advances the persistent LSN once this returns, so the records have to be on stable storage.
+  SyncLogFile(segment.fd_, false);
   flush_log_ = false;
 }
 
 /**
  * Read the contents of the log into the given memory area
- * Always read from the beginning and perform sequence read
+ * Reads continue across segment boundaries as if the log were one file
  * @return: false means already reach the end
  */
-bool DiskManager::ReadLog(char *log_data, int size, int offset) {
-  if (offset >= GetFileSize(log_name_)) {
+bool DiskManager::ReadLog(char *log_data, int size, int64_t offset) {
+  std::scoped_lock log_latch(log_latch_);
+  if (log_segments_.empty() || offset < log_segments_.begin()->first) {
+    return false;
+  }
+  auto it = std::prev(log_segments_.upper_bound(offset));
+  if (offset >= it->first + it->second.size_) {
     // LOG_DEBUG("end of log file");
-    // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
+  int read_count = 0;
+  for (; it != log_segments_.end() && read_count < size; ++it) {
+    int64_t segment_offset = offset + read_count - it->first;
+    int64_t count = std::min<int64_t>(size - read_count, it->second.size_ - segment_offset);
+    if (!ReadLogSegment(it->second, log_data + read_count, segment_offset, count)) {
+      LOG_DEBUG("I/O error while reading log");
+      return false;
+    }
+    read_count += count;
+  }
+  // if log file ends before reading "size"
+  memset(log_data + read_count, 0, size - read_count);
+  return true;
+}
+
+void DiskManager::TruncateLog(lsn_t lsn) {
+  std::scoped_lock log_latch(log_latch_);
+  while (log_segments_.size() > 1) {
+    auto oldest = log_segments_.begin();
+    // The records of a segment have LSNs below the start LSN of the next one.
+    lsn_t next_start_lsn = std::next(oldest)->second.start_lsn_;
+    if (next_start_lsn == INVALID_LSN || next_start_lsn > lsn) {
+      return;
+    }
+    close(oldest->second.fd_);
+    std::remove(LogSegmentName(oldest->second.segment_no_).c_str());
+    log_segments_.erase(oldest);
+  }
+}
+
+void DiskManager::TruncateLogTail(int64_t offset) {
+  std::scoped_lock log_latch(log_latch_);
+  if (log_segments_.empty() || offset < log_segments_.rbegin()->first) {
+    return;
+  }
+  LogSegment &segment = log_segments_.rbegin()->second;
+  int64_t size = offset - log_segments_.rbegin()->first;
+  if (size >= segment.size_) {
+    return;
+  }
+  if (!segment.compressed_) {
+    if (ftruncate(segment.fd_, LOG_SEGMENT_HEADER_SIZE + size) == 0) {
+      segment.size_ = size;
+      segment.file_size_ = LOG_SEGMENT_HEADER_SIZE + size;
+    }
+    return;
+  }
+  // Drop the blocks past the offset, and rewrite the one it falls into with only its bytes before the offset.
+  std::vector<char> kept;
+  while (!segment.blocks_.empty() && segment.blocks_.back().offset_ + segment.blocks_.back().raw_size_ > size) {
+    const LogBlock &block = segment.blocks_.back();
+    if (block.offset_ < size && LoadLogBlock(segment, segment.blocks_.size() - 1)) {
+      kept.assign(cached_block_.begin(), cached_block_.begin() + (size - block.offset_));
+    }
+    segment.size_ = block.offset_;
+    segment.file_size_ = block.position_;
+    segment.blocks_.pop_back();
+  }
+  cached_block_segment_no_ = -1;
+  if (!kept.empty()) {
+    AppendLogBlock(&segment, kept.data(), kept.size());
+    segment.size_ += kept.size();
+  }
+  if (ftruncate(segment.fd_, segment.file_size_) != 0) {
+    LOG_DEBUG("I/O error while truncating log");
+  }
+}
+
+int64_t DiskManager::GetLogStartOffset() {
+  std::scoped_lock log_latch(log_latch_);
+  return log_segments_.empty() ? 0 : log_segments_.begin()->first;
+}
 
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while reading log");
+int64_t DiskManager::GetLogEndOffset() {
+  std::scoped_lock log_latch(log_latch_);
+  return log_segments_.empty() ? 0 : log_segments_.rbegin()->first + log_segments_.rbegin()->second.size_;
+}
+
+int64_t DiskManager::GetLastLogSegmentOffset() {
+  std::scoped_lock log_latch(log_latch_);
+  return log_segments_.empty() ? -1 : log_segments_.rbegin()->first;
+}
+
+lsn_t DiskManager::GetLastLogSegmentStartLSN() {
+  std::scoped_lock log_latch(log_latch_);
+  return log_segments_.empty() ? INVALID_LSN : log_segments_.rbegin()->second.start_lsn_;
+}
+
+int64_t DiskManager::GetNumLogBytesWritten() const { return num_log_bytes_written_; }
+
+size_t DiskManager::GetNumLogSegments() {
+  std::scoped_lock log_latch(log_latch_);
+  return log_segments_.size();
+}
+
+std::string DiskManager::LogSegmentName(int64_t segment_no) const {
+  char suffix[32];
+  snprintf(suffix, sizeof(suffix), ".%08" PRId64, segment_no);
+  return log_name_ + suffix;
+}
+
+void DiskManager::RemoveLogFiles(const std::string &db_file) {
+  std::string log_name = LogFileName(db_file);
+  if (log_name.empty()) {
+    return;
+  }
+  for (const auto &[segment_no, path] : FindLogSegmentFiles(log_name)) {
+    std::remove(path.c_str());
+  }
+}
+
+std::string DiskManager::LogFileName(const std::string &db_file) { return SiblingFileName(db_file, ".log"); }
+
+std::string DiskManager::SiblingFileName(const std::string &db_file, const char *extension) {
+  std::string::size_type n = db_file.rfind('.');
+  return n == std::string::npos ? "" : db_file.substr(0, n) + extension;
+}
+
+uint32_t DiskManager::PageChecksum(const char *page_data) {
+  uint32_t checksum = CodingUtil::Crc32c(page_data, PAGE_SIZE);
+  return checksum == 0 ? 1 : checksum;
+}
+
+void DiskManager::OpenChecksumFile(bool new_db) {
+  std::string name = SiblingFileName(file_name_, ".crc");
+  checksum_fd_ = open(name.c_str(), O_RDWR | O_CREAT | (new_db ? O_TRUNC : 0), 0644);
+  if (checksum_fd_ < 0) {
+    throw Exception("can't open checksum file");
+  }
+  checksums_.resize(std::max<int64_t>(GetFileSize(name), 0) / sizeof(uint32_t));
+  auto *data = reinterpret_cast<char *>(checksums_.data());
+  size_t size = checksums_.size() * sizeof(uint32_t);
+  for (size_t read_count = 0; read_count < size;) {
+    ssize_t ret = pread(checksum_fd_, data + read_count, size - read_count, read_count);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      // Without its stored checksums, a page is not verified.
+      std::fill(checksums_.begin() + read_count / sizeof(uint32_t), checksums_.end(), 0);
+      break;
+    }
+    read_count += ret;
+  }
+}
+
+void DiskManager::RecordChecksums(page_id_t first_page_id, const char *const *page_data, size_t num_pages) {
+  if (checksum_fd_ < 0) {
+    return;
+  }
+  std::vector<uint32_t> checksums(num_pages);
+  for (size_t i = 0; i < num_pages; ++i) {
+    checksums[i] = PageChecksum(page_data[i]);
+  }
+  size_t size = num_pages * sizeof(uint32_t);
+  auto offset = static_cast<off_t>(first_page_id) * sizeof(uint32_t);
+  // The latch keeps the checksum file in the order of the checksums in memory.
+  std::scoped_lock checksum_latch(checksum_latch_);
+  if (checksums_.size() < first_page_id + num_pages) {
+    checksums_.resize(first_page_id + num_pages);
+  }
+  std::copy(checksums.begin(), checksums.end(), checksums_.begin() + first_page_id);
+  if (pwrite(checksum_fd_, checksums.data(), size, offset) != static_cast<ssize_t>(size)) {
+    LOG_DEBUG("I/O error while writing checksums");
+  }
+}
+
+void DiskManager::VerifyChecksum(page_id_t page_id, const char *page_data) {
+  if (checksum_fd_ < 0) {
+    return;
+  }
+  uint32_t expected = 0;
+  {
+    std::scoped_lock checksum_latch(checksum_latch_);
+    if (static_cast<size_t>(page_id) < checksums_.size()) {
+      expected = checksums_[page_id];
+    }
+  }
+  if (expected != 0 && expected != PageChecksum(page_data)) {
+    num_checksum_failures_ += 1;
+    LOG_ERROR("checksum mismatch in page %d", page_id);
+  }
+}
+
+void DiskManager::OpenDoubleWriteFile(bool new_db) {
+  std::string name = SiblingFileName(file_name_, ".dwb");
+  double_write_fd_ = open(name.c_str(), O_RDWR | O_CREAT | (new_db ? O_TRUNC : 0), 0644);
+  if (double_write_fd_ < 0) {
+    throw Exception("can't open double-write file");
+  }
+  if (!new_db) {
+    RestoreTornPages();
+  }
+}
+
+void DiskManager::RestoreTornPages() {
+  std::vector<char> batch((DOUBLE_WRITE_BATCH_SIZE + 1) * PAGE_SIZE);
+  ssize_t size = pread(double_write_fd_, batch.data(), batch.size(), 0);
+  uint32_t magic = 0;
+  uint32_t count = 0;
+  uint32_t header_checksum = 0;
+  if (size >= DOUBLE_WRITE_HEADER_SIZE) {
+    memcpy(&magic, batch.data(), sizeof(uint32_t));
+    memcpy(&count, batch.data() + 4, sizeof(uint32_t));
+    memcpy(&header_checksum, batch.data() + 8, sizeof(uint32_t));
+  }
+  if (magic != DOUBLE_WRITE_MAGIC || count > DOUBLE_WRITE_BATCH_SIZE ||
+      size < static_cast<ssize_t>(count + 1) * PAGE_SIZE ||
+      header_checksum != CodingUtil::Crc32c(batch.data() + DOUBLE_WRITE_HEADER_SIZE, 8 * count)) {
+    return;
+  }
+  std::vector<page_id_t> page_ids(count);
+  std::vector<uint32_t> checksums(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    memcpy(&page_ids[i], batch.data() + DOUBLE_WRITE_HEADER_SIZE + 8 * i, sizeof(page_id_t));
+    memcpy(&checksums[i], batch.data() + DOUBLE_WRITE_HEADER_SIZE + 8 * i + 4, sizeof(uint32_t));
+    // A batch is synced completely before any of its pages is written in place, so with a torn copy, none was.
+    if (PageChecksum(batch.data() + (i + 1) * PAGE_SIZE) != checksums[i]) {
+      return;
+    }
+  }
+  char page_data[PAGE_SIZE];
+  for (uint32_t i = 0; i < count; ++i) {
+    const char *copy = batch.data() + (i + 1) * PAGE_SIZE;
+    PreadPage(page_ids[i], page_data);
+    if (PageChecksum(page_data) != checksums[i]) {
+      LOG_INFO("restoring torn page %d from the double-write file", page_ids[i]);
+      WritePageRun(page_ids[i], &copy, 1);
+      num_restored_pages_ += 1;
+    } else {
+      // The page made it to disk, but its checksum may not have.
+      RecordChecksums(page_ids[i], &copy, 1);
+    }
+  }
+  SyncFile(db_fd_);
+  SyncFile(checksum_fd_);
+}
+
+void DiskManager::SyncFile(int fd) {
+  num_syncs_ += 1;
+  if (fdatasync(fd) != 0) {
+    LOG_DEBUG("I/O error while syncing");
+  }
+}
+
+void DiskManager::SyncLogFile(int fd, bool metadata) {
+  num_log_syncs_ += 1;
+  if ((metadata ? fsync(fd) : fdatasync(fd)) != 0) {
+    LOG_DEBUG("I/O error while syncing log");
+  }
+}
+
+void DiskManager::SyncLogDirectory() {
+  std::filesystem::path log_path(log_name_);
+  std::string dir = log_path.has_parent_path() ? log_path.parent_path().string() : ".";
+  int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+  if (fd < 0) {
+    LOG_DEBUG("can't open log directory");
+    return;
+  }
+  SyncLogFile(fd, true);
+  close(fd);
+}
+
+std::vector<std::pair<int64_t, std::string>> DiskManager::FindLogSegmentFiles(const std::string &log_name) {
+  std::filesystem::path log_path(log_name);
+  std::filesystem::path dir = log_path.has_parent_path() ? log_path.parent_path() : std::filesystem::path(".");
+  std::string prefix = log_path.filename().string() + ".";
+  std::vector<std::pair<int64_t, std::string>> files;
+  std::error_code ec;
+  for (const auto &entry : std::filesystem::directory_iterator(dir, ec)) {
+    std::string name = entry.path().filename().string();
+    if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0 &&
+        name.find_first_not_of("0123456789", prefix.size()) == std::string::npos) {
+      files.emplace_back(std::stoll(name.substr(prefix.size())), entry.path().string());
+    }
+  }
+  return files;
+}
+
+void DiskManager::OpenLogSegments() {
+  for (const auto &[segment_no, path] : FindLogSegmentFiles(log_name_)) {
+    int fd = open(path.c_str(), O_RDWR);
+    char header[LOG_SEGMENT_HEADER_SIZE];
+    if (fd < 0 || pread(fd, header, LOG_SEGMENT_HEADER_SIZE, 0) != LOG_SEGMENT_HEADER_SIZE) {
+      // A crash while a segment was being created; nothing in it was ever durable.
+      if (fd >= 0) {
+        close(fd);
+      }
+      std::remove(path.c_str());
+      continue;
+    }
+    uint32_t magic;
+    LogSegment segment;
+    int64_t start_offset;
+    memcpy(&magic, header, sizeof(uint32_t));
+    memcpy(&segment.start_lsn_, header + 4, sizeof(lsn_t));
+    memcpy(&segment.segment_no_, header + 8, sizeof(int64_t));
+    memcpy(&start_offset, header + 16, sizeof(int64_t));
+    if ((magic != LOG_SEGMENT_MAGIC && magic != LOG_SEGMENT_COMPRESSED_MAGIC) || segment.segment_no_ != segment_no) {
+      close(fd);
+      continue;
+    }
+    segment.fd_ = fd;
+    segment.file_size_ = GetFileSize(path);
+    segment.compressed_ = magic == LOG_SEGMENT_COMPRESSED_MAGIC;
+    if (segment.compressed_) {
+      ScanLogBlocks(&segment);
+    } else {
+      segment.size_ = segment.file_size_ - LOG_SEGMENT_HEADER_SIZE;
+    }
+    log_segments_.emplace(start_offset, std::move(segment));
+  }
+}
+
+void DiskManager::AddLogSegment(lsn_t start_lsn) {
+  int64_t segment_no = 0;
+  int64_t start_offset = 0;
+  if (!log_segments_.empty()) {
+    const auto &[last_offset, last] = *log_segments_.rbegin();
+    segment_no = last.segment_no_ + 1;
+    start_offset = last_offset + last.size_;
+  }
+  int fd = open(LogSegmentName(segment_no).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw Exception("can't open dblog file");
+  }
+  bool compressed = log_compression_ == LogCompression::LZ;
+  char header[LOG_SEGMENT_HEADER_SIZE];
+  memcpy(header, compressed ? &LOG_SEGMENT_COMPRESSED_MAGIC : &LOG_SEGMENT_MAGIC, sizeof(uint32_t));
+  memcpy(header + 4, &start_lsn, sizeof(lsn_t));
+  memcpy(header + 8, &segment_no, sizeof(int64_t));
+  memcpy(header + 16, &start_offset, sizeof(int64_t));
+  if (pwrite(fd, header, LOG_SEGMENT_HEADER_SIZE, 0) != LOG_SEGMENT_HEADER_SIZE) {
+    close(fd);
+    throw Exception("can't write dblog file");
+  }
+  // Syncing the records later only covers the file data; a crash could still lose the new file itself.
+  SyncLogFile(fd, true);
+  SyncLogDirectory();
+  num_log_bytes_written_ += LOG_SEGMENT_HEADER_SIZE;
+  log_segments_.emplace(start_offset,
+                        LogSegment{segment_no, start_lsn, fd, 0, LOG_SEGMENT_HEADER_SIZE, compressed, {}});
+}
+
+void DiskManager::ScanLogBlocks(LogSegment *segment) {
+  segment->size_ = 0;
+  int64_t position = LOG_SEGMENT_HEADER_SIZE;
+  char header[LOG_BLOCK_HEADER_SIZE];
+  while (position + LOG_BLOCK_HEADER_SIZE <= segment->file_size_ &&
+         PreadFully(segment->fd_, header, LOG_BLOCK_HEADER_SIZE, position)) {
+    uint32_t raw_size;
+    uint32_t stored_size;
+    memcpy(&raw_size, header, sizeof(uint32_t));
+    memcpy(&stored_size, header + 4, sizeof(uint32_t));
+    if (stored_size == 0 || stored_size > raw_size ||
+        position + LOG_BLOCK_HEADER_SIZE + stored_size > segment->file_size_) {
+      break;
+    }
+    segment->blocks_.push_back({segment->size_, position, raw_size, stored_size});
+    segment->size_ += raw_size;
+    position += LOG_BLOCK_HEADER_SIZE + stored_size;
+  }
+  // Only the last write can have been torn by a crash; its log records never became durable.
+  if (!segment->blocks_.empty() && !LoadLogBlock(*segment, segment->blocks_.size() - 1)) {
+    position = segment->blocks_.back().position_;
+    segment->size_ = segment->blocks_.back().offset_;
+    segment->blocks_.pop_back();
+  }
+  if (position < segment->file_size_ && ftruncate(segment->fd_, position) == 0) {
+    segment->file_size_ = position;
+  }
+}
+
+void DiskManager::AppendLogBlock(LogSegment *segment, const char *log_data, uint32_t size) {
+  std::vector<char> block(LOG_BLOCK_HEADER_SIZE + size);
+  // A block is only stored compressed if that makes it smaller.
+  auto stored_size =
+      static_cast<uint32_t>(CodingUtil::Compress(log_data, size, block.data() + LOG_BLOCK_HEADER_SIZE, size - 1));
+  if (stored_size == 0) {
+    memcpy(block.data() + LOG_BLOCK_HEADER_SIZE, log_data, size);
+    stored_size = size;
+  }
+  memcpy(block.data(), &size, sizeof(uint32_t));
+  memcpy(block.data() + 4, &stored_size, sizeof(uint32_t));
+  uint32_t checksum = CodingUtil::Crc32c(block.data(), 8);
+  checksum = CodingUtil::Crc32c(block.data() + LOG_BLOCK_HEADER_SIZE, stored_size, checksum);
+  memcpy(block.data() + 8, &checksum, sizeof(uint32_t));
+
+  size_t block_size = LOG_BLOCK_HEADER_SIZE + stored_size;
+  for (size_t written = 0; written < block_size;) {
+    ssize_t ret = pwrite(segment->fd_, block.data() + written, block_size - written, segment->file_size_ + written);
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while writing log");
+      return;
+    }
+    written += ret;
+  }
+  segment->blocks_.push_back({segment->size_, segment->file_size_, size, stored_size});
+  segment->file_size_ += block_size;
+  num_log_bytes_written_ += block_size;
+}
+
+bool DiskManager::ReadLogSegment(const LogSegment &segment, char *log_data, int64_t segment_offset, int64_t count) {
+  if (!segment.compressed_) {
+    return PreadFully(segment.fd_, log_data, count, LOG_SEGMENT_HEADER_SIZE + segment_offset);
+  }
+  // The last block that starts at or before the offset.
+  auto it = std::upper_bound(segment.blocks_.begin(), segment.blocks_.end(), segment_offset,
+                             [](int64_t offset, const LogBlock &block) { return offset < block.offset_; });
+  for (auto index = static_cast<size_t>(it - segment.blocks_.begin()) - 1; count > 0; ++index) {
+    if (!LoadLogBlock(segment, index)) {
+      return false;
+    }
+    int64_t block_offset = segment_offset - segment.blocks_[index].offset_;
+    int64_t n = std::min<int64_t>(count, segment.blocks_[index].raw_size_ - block_offset);
+    memcpy(log_data, cached_block_.data() + block_offset, n);
+    log_data += n;
+    segment_offset += n;
+    count -= n;
+  }
+  return true;
+}
+
+bool DiskManager::LoadLogBlock(const LogSegment &segment, size_t index) {
+  if (cached_block_segment_no_ == segment.segment_no_ && cached_block_index_ == index) {
+    return true;
+  }
+  const LogBlock &block = segment.blocks_[index];
+  std::vector<char> stored(LOG_BLOCK_HEADER_SIZE + block.stored_size_);
+  if (!PreadFully(segment.fd_, stored.data(), stored.size(), block.position_)) {
     return false;
   }
-  // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
-  if (read_count < size) {
-    log_io_.clear();
-    memset(log_data + read_count, 0, size - read_count);
+  uint32_t checksum;
+  memcpy(&checksum, stored.data() + 8, sizeof(uint32_t));
+  uint32_t expected = CodingUtil::Crc32c(stored.data(), 8);
+  if (checksum != CodingUtil::Crc32c(stored.data() + LOG_BLOCK_HEADER_SIZE, block.stored_size_, expected)) {
+    return false;
+  }
+  cached_block_segment_no_ = -1;
+  cached_block_.resize(block.raw_size_);
+  if (block.stored_size_ == block.raw_size_) {
+    memcpy(cached_block_.data(), stored.data() + LOG_BLOCK_HEADER_SIZE, block.raw_size_);
+  } else if (!CodingUtil::Decompress(stored.data() + LOG_BLOCK_HEADER_SIZE, block.stored_size_, cached_block_.data(),
+                                     block.raw_size_)) {
+    return false;
   }
+  cached_block_segment_no_ = segment.segment_no_;
+  cached_block_index_ = index;
+  return true;
+}
 
+bool DiskManager::PreadFully(int fd, char *data, size_t size, int64_t position) {
+  for (size_t read_count = 0; read_count < size;) {
+    ssize_t ret = pread(fd, data + read_count, size - read_count, position + read_count);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      return false;
+    }
+    read_count += ret;
+  }
   return true;
 }
 
@@ -196,11 +956,41 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
  */
 int DiskManager::GetNumFlushes() const { return num_flushes_; }
 
+/**
+ * Returns number of log syncs made so far
+ */
+int DiskManager::GetNumLogSyncs() const { return num_log_syncs_; }
+
 /**
  * Returns number of Writes made so far
  */
 int DiskManager::GetNumWrites() const { return num_writes_; }
 
+/**
+ * Returns number of write requests made so far
+ */
+int DiskManager::GetNumWriteCalls() const { return num_write_calls_; }
+
+/**
+ * Returns number of pages read with a wrong checksum so far
+ */
+int DiskManager::GetNumChecksumFailures() const { return num_checksum_failures_; }
+
+/**
+ * Returns number of torn pages restored when the database was opened
+ */
+int DiskManager::GetNumRestoredPages() const { return num_restored_pages_; }
+
+/**
+ * Returns number of file syncs made so far
+ */
+int DiskManager::GetNumSyncs() const { return num_syncs_; }
+
+/**
+ * Returns number of Reads made so far
+ */
+int DiskManager::GetNumReads() const { return num_reads_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
@@ -209,10 +999,10 @@ bool DiskManager::GetFlushState() const { return flush_log_; }
 /**
  * Private helper function to get disk file size
  */
-int DiskManager::GetFileSize(const std::string &file_name) {
+int64_t DiskManager::GetFileSize(const std::string &file_name) {
   struct stat stat_buf;
   int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? static_cast<int>(stat_buf.st_size) : -1;
+  return rc == 0 ? static_cast<int64_t>(stat_buf.st_size) : -1;
 }
 
 }  // namespace bustub
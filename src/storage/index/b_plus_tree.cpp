@@ -9,7 +9,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <string>
+#include <type_traits>
 
 #include "common/exception.h"
 #include "common/rid.h"
@@ -19,13 +22,14 @@
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, KeyCompression key_compression)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      key_compression_(key_compression) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
@@ -42,6 +46,29 @@ bool BPLUSTREE_TYPE::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID;
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
+  alignas(8) char leaf_copy[PAGE_SIZE];
+  uint64_t leaf_version;
+  bool restart;
+  for (int i = 0; i < MAX_OPTIMISTIC_RESTARTS; i++) {
+    Page *page = OptimisticFindLeafPage(key, leaf_copy, &leaf_version, &restart);
+    if (restart) {
+      num_optimistic_restarts_++;
+      continue;
+    }
+    if (page == nullptr) {
+      return false;
+    }
+    // the copy was validated, so the page itself is not needed anymore
+    UnpinPage(page);
+    LeafPage *leaf_node = reinterpret_cast<LeafPage *>(leaf_copy);
+    ValueType value;
+    if (leaf_node->Lookup(key, &value, comparator_)) {
+      result->push_back(value);
+      return true;
+    }
+    return false;
+  }
+  // too many writers in the way, crab down with read latches instead
   Page *page = FindLeafPage(key, false, LockType::READ, transaction);
   if (page == nullptr) {
     return false;
@@ -115,10 +142,13 @@ int BPLUSTREE_TYPE::LuckyInsert(const KeyType &key, const ValueType &value, Tran
     return -1;
   }
 
+  uint64_t version = leaf_page->GetVersion();
   leaf_page->RUnlatch();
   leaf_page->WLatch();
   PopLockedPage(LockType::READ, transaction);
-  if (leaf_node->GetSize() + 1 < leaf_node->GetMaxSize()) {
+  // a writer that got the leaf between the two latches may have freed it, which only the sad path can tell
+  if (version + 1 == leaf_page->GetVersion() && leaf_node->GetSize() + 1 < leaf_node->GetMaxSize() &&
+      leaf_node->HasRoomFor(key)) {
     leaf_node->Insert(key, value, comparator_);
     UnpinPage(leaf_page, true, LockType::INSERT);
     return 1;
@@ -142,6 +172,23 @@ bool BPLUSTREE_TYPE::SadInsert(const KeyType &key, const ValueType &value, Trans
   //  LOG_DEBUG("before sad insert leaf_page_id: %d",leaf_page->GetPageId());
   // std::cout<<std::this_thread::get_id()<<"begin sad Insert\n";
   LeafPage *leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+  if (!leaf_node->HasRoomFor(key)) {
+    if (leaf_node->KeyIndex(key, comparator_) != -1) {
+      PopLockedPage(LockType::INSERT, transaction);
+      UnpinPage(leaf_page, false, LockType::INSERT);
+      return false;
+    }
+    // a PREFIX leaf that the key does not fit into is split first
+    std::vector<MappingType> items = leaf_node->GetItems();
+    auto key_before = [this](const MappingType &item, const KeyType &k) { return comparator_(item.first, k) < 0; };
+    auto position = std::lower_bound(items.begin(), items.end(), key, key_before);
+    int index = position - items.begin();
+    items.insert(position, std::make_pair(key, value));
+    SplitInsert(leaf_node, &items, index);
+    PopLockedPage(LockType::INSERT, transaction);
+    UnpinPage(leaf_page, true, LockType::INSERT);
+    return true;
+  }
   int pre_size = leaf_node->GetSize();
   int now_size = leaf_node->Insert(key, value, comparator_);
   // LOG_DEBUG("%d pre_size: %d ,now_size: %d",leaf_page->GetPageId(),pre_size,now_size);
@@ -155,23 +202,8 @@ bool BPLUSTREE_TYPE::SadInsert(const KeyType &key, const ValueType &value, Trans
   if (leaf_node->GetSize() == leaf_node->GetMaxSize()) {
     // LOG_DEBUG("%d need split",leaf_page->GetPageId());
     LeafPage *new_node = Split(leaf_node);
-    InsertIntoParent(leaf_node, new_node->KeyAt(0), new_node);
+    InsertIntoParent(leaf_node, Separator(leaf_node->KeyAt(leaf_node->GetSize() - 1), new_node->KeyAt(0)), new_node);
     buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);
-    page_id_t parent_page_id = leaf_node->GetParentPageId();
-    Page *cur_page = FetchPage(parent_page_id);
-    InternalPage *cur_node = reinterpret_cast<InternalPage *>(cur_page->GetData());
-    while (cur_node->GetSize() == cur_node->GetMaxSize()) {
-      // LOG_DEBUG("%d need split",cur_page->GetPageId());
-      InternalPage *new_inter_page = Split(cur_node);
-      InsertIntoParent(cur_node, new_inter_page->KeyAt(0), new_inter_page);
-      parent_page_id = cur_node->GetParentPageId();
-      buffer_pool_manager_->UnpinPage(new_inter_page->GetPageId(), true);
-      buffer_pool_manager_->UnpinPage(cur_node->GetPageId(), true);
-      cur_page = FetchPage(parent_page_id);
-      cur_node = reinterpret_cast<InternalPage *>(cur_page->GetData());
-    }
-    // the lastone is not modified
-    UnpinPage(cur_page);
   }
   PopLockedPage(LockType::INSERT, transaction);
   // LOG_DEBUG("leaf_page_id: %d",leaf_page->GetPageId());
@@ -190,7 +222,7 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
   page_id_t new_root_id = INVALID_PAGE_ID;
   Page *new_root_page = NewPage(&new_root_id);
   LeafPage *root_node = reinterpret_cast<LeafPage *>(new_root_page->GetData());
-  root_node->Init(new_root_id, INVALID_PAGE_ID, leaf_max_size_);
+  root_node->Init(new_root_id, INVALID_PAGE_ID, leaf_max_size_, key_compression_);
   root_node->Insert(key, value, comparator_);
   root_page_id_ = new_root_id;
   UpdateRootPageId(true);
@@ -215,17 +247,119 @@ N *BPLUSTREE_TYPE::Split(N *node) {
   if (pre_node->IsLeafPage()) {
     LeafPage *leaf_node = reinterpret_cast<LeafPage *>(pre_node);
     LeafPage *sib_node = reinterpret_cast<LeafPage *>(page->GetData());
-    sib_node->Init(page_id, leaf_node->GetParentPageId(), leaf_max_size_);
+    sib_node->Init(page_id, leaf_node->GetParentPageId(), leaf_max_size_, key_compression_);
     leaf_node->MoveHalfTo(sib_node);
   } else {
     InternalPage *internal_node = reinterpret_cast<InternalPage *>(pre_node);
     InternalPage *sib_node = reinterpret_cast<InternalPage *>(page->GetData());
-    sib_node->Init(page_id, internal_node->GetParentPageId(), internal_max_size_);
+    sib_node->Init(page_id, internal_node->GetParentPageId(), internal_max_size_, key_compression_);
     internal_node->MoveHalfTo(sib_node, buffer_pool_manager_);
   }
   page->WUnlatch();
   return reinterpret_cast<N *>(page->GetData());
 }
+
+/*
+ * Split a PREFIX page whose entries do not fit into it together with a new
+ * one. items are the entries with the new one at index. They are spread over
+ * the page and one new page, split as close to the middle as both parts fit,
+ * or if no such split exists, over the page, a new page with just the new
+ * entry and a new page with the entries after it; both other parts fit, as
+ * they did before. The new pages are inserted into the parent.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N, typename V>
+void BPLUSTREE_TYPE::SplitInsert(N *node, std::vector<std::pair<KeyType, V>> *items, int index) {
+  int size = items->size();
+  auto fits = [node, items](int begin, int end) {
+    return end - begin < node->GetMaxSize() && N::PrefixItemsFit(items->data() + begin, end - begin);
+  };
+  // the index of the first entry of each new page
+  std::vector<int> begins;
+  for (int offset = 0; offset <= size / 2 && begins.empty(); offset++) {
+    for (int begin : {size / 2 - offset, size / 2 + offset}) {
+      if (begin > 0 && begin < size && fits(0, begin) && fits(begin, size)) {
+        begins = {begin};
+        break;
+      }
+    }
+  }
+  if (begins.empty()) {
+    begins = {index, index + 1};
+  }
+
+  std::vector<Page *> new_pages;
+  for (size_t i = 0; i < begins.size(); i++) {
+    int begin = begins[i];
+    int end = i + 1 < begins.size() ? begins[i + 1] : size;
+    page_id_t page_id = INVALID_PAGE_ID;
+    Page *page = NewPage(&page_id);
+    N *new_node = reinterpret_cast<N *>(page->GetData());
+    new_node->Init(page_id, node->GetParentPageId(), node->GetMaxSize(), key_compression_);
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      new_node->CopyNFrom(items->data() + begin, end - begin);
+      N *prev_node = new_pages.empty() ? node : reinterpret_cast<N *>(new_pages.back()->GetData());
+      new_node->SetNextPageId(prev_node->GetNextPageId());
+      prev_node->SetNextPageId(page_id);
+    } else {
+      new_node->CopyNFrom(items->data() + begin, end - begin, buffer_pool_manager_);
+    }
+    page->WUnlatch();
+    new_pages.push_back(page);
+  }
+  // the entries that stay in the page belong to it already, so it takes them without adopting them again
+  node->SetSize(0);
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    node->CopyNFrom(items->data(), begins[0]);
+  } else {
+    node->SetItems(items->data(), begins[0]);
+  }
+
+  BPlusTreePage *prev_node = node;
+  for (size_t i = 0; i < begins.size(); i++) {
+    BPlusTreePage *new_node = reinterpret_cast<BPlusTreePage *>(new_pages[i]->GetData());
+    const KeyType &first_key = (*items)[begins[i]].first;
+    KeyType separator = new_node->IsLeafPage() ? Separator((*items)[begins[i] - 1].first, first_key) : first_key;
+    InsertIntoParent(prev_node, separator, new_node);
+    prev_node = new_node;
+  }
+  for (Page *page : new_pages) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  }
+}
+
+/*
+ * Return the key that goes into the parent between two leaves, whose keys end
+ * with left and start with right. A NONE tree uses right. A PREFIX tree cuts
+ * right down to the shortest key that still sorts after left: the bytes after
+ * some length are zeroed, except for those that left and right share, which
+ * keeps parts that every key has in common, like the offsets of varchars,
+ * intact. As the comparator need not follow the byte order, every candidate is
+ * checked with it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+KeyType BPLUSTREE_TYPE::Separator(const KeyType &left, const KeyType &right) const {
+  if (key_compression_ == KeyCompression::NONE) {
+    return right;
+  }
+  const auto *left_data = reinterpret_cast<const char *>(&left);
+  const auto *right_data = reinterpret_cast<const char *>(&right);
+  size_t right_length = KeyTrimmedLength(right);
+  for (size_t length = KeyPrefixLength(left, right) + 1; length < right_length; length++) {
+    KeyType separator = right;
+    auto *separator_data = reinterpret_cast<char *>(&separator);
+    for (size_t i = length; i < sizeof(KeyType); i++) {
+      if (left_data[i] != right_data[i]) {
+        separator_data[i] = 0;
+      }
+    }
+    if (comparator_(left, separator) < 0 && comparator_(separator, right) <= 0) {
+      return separator;
+    }
+  }
+  return right;
+}
+
 /*
  * Insert key & value pair into internal page after split
  * @param   old_node      input page from split() method
@@ -242,7 +376,7 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
     page_id_t new_root_id = INVALID_PAGE_ID;
     Page *new_root_page = NewPage(&new_root_id);
     InternalPage *new_root_node = reinterpret_cast<InternalPage *>(new_root_page->GetData());
-    new_root_node->Init(new_root_id, INVALID_PAGE_ID, internal_max_size_);
+    new_root_node->Init(new_root_id, INVALID_PAGE_ID, internal_max_size_, key_compression_);
     old_node->SetParentPageId(new_root_id);
     new_node->SetParentPageId(new_root_id);
     new_root_node->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
@@ -255,10 +389,223 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
   }
   Page *parent_page = FetchPage(old_node->GetParentPageId());
   InternalPage *parent_node = reinterpret_cast<InternalPage *>(parent_page->GetData());
-  parent_node->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+  // the parent may have been split since the new node was created
+  new_node->SetParentPageId(parent_page->GetPageId());
+  if (!parent_node->HasRoomFor(key)) {
+    std::vector<std::pair<KeyType, page_id_t>> items = parent_node->GetItems();
+    int index = parent_node->ValueIndex(old_node->GetPageId()) + 1;
+    items.emplace(items.begin() + index, key, new_node->GetPageId());
+    SplitInsert(parent_node, &items, index);
+  } else {
+    parent_node->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+    if (parent_node->GetSize() == parent_node->GetMaxSize()) {
+      InternalPage *new_parent_node = Split(parent_node);
+      InsertIntoParent(parent_node, new_parent_node->KeyAt(0), new_parent_node);
+      buffer_pool_manager_->UnpinPage(new_parent_node->GetPageId(), true);
+    }
+  }
   UnpinPage(parent_page, true);
 }
 
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Build the tree bottom up from key & value pairs sorted by key, instead of
+ * inserting them one by one. Leaves are filled up to fill_factor and written
+ * from left to right, and every node written is handed to the level above as
+ * a child, so that all levels are built in the same pass over the input. Each
+ * level holds back enough for one node of min size, so that its last node is
+ * never too small. The root is installed last: readers see either the empty
+ * tree or the complete one.
+ * A PREFIX tree fills its nodes up to fill_factor of the bytes of a page
+ * instead, so the last node of each level may be small.
+ * Of equal keys only the first is loaded, as Insert would do.
+ * @return: false if the tree is not empty, in which case nothing is loaded
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoad(const std::function<bool(MappingType *)> &next, double fill_factor) {
+  if (!IsEmpty()) {
+    return false;
+  }
+  // nodes hold at most max size - 1 entries, since they split when they reach max size
+  int leaf_min_size = std::max(leaf_max_size_ / 2, 1);
+  int internal_min_size = std::max(internal_max_size_ / 2, 1);
+  BulkLoadState state;
+  int leaf_fill = static_cast<int>(fill_factor * (leaf_max_size_ - 1));
+  int internal_fill = static_cast<int>(fill_factor * (internal_max_size_ - 1));
+  state.leaf_fill_ = std::clamp(leaf_fill, leaf_min_size, leaf_max_size_ - 1);
+  // an inner node needs two children at least, or the levels above would never get narrower
+  state.internal_fill_ = std::max(std::clamp(internal_fill, internal_min_size, internal_max_size_ - 1), 2);
+  // two entries with whole keys fit at least, so that the levels get narrower
+  state.leaf_budget_ = std::max<size_t>(fill_factor * (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE),
+                                        2 * (sizeof(KeyType) + sizeof(ValueType)));
+  state.internal_budget_ = std::max<size_t>(fill_factor * (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE),
+                                            2 * (sizeof(KeyType) + sizeof(page_id_t)));
+  bool prefix = key_compression_ == KeyCompression::PREFIX;
+
+  MappingType item;
+  KeyType last_key{};
+  bool first = true;
+  while (next(&item)) {
+    if (!first) {
+      int cmp = comparator_(last_key, item.first);
+      BUSTUB_ASSERT(cmp <= 0, "The entries of a bulk load must be sorted by key.");
+      if (cmp == 0) {
+        continue;
+      }
+    }
+    first = false;
+    last_key = item.first;
+    if (prefix) {
+      const KeyType &first_key = state.entries_.empty() ? item.first : state.entries_[0].first;
+      int size = state.entries_.size();
+      if (!state.leaf_layout_.Add(first_key, item.first, size, sizeof(ValueType), state.leaf_budget_) ||
+          size == leaf_max_size_ - 1) {
+        BulkLoadLeaf(&state, size);
+        state.leaf_layout_ = PendingLayout();
+        state.leaf_layout_.Add(item.first, item.first, 0, sizeof(ValueType), state.leaf_budget_);
+      }
+      state.entries_.push_back(item);
+      continue;
+    }
+    state.entries_.push_back(item);
+    if (static_cast<int>(state.entries_.size()) == state.leaf_fill_ + leaf_min_size) {
+      BulkLoadLeaf(&state, state.leaf_fill_);
+    }
+  }
+  // the rest fits into one leaf, or two leaves of at least min size
+  int rest = state.entries_.size();
+  if (prefix && rest > 0) {
+    BulkLoadLeaf(&state, rest);
+  } else if (rest > leaf_max_size_ - 1) {
+    BulkLoadLeaf(&state, rest - rest / 2);
+    BulkLoadLeaf(&state, rest / 2);
+  } else if (rest > 0) {
+    BulkLoadLeaf(&state, rest);
+  }
+  if (state.prev_leaf_ == nullptr) {
+    return true;
+  }
+  UnpinPage(state.prev_leaf_, true, LockType::INSERT);
+
+  page_id_t root_id = INVALID_PAGE_ID;
+  for (size_t level = 0;; level++) {
+    rest = state.children_[level].size();
+    if (level + 1 == state.children_.size() && rest == 1) {
+      root_id = state.children_[level][0].second;
+      break;
+    }
+    if (prefix) {
+      BulkLoadInternal(&state, level, rest);
+    } else if (rest > internal_max_size_ - 1) {
+      BulkLoadInternal(&state, level, rest - rest / 2);
+      BulkLoadInternal(&state, level, rest / 2);
+    } else {
+      BulkLoadInternal(&state, level, rest);
+    }
+  }
+
+  mu_.lock();
+  if (!IsEmpty()) {
+    // an insert started a tree meanwhile
+    mu_.unlock();
+    for (page_id_t page_id : state.page_ids_) {
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+    return false;
+  }
+  root_page_id_ = root_id;
+  UpdateRootPageId(true);
+  mu_.unlock();
+  return true;
+}
+
+/*
+ * Write the first count pending entries of a bulk load into a new leaf, link
+ * it to the previous leaf and hand it to the level above.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadLeaf(BulkLoadState *state, int count) {
+  page_id_t page_id = INVALID_PAGE_ID;
+  Page *page = NewPage(&page_id);
+  LeafPage *leaf_node = reinterpret_cast<LeafPage *>(page->GetData());
+  leaf_node->Init(page_id, INVALID_PAGE_ID, leaf_max_size_, key_compression_);
+  leaf_node->CopyNFrom(state->entries_.data(), count);
+  state->entries_.erase(state->entries_.begin(), state->entries_.begin() + count);
+  KeyType key = leaf_node->KeyAt(0);
+  if (state->prev_leaf_ != nullptr) {
+    LeafPage *prev_leaf_node = reinterpret_cast<LeafPage *>(state->prev_leaf_->GetData());
+    prev_leaf_node->SetNextPageId(page_id);
+    key = Separator(prev_leaf_node->KeyAt(prev_leaf_node->GetSize() - 1), key);
+    UnpinPage(state->prev_leaf_, true, LockType::INSERT);
+  }
+  state->prev_leaf_ = page;
+  state->page_ids_.push_back(page_id);
+  BulkLoadAddChild(state, 0, key, page_id);
+}
+
+/*
+ * Write the first count pending children of a level into a new internal page,
+ * which adopts them, and hand it to the level above.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadInternal(BulkLoadState *state, size_t level, int count) {
+  page_id_t page_id = INVALID_PAGE_ID;
+  Page *page = NewPage(&page_id);
+  InternalPage *internal_node = reinterpret_cast<InternalPage *>(page->GetData());
+  internal_node->Init(page_id, INVALID_PAGE_ID, internal_max_size_, key_compression_);
+  ChildList &children = state->children_[level];
+  internal_node->CopyNFrom(children.data(), count, buffer_pool_manager_);
+  children.erase(children.begin(), children.begin() + count);
+  KeyType key = internal_node->KeyAt(0);
+  UnpinPage(page, true, LockType::INSERT);
+  state->page_ids_.push_back(page_id);
+  BulkLoadAddChild(state, level + 1, key, page_id);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadAddChild(BulkLoadState *state, size_t level, const KeyType &key, page_id_t page_id) {
+  if (state->children_.size() == level) {
+    state->children_.emplace_back();
+    state->child_layouts_.emplace_back();
+  }
+  if (key_compression_ == KeyCompression::PREFIX) {
+    ChildList &children = state->children_[level];
+    PendingLayout &layout = state->child_layouts_[level];
+    int size = children.size();
+    const KeyType &first_key = children.empty() ? key : children[0].first;
+    if (!layout.Add(first_key, key, size, sizeof(page_id_t), state->internal_budget_) ||
+        size == std::max(internal_max_size_ - 1, 2)) {
+      BulkLoadInternal(state, level, size);
+      // the level above may have been added, which moves the layouts
+      state->child_layouts_[level] = PendingLayout();
+      state->child_layouts_[level].Add(key, key, 0, sizeof(page_id_t), state->internal_budget_);
+    }
+    state->children_[level].emplace_back(key, page_id);
+    return;
+  }
+  state->children_[level].emplace_back(key, page_id);
+  if (static_cast<int>(state->children_[level].size()) ==
+      state->internal_fill_ + std::max(internal_max_size_ / 2, 1)) {
+    BulkLoadInternal(state, level, state->internal_fill_);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::PendingLayout::Add(const KeyType &first, const KeyType &key, int size, size_t value_size,
+                                        size_t budget) {
+  size_t prefix_size = std::min(prefix_size_, KeyPrefixLength(first, key));
+  size_t key_end = std::max(key_end_, KeyTrimmedLength(key));
+  size_t bytes = std::min(prefix_size, key_end) + (size + 1) * (key_end - std::min(prefix_size, key_end) + value_size);
+  if (bytes > budget) {
+    return false;
+  }
+  prefix_size_ = prefix_size;
+  key_end_ = key_end;
+  return true;
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -292,10 +639,13 @@ int BPLUSTREE_TYPE::LuckyRemove(const KeyType &key, Transaction *transaction) {
     return -1;
   }
 
+  uint64_t version = leaf_page->GetVersion();
   leaf_page->RUnlatch();
   leaf_page->WLatch();
   PopLockedPage(LockType::READ, transaction);
-  if (leaf_node->GetSize() > leaf_node->GetMinSize()) {
+  // a PREFIX leaf is only freed once it is empty, see RemoveEmptyLeaf
+  int min_size = key_compression_ == KeyCompression::PREFIX ? 1 : leaf_node->GetMinSize();
+  if (version + 1 == leaf_page->GetVersion() && leaf_node->GetSize() > min_size) {
     leaf_node->RemoveAndDeleteRecord(key, comparator_);
     UnpinPage(leaf_page, true, LockType::INSERT);
     return 1;
@@ -335,7 +685,9 @@ void BPLUSTREE_TYPE::SadRemove(const KeyType &key, Transaction *transaction) {
     if (del) {
       transaction->AddIntoDeletedPageSet(leaf_page->GetPageId());
     }
-  } else if (leaf_node->GetSize() < leaf_node->GetMinSize()) {
+  } else if (leaf_node->GetSize() == 0 && key_compression_ == KeyCompression::PREFIX) {
+    RemoveEmptyLeaf(leaf_page, transaction);
+  } else if (leaf_node->GetSize() < leaf_node->GetMinSize() && key_compression_ == KeyCompression::NONE) {
     // std::cout << "need to col or merge\n";
     del = CoalesceOrRedistribute(leaf_node, transaction);
     if (del) {
@@ -374,7 +726,7 @@ void BPLUSTREE_TYPE::SadRemove(const KeyType &key, Transaction *transaction) {
   }
   PopLockedPage(LockType::DELETE, transaction);
   UnpinPage(leaf_page, true, LockType::DELETE);
-  auto delete_page_set = *transaction->GetDeletedPageSet().get();
+  auto &delete_page_set = *transaction->GetDeletedPageSet().get();
   for (auto &page_id : delete_page_set) {
     buffer_pool_manager_->DeletePage(page_id);
   }
@@ -392,6 +744,118 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
   SadRemove(key, transaction);
 }
 
+/*
+ * Free an empty PREFIX leaf that is not the root, the only change to the
+ * structure of a PREFIX tree that removes make. The caller holds the pages
+ * above the leaf latched in the page set, down from the first one that keeps
+ * another child, and the leaf goes together with the nodes above it that have
+ * no other child. Since the leaf before it points to it, the leaf itself stays
+ * if the leaf after it is under the first node that stays, and takes over the
+ * place and the entries of that leaf, which is freed instead. Otherwise the
+ * leaf before it, the rightmost one under the left sibling of the topmost node
+ * that goes, takes over its next page id. Leaves are latched left to right
+ * like the iterator does, so the leaf is released meanwhile, and it is kept if
+ * an insert got into it. A root that is left with one child is replaced by
+ * it, and a root that is left without any leaf leaves the tree empty.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveEmptyLeaf(Page *leaf_page, Transaction *transaction) {
+  LeafPage *leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+  std::deque<Page *> *page_set = transaction->GetPageSet().get();
+  size_t top = page_set->size();
+  while (top > 0 && reinterpret_cast<InternalPage *>((*page_set)[top - 1]->GetData())->GetSize() == 1) {
+    top--;
+  }
+  if (top == 0) {
+    // the page set starts at the root, as it only leaves out nodes above one that keeps another child
+    reinterpret_cast<InternalPage *>(page_set->front()->GetData())->RemoveAndReturnOnlyChild();
+    mu_.lock();
+    root_page_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId();
+    mu_.unlock();
+    for (Page *page : *page_set) {
+      transaction->AddIntoDeletedPageSet(page->GetPageId());
+    }
+    transaction->AddIntoDeletedPageSet(leaf_page->GetPageId());
+    return;
+  }
+  // pinned once more to mark it dirty, as the page set is released clean
+  Page *parent_page = FetchPage((*page_set)[top - 1]->GetPageId());
+  InternalPage *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  size_t height = page_set->size() - top;
+  int index = parent->ValueIndex(height == 0 ? leaf_page->GetPageId() : (*page_set)[top]->GetPageId());
+  if (index + 1 < parent->GetSize()) {
+    Page *next_parent_page = nullptr;
+    Page *next_page = FetchOuterLeaf(parent->ValueAt(index + 1), height, true, &next_parent_page);
+    reinterpret_cast<LeafPage *>(next_page->GetData())->MoveAllTo(leaf_node);
+    if (next_parent_page == nullptr) {
+      next_parent_page = FetchPage(parent_page->GetPageId(), LockType::NOLOCK);
+    } else {
+      leaf_node->SetParentPageId(next_parent_page->GetPageId());
+    }
+    InternalPage *next_parent = reinterpret_cast<InternalPage *>(next_parent_page->GetData());
+    next_parent->SetValueAt(next_parent->ValueIndex(next_page->GetPageId()), leaf_page->GetPageId());
+    UnpinPage(next_parent_page, true, height == 0 ? LockType::NOLOCK : LockType::DELETE);
+    transaction->AddIntoDeletedPageSet(next_page->GetPageId());
+    UnpinPage(next_page, true, LockType::DELETE);
+    // the leaf is in the place of the next one now, and the nodes above it go
+    parent->Remove(index);
+  } else {
+    leaf_page->WUnlatch();
+    Page *prev_page = FetchOuterLeaf(parent->ValueAt(index - 1), height, false);
+    leaf_page->WLatch();
+    if (leaf_node->GetSize() != 0) {
+      UnpinPage(prev_page, false, LockType::DELETE);
+      UnpinPage(parent_page);
+      return;
+    }
+    leaf_node->MoveAllTo(reinterpret_cast<LeafPage *>(prev_page->GetData()));
+    UnpinPage(prev_page, true, LockType::DELETE);
+    transaction->AddIntoDeletedPageSet(leaf_page->GetPageId());
+    parent->Remove(index);
+  }
+  for (size_t i = top; i < page_set->size(); i++) {
+    transaction->AddIntoDeletedPageSet((*page_set)[i]->GetPageId());
+  }
+  if (parent->IsRootPage() && parent->GetSize() == 1) {
+    page_id_t new_root_id = parent->RemoveAndReturnOnlyChild();
+    Page *new_root_page = FetchPage(new_root_id);
+    reinterpret_cast<BPlusTreePage *>(new_root_page->GetData())->SetParentPageId(INVALID_PAGE_ID);
+    UnpinPage(new_root_page, true);
+    mu_.lock();
+    root_page_id_ = new_root_id;
+    UpdateRootPageId();
+    mu_.unlock();
+    transaction->AddIntoDeletedPageSet(parent_page->GetPageId());
+  }
+  UnpinPage(parent_page, true);
+}
+
+/*
+ * Latch the leftmost or the rightmost leaf of the subtree whose root is height
+ * levels above its leaves for writing, with read latches crabbing down to it.
+ * With parent_page, the parent of the leaf is latched for writing too, and
+ * returned there, unless the leaf is the root of the subtree.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FetchOuterLeaf(page_id_t page_id, size_t height, bool leftmost, Page **parent_page) {
+  auto lock_type = [&](size_t level) {
+    return level == 0 || (level == 1 && parent_page != nullptr) ? LockType::DELETE : LockType::READ;
+  };
+  Page *page = FetchPage(page_id, lock_type(height));
+  for (; height > 0; height--) {
+    InternalPage *node = reinterpret_cast<InternalPage *>(page->GetData());
+    Page *child_page = FetchPage(node->ValueAt(leftmost ? 0 : node->GetSize() - 1), lock_type(height - 1));
+    if (height == 1 && parent_page != nullptr) {
+      *parent_page = page;
+    } else {
+      UnpinPage(page, false, lock_type(height));
+    }
+    page = child_page;
+  }
+  return page;
+}
+
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
@@ -535,7 +999,7 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, bool move_front,
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
-  KeyType key;
+  KeyType key{};
   Page *page = FindLeafPage(key, true, LockType::READ);
   if (page == nullptr) {
     return End();
@@ -549,6 +1013,25 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
+  alignas(8) char leaf_copy[PAGE_SIZE];
+  uint64_t leaf_version;
+  bool restart;
+  for (int i = 0; i < MAX_OPTIMISTIC_RESTARTS; i++) {
+    Page *page = OptimisticFindLeafPage(key, leaf_copy, &leaf_version, &restart);
+    if (page == nullptr && !restart) {
+      return End();
+    }
+    if (page != nullptr) {
+      // the iterator reads the leaf itself, under a read latch that is only valid if the leaf did not change since
+      page->RLatch();
+      if (page->ValidateVersion(leaf_version)) {
+        LeafPage *leaf_node = reinterpret_cast<LeafPage *>(page->GetData());
+        return INDEXITERATOR_TYPE(page, leaf_node->KeyIndex(key, comparator_), buffer_pool_manager_, false);
+      }
+      UnpinPage(page, false, LockType::READ);
+    }
+    num_optimistic_restarts_++;
+  }
   Page *page = FindLeafPage(key, false, LockType::READ);
   if (page == nullptr) {
     return End();
@@ -574,11 +1057,85 @@ INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::IsSafe(N *node, LockType lock_type) {
   BPlusTreePage *cur_node = reinterpret_cast<BPlusTreePage *>(node);
+  if (cur_node->GetKeyCompression() == KeyCompression::PREFIX) {
+    if (lock_type == LockType::DELETE) {
+      // only a leaf that becomes empty changes the tree, along with the nodes above it that have no other child
+      return cur_node->GetSize() > 1;
+    }
+    // a leaf takes one more entry, an inner node up to two, when a child is split in three
+    if (cur_node->IsLeafPage()) {
+      return cur_node->GetSize() + 1 < cur_node->GetMaxSize() &&
+             reinterpret_cast<LeafPage *>(cur_node)->HasRoomForAny(1);
+    }
+    return cur_node->GetSize() + 2 < cur_node->GetMaxSize() &&
+           reinterpret_cast<InternalPage *>(cur_node)->HasRoomForAny(2);
+  }
   if (lock_type == LockType::DELETE) {
     return cur_node->GetSize() > cur_node->GetMinSize();
   }
   return cur_node->GetSize() + 1 < cur_node->GetMaxSize();
 }
+/*
+ * Find leaf page containing particular key with optimistic lock coupling: no
+ * page latch is taken on the way down. Every node is pinned and copied into
+ * copy, and the copy is used only once the page version shows that no writer
+ * latched the node meanwhile. The version of the parent is validated again
+ * after the child is pinned, so the child pointer that led there was current.
+ * @return : the leaf page, pinned but not latched, with a validated copy of it
+ * in copy and its version in leaf_version. nullptr if the tree is empty, or
+ * with restart set if a concurrent writer got in the way
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::OptimisticFindLeafPage(const KeyType &key, char *copy, uint64_t *leaf_version, bool *restart) {
+  *restart = false;
+  page_id_t root_id = root_page_id_;
+  if (root_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  Page *page = FetchPage(root_id);
+  uint64_t version = page->GetVersion();
+  bool valid = version % 2 == 0;
+  if (valid) {
+    BPlusTreePage *node = CopyNode(page, copy);
+    // the root may have been split, emptied or even deleted before it was pinned
+    valid = page->ValidateVersion(version) && node->IsRootPage() && node->GetSize() > 0 && root_page_id_ == root_id;
+  }
+  while (valid && !reinterpret_cast<BPlusTreePage *>(copy)->IsLeafPage()) {
+    page_id_t child_id = reinterpret_cast<InternalPage *>(copy)->Lookup(key, comparator_);
+    Page *child_page = FetchPage(child_id);
+    uint64_t child_version = child_page->GetVersion();
+    valid = child_version % 2 == 0 && page->ValidateVersion(version);
+    UnpinPage(page);
+    page = child_page;
+    version = child_version;
+    if (valid) {
+      CopyNode(page, copy);
+      valid = page->ValidateVersion(version);
+    }
+  }
+  if (!valid) {
+    UnpinPage(page);
+    *restart = true;
+    return nullptr;
+  }
+  *leaf_version = version;
+  return page;
+}
+
+/*
+ * Copy the header and the used entries of a node read without a latch. The
+ * size read here may be torn by a writer, so the copy is bounded by the page;
+ * it is only meaningful once the page version has been validated.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+BPlusTreePage *BPLUSTREE_TYPE::CopyNode(Page *page, char *copy) {
+  BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  size_t bytes = node->IsLeafPage() ? reinterpret_cast<LeafPage *>(node)->GetUsedBytes()
+                                    : reinterpret_cast<InternalPage *>(node)->GetUsedBytes();
+  memcpy(copy, page->GetData(), std::min<size_t>(bytes, PAGE_SIZE));
+  return reinterpret_cast<BPlusTreePage *>(copy);
+}
+
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
  * the left most leaf page
@@ -617,11 +1174,8 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost, LockType l
       PopLockedPage(lock_type, transcation);
     }
     if (transcation == nullptr) {
-      if (lock_type == LockType::READ) {
-        page->RUnlatch();
-      } else {
-        page->WUnlatch();
-      }
+      // without a transaction the parent is not in a page set, so release it here
+      UnpinPage(page, false, lock_type);
     }
     page = child_page;
   }
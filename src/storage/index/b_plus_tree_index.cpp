@@ -16,16 +16,21 @@ namespace bustub {
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
+BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                                     KeyCompression key_compression)
     : Index(std::move(metadata)),
-      comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_) {}
+      comparator_(GetMetadata()->GetKeySchema(), GetMetadata()->GetKeyFormat()),
+      buffer_pool_manager_(buffer_pool_manager),
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_,
+                 key_compression == KeyCompression::PREFIX ? LEAF_PAGE_PREFIX_SIZE : LEAF_PAGE_SIZE,
+                 key_compression == KeyCompression::PREFIX ? INTERNAL_PAGE_PREFIX_SIZE : INTERNAL_PAGE_SIZE,
+                 key_compression) {}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetMetadata()->GetKeySchema(), GetMetadata()->GetKeyFormat());
 
   container_.Insert(index_key, rid, transaction);
 }
@@ -34,7 +39,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetMetadata()->GetKeySchema(), GetMetadata()->GetKeyFormat());
 
   container_.Remove(index_key, transaction);
 }
@@ -43,11 +48,25 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetMetadata()->GetKeySchema(), GetMetadata()->GetKeyFormat());
 
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::BulkLoad(const std::function<bool(Tuple *key, RID *rid)> &next) {
+  ExternalSort<KeyType, ValueType, KeyComparator> sort(buffer_pool_manager_, comparator_);
+  Tuple key;
+  RID rid;
+  while (next(&key, &rid)) {
+    KeyType index_key;
+    index_key.SetFromKey(key, GetMetadata()->GetKeySchema(), GetMetadata()->GetKeyFormat());
+    sort.Add(index_key, rid);
+  }
+  sort.Finish();
+  return container_.BulkLoad([&sort](MappingType *item) { return sort.Next(item); });
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() { return container_.Begin(); }
 
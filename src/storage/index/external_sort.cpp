@@ -0,0 +1,217 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort.cpp
+//
+// Identification: src/storage/index/external_sort.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/external_sort.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORT_TYPE::ExternalSort(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                                 size_t buffer_pages)
+    : buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      buffer_capacity_(std::max<size_t>(1, buffer_pages) * ENTRIES_PER_PAGE),
+      merge_fan_in_(std::max<size_t>(2, buffer_pool_manager->GetPoolSize() / 2)) {
+  buffer_.reserve(buffer_capacity_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORT_TYPE::~ExternalSort() {
+  for (auto &run : runs_) {
+    if (run.page_ != nullptr) {
+      buffer_pool_manager_->UnpinPage(run.page_->GetPageId(), false);
+    }
+    // the pages before the one at the position were deleted by Advance already
+    for (size_t i = run.position_ / ENTRIES_PER_PAGE; run.position_ < run.size_ && i < run.page_ids_.size(); i++) {
+      buffer_pool_manager_->DeletePage(run.page_ids_[i]);
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::Add(const KeyType &key, const ValueType &value) {
+  BUSTUB_ASSERT(!finished_, "Cannot add entries to a finished sort.");
+  buffer_.emplace_back(key, value);
+  if (buffer_.size() == buffer_capacity_) {
+    SpillBuffer();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::SpillBuffer() {
+  std::stable_sort(buffer_.begin(), buffer_.end(), [this](const MappingType &lhs, const MappingType &rhs) {
+    return comparator_(lhs.first, rhs.first) < 0;
+  });
+  Run run;
+  run.size_ = buffer_.size();
+  for (size_t i = 0; i < buffer_.size(); i += ENTRIES_PER_PAGE) {
+    page_id_t page_id;
+    Page *page = buffer_pool_manager_->NewPageWithStrategy(&page_id, &strategy_);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "all page pined!");
+    }
+    size_t count = std::min(ENTRIES_PER_PAGE, buffer_.size() - i);
+    memcpy(page->GetData(), reinterpret_cast<const void *>(&buffer_[i]), count * sizeof(MappingType));
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    run.page_ids_.push_back(page_id);
+  }
+  runs_.push_back(std::move(run));
+  num_runs_++;
+  buffer_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::Finish() {
+  BUSTUB_ASSERT(!finished_, "Cannot finish a sort twice.");
+  finished_ = true;
+  if (runs_.empty()) {
+    // everything fits in memory, so there is nothing to merge
+    std::stable_sort(buffer_.begin(), buffer_.end(), [this](const MappingType &lhs, const MappingType &rhs) {
+      return comparator_(lhs.first, rhs.first) < 0;
+    });
+    return;
+  }
+  if (!buffer_.empty()) {
+    SpillBuffer();
+  }
+  buffer_.shrink_to_fit();
+  while (runs_.size() > merge_fan_in_) {
+    MergePass();
+  }
+  StartMerge(0, runs_.size());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::StartMerge(size_t first, size_t last) {
+  merge_heap_.clear();
+  for (size_t i = first; i < last; i++) {
+    Run &run = runs_[i];
+    run.page_ = buffer_pool_manager_->FetchPageWithStrategy(run.page_ids_[0], &strategy_);
+    if (run.page_ == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "all page pined!");
+    }
+    merge_heap_.push_back(i);
+  }
+  auto run_after = [this](size_t lhs, size_t rhs) { return RunAfter(lhs, rhs); };
+  std::make_heap(merge_heap_.begin(), merge_heap_.end(), run_after);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::MergePass() {
+  // Merging neighbouring runs keeps the runs in the order their entries were added, which keeps equal keys stable.
+  size_t num_inputs = runs_.size();
+  for (size_t first = 0; first < num_inputs; first += merge_fan_in_) {
+    size_t last = std::min(first + merge_fan_in_, num_inputs);
+    if (last - first == 1) {
+      Run run = std::move(runs_[first]);
+      runs_.push_back(std::move(run));
+      continue;
+    }
+    StartMerge(first, last);
+    // the merged run pins the page it is writing, so that the destructor cleans it up like the pages of any run
+    Run &merged = runs_.emplace_back();
+    MappingType item;
+    while (NextMerged(&item)) {
+      size_t offset = merged.size_ % ENTRIES_PER_PAGE;
+      if (offset == 0) {
+        if (merged.page_ != nullptr) {
+          buffer_pool_manager_->UnpinPage(merged.page_->GetPageId(), true);
+        }
+        page_id_t page_id;
+        merged.page_ = buffer_pool_manager_->NewPageWithStrategy(&page_id, &strategy_);
+        if (merged.page_ == nullptr) {
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "all page pined!");
+        }
+        merged.page_ids_.push_back(page_id);
+      }
+      reinterpret_cast<MappingType *>(merged.page_->GetData())[offset] = item;
+      merged.size_++;
+    }
+    buffer_pool_manager_->UnpinPage(merged.page_->GetPageId(), true);
+    merged.page_ = nullptr;
+  }
+  // the merged runs deleted their pages while they were read
+  runs_.erase(runs_.begin(), runs_.begin() + num_inputs);
+  num_merge_passes_++;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTERNAL_SORT_TYPE::Next(MappingType *item) {
+  BUSTUB_ASSERT(finished_, "Cannot read from a sort before it is finished.");
+  if (runs_.empty()) {
+    if (buffer_position_ == buffer_.size()) {
+      return false;
+    }
+    *item = buffer_[buffer_position_++];
+    return true;
+  }
+  return NextMerged(item);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTERNAL_SORT_TYPE::NextMerged(MappingType *item) {
+  if (merge_heap_.empty()) {
+    return false;
+  }
+  auto run_after = [this](size_t lhs, size_t rhs) { return RunAfter(lhs, rhs); };
+  std::pop_heap(merge_heap_.begin(), merge_heap_.end(), run_after);
+  Run &run = runs_[merge_heap_.back()];
+  *item = Head(run);
+  Advance(&run);
+  if (run.position_ < run.size_) {
+    std::push_heap(merge_heap_.begin(), merge_heap_.end(), run_after);
+  } else {
+    merge_heap_.pop_back();
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::Advance(Run *run) {
+  run->position_++;
+  if (run->position_ % ENTRIES_PER_PAGE != 0 && run->position_ < run->size_) {
+    return;
+  }
+  page_id_t page_id = run->page_->GetPageId();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  buffer_pool_manager_->DeletePage(page_id);
+  run->page_ = nullptr;
+  if (run->position_ < run->size_) {
+    run->page_ = buffer_pool_manager_->FetchPageWithStrategy(run->page_ids_[run->position_ / ENTRIES_PER_PAGE],
+                                                             &strategy_);
+    if (run->page_ == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "all page pined!");
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTERNAL_SORT_TYPE::RunAfter(size_t lhs, size_t rhs) const {
+  int cmp = comparator_(Head(runs_[lhs]).first, Head(runs_[rhs]).first);
+  return cmp > 0 || (cmp == 0 && lhs > rhs);
+}
+
+template class ExternalSort<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExternalSort<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExternalSort<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExternalSort<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExternalSort<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
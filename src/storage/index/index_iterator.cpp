@@ -21,6 +21,7 @@ INDEXITERATOR_TYPE::IndexIterator(Page *page, int index, BufferPoolManager *buff
     cur_page_id_ = INVALID_PAGE_ID;
   } else {
     cur_page_id_ = page->GetPageId();
+    SkipFinishedLeaves();
   }
 }
 
@@ -36,14 +37,24 @@ INDEX_TEMPLATE_ARGUMENTS
 bool INDEXITERATOR_TYPE::IsEnd() { return cur_page_id_ == INVALID_PAGE_ID; }
 
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &INDEXITERATOR_TYPE::operator*() { return cur_node_->GetItem(now_index_); }
+const MappingType &INDEXITERATOR_TYPE::operator*() {
+  item_ = cur_node_->GetItem(now_index_);
+  return item_;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
   if (IsEnd()) {
     return *this;
   }
-  if (now_index_ == cur_node_->GetSize() - 1) {
+  now_index_++;
+  SkipFinishedLeaves();
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SkipFinishedLeaves() {
+  while (!IsEnd() && now_index_ >= cur_node_->GetSize()) {
     // std::cout<<"to the end and change page\n";
     int next_page_id = cur_node_->GetNextPageId();
     if (next_page_id == INVALID_PAGE_ID) {
@@ -65,10 +76,7 @@ INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
       cur_page_id_ = page_->GetPageId();
     }
     now_index_ = 0;
-  } else {
-    now_index_++;
   }
-  return *this;
 }
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
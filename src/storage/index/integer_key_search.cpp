@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// integer_key_search.cpp
+//
+// Identification: src/storage/index/integer_key_search.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/integer_key_search.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace bustub {
+
+int IntegerKeySearch::Search(const char *data, size_t stride, int count, size_t width, int64_t key, bool upper) {
+  // the first key to find is in [base, base + count]
+  const char *base = data;
+  while (count > LINEAR_SEARCH_SIZE) {
+    int half = count / 2;
+    int64_t probe = Normalize(base + half * stride, width);
+    // a conditional move rather than a branch, which would be mispredicted half of the time
+    base = (upper ? probe <= key : probe < key) ? base + half * stride : base;
+    count -= half;
+  }
+  return (base - data) / stride + CountBelow(base, stride, count, width, key, upper);
+}
+
+int IntegerKeySearch::CountBelow(const char *data, size_t stride, int count, size_t width, int64_t key, bool upper) {
+  int below = 0;
+  int i = 0;
+#ifdef __AVX2__
+  // four keys at a time: gather them, normalize them and count those that compare below with a mask
+  const __m128i shift = _mm_cvtsi64_si128(64 - 8 * width);
+  const __m256i keys = _mm256_set1_epi64x(key);
+  const auto step = static_cast<int64_t>(stride);
+  const __m256i offsets = _mm256_set_epi64x(3 * step, 2 * step, step, 0);
+  for (; i + 4 <= count; i += 4) {
+    __m256i probes = _mm256_i64gather_epi64(reinterpret_cast<const long long *>(data + i * stride),  // NOLINT
+                                            offsets, 1);
+    probes = _mm256_sll_epi64(probes, shift);
+    // probe < key, or for upper probe <= key, which is !(probe > key)
+    __m256i mask = upper ? _mm256_cmpgt_epi64(probes, keys) : _mm256_cmpgt_epi64(keys, probes);
+    int found = __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(mask)));
+    below += upper ? 4 - found : found;
+  }
+#endif
+  for (; i < count; i++) {
+    int64_t probe = Normalize(data + i * stride, width);
+    below += static_cast<int>(upper ? probe <= key : probe < key);
+  }
+  return below;
+}
+
+}  // namespace bustub
@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// normalized_key.cpp
+//
+// Identification: src/storage/index/normalized_key.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/normalized_key.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/exception.h"
+#include "type/value.h"
+
+namespace bustub {
+
+namespace {
+
+/** Appends bytes to the encoding, dropping those past the capacity. */
+class KeyWriter {
+ public:
+  KeyWriter(char *dest, size_t capacity) : dest_(dest), capacity_(capacity) {}
+
+  void PutByte(uint8_t byte) {
+    if (length_ < capacity_) {
+      dest_[length_] = static_cast<char>(byte);
+    }
+    length_++;
+  }
+
+  /** Append the lowest width bytes of value, most significant first. */
+  void PutBigEndian(uint64_t value, size_t width) {
+    for (size_t i = width; i > 0; i--) {
+      PutByte(static_cast<uint8_t>(value >> (8 * (i - 1))));
+    }
+  }
+
+  /** Append a signed integer of width bytes, with its sign bit flipped so that negative ones sort first. */
+  void PutSigned(int64_t value, size_t width) {
+    PutBigEndian(static_cast<uint64_t>(value) ^ (uint64_t{1} << (8 * width - 1)), width);
+  }
+
+  size_t GetLength() const { return length_; }
+
+ private:
+  char *dest_;
+  size_t capacity_;
+  size_t length_{0};
+};
+
+}  // namespace
+
+size_t NormalizedKey::Encode(const Tuple &key, const Schema *key_schema, char *dest, size_t capacity) {
+  KeyWriter writer(dest, capacity);
+  for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+    Value value = key.GetValue(key_schema, i);
+    switch (value.GetTypeId()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        writer.PutSigned(value.GetAs<int8_t>(), sizeof(int8_t));
+        break;
+      case TypeId::SMALLINT:
+        writer.PutSigned(value.GetAs<int16_t>(), sizeof(int16_t));
+        break;
+      case TypeId::INTEGER:
+        writer.PutSigned(value.GetAs<int32_t>(), sizeof(int32_t));
+        break;
+      case TypeId::BIGINT:
+        writer.PutSigned(value.GetAs<int64_t>(), sizeof(int64_t));
+        break;
+      case TypeId::DECIMAL: {
+        // -0.0 is equal to 0.0, so it is encoded alike
+        double decimal = value.GetAs<double>() == 0 ? 0.0 : value.GetAs<double>();
+        uint64_t bits;
+        memcpy(&bits, &decimal, sizeof(double));
+        writer.PutBigEndian((bits >> 63) != 0 ? ~bits : bits | (uint64_t{1} << 63), sizeof(uint64_t));
+        break;
+      }
+      case TypeId::VARCHAR: {
+        if (value.IsNull()) {
+          writer.PutByte(0);
+          writer.PutByte(0);
+          break;
+        }
+        // the length of the value counts its terminating zero byte, which is not compared
+        const char *data = value.GetData();
+        uint32_t length = std::max<uint32_t>(value.GetLength(), 1) - 1;
+        for (uint32_t j = 0; j < length; j++) {
+          writer.PutByte(static_cast<uint8_t>(data[j]));
+          if (data[j] == 0) {
+            writer.PutByte(0xff);
+          }
+        }
+        writer.PutByte(0);
+        writer.PutByte(1);
+        break;
+      }
+      default:
+        throw Exception(ExceptionType::UNKNOWN_TYPE, "Unknown type.");
+    }
+  }
+  return writer.GetLength();
+}
+
+}  // namespace bustub
@@ -9,10 +9,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
 #include "common/exception.h"
+#include "storage/index/integer_key_search.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 
 #include "include/common/logger.h"
@@ -26,12 +28,15 @@ namespace bustub {
  * max page size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size,
+                                         KeyCompression key_compression) {
   SetPageType(IndexPageType::INTERNAL_PAGE);
   SetMaxSize(max_size);
   SetSize(0);
   SetParentPageId(parent_id);
   SetPageId(page_id);
+  SetKeyCompression(key_compression);
+  SetKeyLayout(0, 0);
 }
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
@@ -39,21 +44,91 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id
  */
 INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
+  if (IsPrefixPage()) {
+    return PrefixEntries::KeyAt(this, Data(), index);
+  }
   return array_[index].first;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) { array_[index].first = key; }
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  if (IsPrefixPage()) {
+    std::vector<MappingType> items = GetItems();
+    items[index].first = key;
+    PrefixEntries::Encode(this, Data(), items.data(), items.size());
+    return;
+  }
+  array_[index].first = key;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<MappingType> B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetItems() const {
+  std::vector<MappingType> items;
+  items.reserve(GetSize());
+  for (int i = 0; i < GetSize(); i++) {
+    items.emplace_back(KeyAt(i), ValueAt(i));
+  }
+  return items;
+}
+
+/*
+ * Helper method to decide whether the key can be inserted without splitting
+ * the page first. A NONE page always has room: it holds max size entries for
+ * the moment before it is split. A PREFIX page has room if its entries, laid
+ * out again for the key, still fit into the page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::HasRoomFor(const KeyType &key) const {
+  return !IsPrefixPage() || PrefixEntries::BytesWith(this, Data(), key) <= CAPACITY;
+}
+
+/*
+ * Helper method to decide whether count more keys fit, whatever keys they
+ * are. For a PREFIX page that is the case if all entries fit with whole keys.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::HasRoomForAny(int count) const {
+  return !IsPrefixPage() || PrefixEntries::Bytes(0, sizeof(KeyType), GetSize() + count) <= CAPACITY;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+size_t B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetUsedBytes() const {
+  if (IsPrefixPage()) {
+    return INTERNAL_PAGE_HEADER_SIZE + PrefixEntries::UsedBytes(this);
+  }
+  return INTERNAL_PAGE_HEADER_SIZE + std::max(GetSize(), 0) * sizeof(MappingType);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::PrefixItemsFit(const MappingType *items, int size) {
+  return PrefixEntries::EncodedBytes(items, size) <= CAPACITY;
+}
+
+/*
+ * Compare the key at index with the given key, without copying it out of a
+ * NONE page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::CompareAt(int index, const KeyType &key, const KeyComparator &comparator) const {
+  if (IsPrefixPage()) {
+    return comparator(PrefixEntries::KeyAt(this, Data(), index), key);
+  }
+  return comparator(array_[index].first, key);
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::LowerBound(int l, int r, const KeyType &key,
                                                const KeyComparator &comparator) const {
+  if (comparator.GetIntegerKeyWidth() != 0 && !IsPrefixPage()) {
+    return l + IntegerKeySearch::Search(reinterpret_cast<const char *>(&array_[l].first), sizeof(MappingType), r - l,
+                                        comparator.GetIntegerKeyWidth(),
+                                        IntegerKeySearch::Normalize(key.data_, comparator.GetIntegerKeyWidth()), false);
+  }
   int left = l;
   int right = r - 1;
   while (left <= right) {
     int mid = (left + right) / 2;
-    if (comparator.operator()(array_[mid].first, key) < 0) {
+    if (CompareAt(mid, key, comparator) < 0) {
       left = mid + 1;
     } else {
       right = mid - 1;
@@ -65,11 +140,16 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::LowerBound(int l, int r, const KeyType &key,
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::UpperBound(int l, int r, const KeyType &key,
                                                const KeyComparator &comparator) const {
+  if (comparator.GetIntegerKeyWidth() != 0 && !IsPrefixPage()) {
+    return l + IntegerKeySearch::Search(reinterpret_cast<const char *>(&array_[l].first), sizeof(MappingType), r - l,
+                                        comparator.GetIntegerKeyWidth(),
+                                        IntegerKeySearch::Normalize(key.data_, comparator.GetIntegerKeyWidth()), true);
+  }
   int left = l;
   int right = r - 1;
   while (left <= right) {
     int mid = (left + right) / 2;
-    if (comparator.operator()(array_[mid].first, key) <= 0) {
+    if (CompareAt(mid, key, comparator) <= 0) {
       left = mid + 1;
     } else {
       right = mid - 1;
@@ -85,7 +165,7 @@ INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
   int size = GetSize();
   for (int i = 0; i < size; i++) {
-    if (value == array_[i].second) {
+    if (value == ValueAt(i)) {
       return i;
     }
   }
@@ -97,7 +177,21 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return array_[index].second; }
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
+  if (IsPrefixPage()) {
+    return PrefixEntries::ValueAt(this, Data(), index);
+  }
+  return array_[index].second;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  if (IsPrefixPage()) {
+    PrefixEntries::SetAt(this, Data(), index, KeyAt(index), value);
+    return;
+  }
+  array_[index].second = value;
+}
 
 /*****************************************************************************
  * LOOKUP
@@ -111,7 +205,7 @@ INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
   int size = GetSize();
   int index = UpperBound(1, size, key, comparator) - 1;
-  return array_[index].second;
+  return ValueAt(index);
 }
 
 /*****************************************************************************
@@ -126,6 +220,12 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCo
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
                                                      const ValueType &new_value) {
+  if (IsPrefixPage()) {
+    // the first key is not used, the new key in its place keeps the prefix of the page
+    MappingType items[2] = {std::make_pair(new_key, old_value), std::make_pair(new_key, new_value)};
+    PrefixEntries::Encode(this, Data(), items, 2);
+    return;
+  }
   array_[0].second = old_value;
   array_[1].first = new_key;
   array_[1].second = new_value;
@@ -142,6 +242,18 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value,
                                                     const ValueType &new_value) {
   int index = ValueIndex(old_value) + 1;
   int size = GetSize();
+  if (IsPrefixPage()) {
+    if (PrefixEntries::Fits(this, Data(), new_key)) {
+      PrefixEntries::MoveEntries(this, Data(), index, index + 1, size - index);
+      PrefixEntries::SetAt(this, Data(), index, new_key, new_value);
+      IncreaseSize(1);
+    } else {
+      std::vector<MappingType> items = GetItems();
+      items.insert(items.begin() + index, std::make_pair(new_key, new_value));
+      PrefixEntries::Encode(this, Data(), items.data(), items.size());
+    }
+    return size;
+  }
   for (int i = size; i > index; i--) {
     array_[i] = array_[i - 1];
   }
@@ -161,6 +273,13 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient
                                                 BufferPoolManager *buffer_pool_manager) {
   int old_size = GetSize();
   int new_size = (old_size + 1) / 2;
+  if (IsPrefixPage()) {
+    // both halves are laid out again, as they may share a longer prefix than the whole page did
+    std::vector<MappingType> items = GetItems();
+    recipient->CopyNFrom(&items[new_size], old_size - new_size, buffer_pool_manager);
+    PrefixEntries::Encode(this, Data(), items.data(), new_size);
+    return;
+  }
   recipient->CopyNFrom(&array_[new_size], old_size - new_size, buffer_pool_manager);
   SetSize(new_size);
 }
@@ -170,13 +289,21 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient
  * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(const MappingType *items, int size,
+                                               BufferPoolManager *buffer_pool_manager) {
   int pre_size = GetSize();
-  memcpy(reinterpret_cast<void *>(&array_[pre_size]), reinterpret_cast<void *>(items), size * (sizeof(MappingType)));
-  IncreaseSize(size);
+  if (IsPrefixPage()) {
+    std::vector<MappingType> all_items = GetItems();
+    all_items.insert(all_items.end(), items, items + size);
+    PrefixEntries::Encode(this, Data(), all_items.data(), all_items.size());
+  } else {
+    memcpy(reinterpret_cast<void *>(&array_[pre_size]), reinterpret_cast<const void *>(items),
+           size * (sizeof(MappingType)));
+    IncreaseSize(size);
+  }
   int new_size = GetSize();
   for (int i = pre_size; i < new_size; i++) {
-    Page *page = buffer_pool_manager->FetchPage(array_[i].second);
+    Page *page = buffer_pool_manager->FetchPage(ValueAt(i));
     if (page == nullptr) {
       throw Exception(ExceptionType::OUT_OF_MEMORY, "all page pined!");
     }
@@ -186,6 +313,20 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, Buf
   }
 }
 
+/*
+ * Replace my entries with {size} entries starting from {items}. Unlike
+ * CopyNFrom, this does not adopt the pages: they must be my children already.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetItems(const MappingType *items, int size) {
+  if (IsPrefixPage()) {
+    PrefixEntries::Encode(this, Data(), items, size);
+    return;
+  }
+  memmove(reinterpret_cast<void *>(array_), reinterpret_cast<const void *>(items), size * sizeof(MappingType));
+  SetSize(size);
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -198,6 +339,10 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
   IncreaseSize(-1);
   int size = GetSize();
+  if (IsPrefixPage()) {
+    PrefixEntries::MoveEntries(this, Data(), index + 1, index, size - index);
+    return;
+  }
   for (int i = index; i < size; i++) {
     array_[i] = array_[i + 1];
   }
@@ -210,7 +355,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
   IncreaseSize(-1);
-  return array_[0].second;
+  return ValueAt(0);
 }
 /*****************************************************************************
  * MERGE
@@ -9,10 +9,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <sstream>
 
 #include "common/exception.h"
 #include "common/rid.h"
+#include "storage/index/integer_key_search.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 #include "include/common/logger.h"
@@ -28,13 +30,16 @@ namespace bustub {
  * next page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size,
+                                     KeyCompression key_compression) {
   SetPageType(IndexPageType::LEAF_PAGE);
   SetMaxSize(max_size);
   SetSize(0);
   SetParentPageId(parent_id);
   SetPageId(page_id);
   SetNextPageId(INVALID_PAGE_ID);
+  SetKeyCompression(key_compression);
+  SetKeyLayout(0, 0);
 }
 /**
  * Helper methods to set/get next page id
@@ -53,7 +58,7 @@ INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
   int size = GetSize();
   int index = LowerBound(0, size, key, comparator);
-  if (index >= size || comparator.operator()(key, array_[index].first) != 0) {
+  if (index >= size || CompareAt(index, key, comparator) != 0) {
     return -1;
   }
   return index;
@@ -65,27 +70,99 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator
  */
 INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
+  if (IsPrefixPage()) {
+    return PrefixEntries::KeyAt(this, Data(), index);
+  }
   return array_[index].first;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const {
+  if (IsPrefixPage()) {
+    return PrefixEntries::ValueAt(this, Data(), index);
+  }
+  return array_[index].second;
+}
+
+/*
+ * Compare the key at index with the given key, without copying it out of a
+ * NONE page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::CompareAt(int index, const KeyType &key, const KeyComparator &comparator) const {
+  if (IsPrefixPage()) {
+    return comparator(PrefixEntries::KeyAt(this, Data(), index), key);
+  }
+  return comparator(array_[index].first, key);
+}
+
 /*
  * Helper method to find and return the key & value pair associated with input
  * "index"(a.k.a array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
-  // replace with your own code
+MappingType B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const {
+  if (IsPrefixPage()) {
+    return std::make_pair(KeyAt(index), ValueAt(index));
+  }
   return array_[index];
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<MappingType> B_PLUS_TREE_LEAF_PAGE_TYPE::GetItems() const {
+  std::vector<MappingType> items;
+  items.reserve(GetSize());
+  for (int i = 0; i < GetSize(); i++) {
+    items.push_back(GetItem(i));
+  }
+  return items;
+}
+
+/*
+ * Helper method to decide whether the key can be inserted without splitting
+ * the page first. A NONE page always has room: it holds max size entries for
+ * the moment before it is split. A PREFIX page has room if its entries, laid
+ * out again for the key, still fit into the page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::HasRoomFor(const KeyType &key) const {
+  return !IsPrefixPage() || PrefixEntries::BytesWith(this, Data(), key) <= CAPACITY;
+}
+
+/*
+ * Helper method to decide whether count more keys fit, whatever keys they
+ * are. For a PREFIX page that is the case if all entries fit with whole keys.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::HasRoomForAny(int count) const {
+  return !IsPrefixPage() || PrefixEntries::Bytes(0, sizeof(KeyType), GetSize() + count) <= CAPACITY;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+size_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetUsedBytes() const {
+  if (IsPrefixPage()) {
+    return LEAF_PAGE_HEADER_SIZE + PrefixEntries::UsedBytes(this);
+  }
+  return LEAF_PAGE_HEADER_SIZE + std::max(GetSize(), 0) * sizeof(MappingType);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::PrefixItemsFit(const MappingType *items, int size) {
+  return PrefixEntries::EncodedBytes(items, size) <= CAPACITY;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::LowerBound(int l, int r, const KeyType &key, const KeyComparator &comparator) const {
+  if (comparator.GetIntegerKeyWidth() != 0 && !IsPrefixPage()) {
+    return l + IntegerKeySearch::Search(reinterpret_cast<const char *>(&array_[l].first), sizeof(MappingType), r - l,
+                                        comparator.GetIntegerKeyWidth(),
+                                        IntegerKeySearch::Normalize(key.data_, comparator.GetIntegerKeyWidth()), false);
+  }
   int left = l;
   int right = r - 1;
   while (left <= right) {
     int mid = (left + right) / 2;
-    if (comparator.operator()(array_[mid].first, key) < 0) {
+    if (CompareAt(mid, key, comparator) < 0) {
       left = mid + 1;
     } else {
       right = mid - 1;
@@ -96,11 +173,16 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::LowerBound(int l, int r, const KeyType &key, con
 
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::UpperBound(int l, int r, const KeyType &key, const KeyComparator &comparator) const {
+  if (comparator.GetIntegerKeyWidth() != 0 && !IsPrefixPage()) {
+    return l + IntegerKeySearch::Search(reinterpret_cast<const char *>(&array_[l].first), sizeof(MappingType), r - l,
+                                        comparator.GetIntegerKeyWidth(),
+                                        IntegerKeySearch::Normalize(key.data_, comparator.GetIntegerKeyWidth()), true);
+  }
   int left = l;
   int right = r - 1;
   while (left <= right) {
     int mid = (left + right) / 2;
-    if (comparator.operator()(array_[mid].first, key) <= 0) {
+    if (CompareAt(mid, key, comparator) <= 0) {
       left = mid + 1;
     } else {
       right = mid - 1;
@@ -113,15 +195,29 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::UpperBound(int l, int r, const KeyType &key, con
  *****************************************************************************/
 /*
  * Insert key & value pair into leaf page ordered by key
+ * A PREFIX page must have room for the key, see HasRoomFor(). If the key does
+ * not fit the current layout, the page is laid out again.
  * @return  page size after insertion
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
   int size = GetSize();
   int index = LowerBound(0, size, key, comparator);
-  if (index < size && comparator.operator()(array_[index].first, key) == 0) {
+  if (index < size && CompareAt(index, key, comparator) == 0) {
     return size;
   }
+  if (IsPrefixPage()) {
+    if (PrefixEntries::Fits(this, Data(), key)) {
+      PrefixEntries::MoveEntries(this, Data(), index, index + 1, size - index);
+      PrefixEntries::SetAt(this, Data(), index, key, value);
+      IncreaseSize(1);
+    } else {
+      std::vector<MappingType> items = GetItems();
+      items.insert(items.begin() + index, std::make_pair(key, value));
+      PrefixEntries::Encode(this, Data(), items.data(), items.size());
+    }
+    return GetSize();
+  }
   for (int i = size; i > index; i--) {
     array_[i] = array_[i - 1];
   }
@@ -140,6 +236,15 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
   int old_size = GetSize();
   int new_size = old_size / 2;
+  if (IsPrefixPage()) {
+    // both halves are laid out again, as they may share a longer prefix than the whole page did
+    std::vector<MappingType> items = GetItems();
+    recipient->CopyNFrom(&items[new_size], old_size - new_size);
+    PrefixEntries::Encode(this, Data(), items.data(), new_size);
+    recipient->SetNextPageId(GetNextPageId());
+    SetNextPageId(recipient->GetPageId());
+    return;
+  }
   recipient->CopyNFrom(&array_[new_size], old_size - new_size);
   recipient->SetNextPageId(GetNextPageId());
   SetNextPageId(recipient->GetPageId());
@@ -150,9 +255,16 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
  * Copy starting from items, and copy {size} number of elements into me.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(const MappingType *items, int size) {
   int pre_size = GetSize();
-  memcpy(reinterpret_cast<void *>(&array_[pre_size]), reinterpret_cast<void *>(items), size * (sizeof(MappingType)));
+  if (IsPrefixPage()) {
+    std::vector<MappingType> all_items = GetItems();
+    all_items.insert(all_items.end(), items, items + size);
+    PrefixEntries::Encode(this, Data(), all_items.data(), all_items.size());
+    return;
+  }
+  memcpy(reinterpret_cast<void *>(&array_[pre_size]), reinterpret_cast<const void *>(items),
+         size * (sizeof(MappingType)));
   IncreaseSize(size);
 }
 
@@ -168,8 +280,8 @@ INDEX_TEMPLATE_ARGUMENTS
 bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const {
   int size = GetSize();
   int index = LowerBound(0, size, key, comparator);
-  if (index < size && comparator.operator()(array_[index].first, key) == 0) {
-    *value = array_[index].second;
+  if (index < size && CompareAt(index, key, comparator) == 0) {
+    *value = ValueAt(index);
     return true;
   }
   return false;
@@ -188,12 +300,18 @@ INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) {
   int size = GetSize();
   int index = LowerBound(0, size, key, comparator);
-  if (index < size && comparator.operator()(array_[index].first, key) == 0) {
+  if (index >= size || CompareAt(index, key, comparator) != 0) {
+    return size;
+  }
+  if (IsPrefixPage()) {
+    // the layout still fits the remaining keys, even if a smaller one might now
+    PrefixEntries::MoveEntries(this, Data(), index + 1, index, size - index - 1);
+  } else {
     for (int i = index; i < size - 1; i++) {
       array_[i] = array_[i + 1];
     }
-    IncreaseSize(-1);
   }
+  IncreaseSize(-1);
   return GetSize();
 }
 
@@ -207,7 +325,12 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
   int size = GetSize();
-  recipient->CopyNFrom(&array_[0], size);
+  if (IsPrefixPage()) {
+    std::vector<MappingType> items = GetItems();
+    recipient->CopyNFrom(items.data(), size);
+  } else {
+    recipient->CopyNFrom(&array_[0], size);
+  }
   SetSize(0);
   recipient->SetNextPageId(GetNextPageId());
   SetNextPageId(INVALID_PAGE_ID);
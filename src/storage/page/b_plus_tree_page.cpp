@@ -58,4 +58,20 @@ void BPlusTreePage::SetPageId(page_id_t page_id) { page_id_ = page_id; }
  */
 void BPlusTreePage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
 
+/*
+ * Helper methods to get/set how keys are stored
+ */
+KeyCompression BPlusTreePage::GetKeyCompression() const { return key_compression_; }
+void BPlusTreePage::SetKeyCompression(KeyCompression key_compression) { key_compression_ = key_compression; }
+
+/*
+ * Helper methods to get/set the layout of the entries of a PREFIX page
+ */
+int BPlusTreePage::GetKeyPrefixSize() const { return key_prefix_size_; }
+int BPlusTreePage::GetKeySuffixSize() const { return key_suffix_size_; }
+void BPlusTreePage::SetKeyLayout(int prefix_size, int suffix_size) {
+  key_prefix_size_ = prefix_size;
+  key_suffix_size_ = suffix_size;
+}
+
 }  // namespace bustub
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy_test.cpp
+//
+// Identification: test/buffer/buffer_access_strategy_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BufferAccessStrategyTest, ScanStaysInRingTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_hot_pages = 6;
+  const int num_scan_pages = 50;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  std::vector<page_id_t> scan_pages;
+  for (int i = 0; i < num_scan_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    snprintf(bpm->FetchPage(page_id_temp)->GetData(), PAGE_SIZE, "scan %d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    scan_pages.push_back(page_id_temp);
+  }
+  std::vector<page_id_t> hot_pages;
+  for (int i = 0; i < num_hot_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    hot_pages.push_back(page_id_temp);
+  }
+
+  // Scenario: a scan with a ring of two frames reads every page correctly, holding two pages at a time.
+  BufferAccessStrategy strategy(2);
+  Page *prev = nullptr;
+  for (int i = 0; i < num_scan_pages; ++i) {
+    Page *page = bpm->FetchPageWithStrategy(scan_pages[i], &strategy);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("scan " + std::to_string(i), std::string(page->GetData()));
+    if (prev != nullptr) {
+      EXPECT_EQ(true, bpm->UnpinPage(prev->GetPageId(), false));
+    }
+    prev = page;
+  }
+  EXPECT_EQ(true, bpm->UnpinPage(prev->GetPageId(), false));
+
+  // Scenario: the scan only ever evicted pages it loaded itself, so every hot page is still resident.
+  int reads = disk_manager->GetNumReads();
+  for (auto page_id : hot_pages) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(reads, disk_manager->GetNumReads());
+
+  // Scenario: without a strategy the same scan flushes the hot pages out.
+  for (auto page_id : scan_pages) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  reads = disk_manager->GetNumReads();
+  for (auto page_id : hot_pages) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(reads + num_hot_pages, disk_manager->GetNumReads());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -11,11 +11,15 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
+#include "recovery/log_manager.h"
 
 namespace bustub {
 
@@ -141,4 +145,258 @@ TEST(BufferPoolManagerInstanceTest, DISABLED_SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+// Misses and dirty write-backs run outside the pool latch; a page that is evicted and immediately fetched again
+// must never be read back before its write-back has reached the disk.
+TEST(BufferPoolManagerInstanceTest, ConcurrentMissTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const int num_threads = 4;
+  const int pages_per_thread = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_threads * pages_per_thread; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      // Every thread owns its pages and bumps a counter in them, so it knows the value it must read back.
+      std::vector<int> counters(pages_per_thread, 0);
+      for (int round = 0; round < 500; ++round) {
+        int slot = round % pages_per_thread;
+        page_id_t page_id = t * pages_per_thread + slot;
+        Page *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        int value;
+        std::memcpy(&value, page->GetData() + PAGE_SIZE / 2, sizeof(int));
+        EXPECT_EQ(counters[slot], value);
+        counters[slot]++;
+        std::memcpy(page->GetData() + PAGE_SIZE / 2, &counters[slot], sizeof(int));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, BackgroundWriterTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 20;
+  // The background writer keeps the next BGWRITER_LOW_WATERMARK percent of victims clean.
+  const int num_clean = buffer_pool_size * BGWRITER_LOW_WATERMARK / 100;
+  ASSERT_GE(num_clean, 2);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, log_manager);
+
+  // Fill the pool with dirty pages; pages[0] is the next victim.
+  page_id_t page_id_temp;
+  std::vector<Page *> pages;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    pages.push_back(bpm->NewPage(&page_id_temp));
+    ASSERT_NE(nullptr, pages.back());
+    pages.back()->SetLSN(static_cast<lsn_t>(i));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  auto wait_for_writes = [&](int writes) {
+    for (int i = 0; i < 200 && disk_manager->GetNumWrites() < writes; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+  };
+
+  // Scenario: with logging enabled, a page whose log records have not been flushed is never written.
+  enable_logging = true;
+  log_manager->SetPersistentLSN(num_clean - 1);
+  pages[0]->SetLSN(num_clean);
+  bpm->RunBackgroundWriter();
+  wait_for_writes(num_clean - 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  bpm->StopBackgroundWriter();
+  EXPECT_EQ(num_clean - 1, disk_manager->GetNumWrites());
+  EXPECT_EQ(true, pages[0]->IsDirty());
+  for (int i = 1; i < num_clean; ++i) {
+    EXPECT_EQ(false, pages[i]->IsDirty());
+  }
+  enable_logging = false;
+
+  // Scenario: once the victims are clean, evicting them costs no write on the foreground thread.
+  bpm->RunBackgroundWriter();
+  wait_for_writes(num_clean);
+  bpm->StopBackgroundWriter();
+  int writes = disk_manager->GetNumWrites();
+  for (int i = 0; i < num_clean; ++i) {
+    EXPECT_EQ(false, pages[i]->IsDirty());
+  }
+  for (int i = 0; i < num_clean; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(writes, disk_manager->GetNumWrites());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, WALEvictionTest) {
+  // Only forced flushes make the log durable during this test.
+  auto saved_log_timeout = log_timeout;
+  log_timeout = std::chrono::seconds(60);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(2, disk_manager, log_manager);
+  log_manager->RunFlushThread();
+  auto append_log_record = [&] {
+    LogRecord log_record(0, INVALID_LSN, LogRecordType::BEGIN);
+    return log_manager->AppendLogRecord(&log_record);
+  };
+  log_manager->Flush(append_log_record());
+
+  page_id_t ahead_id;
+  page_id_t behind_id;
+  page_id_t page_id;
+  Page *ahead = bpm->NewPage(&ahead_id);
+  ASSERT_NE(nullptr, ahead);
+  lsn_t ahead_lsn = append_log_record();
+  ahead->SetLSN(ahead_lsn);
+  ASSERT_NE(nullptr, bpm->NewPage(&behind_id));
+  ASSERT_TRUE(bpm->UnpinPage(ahead_id, true));
+  ASSERT_TRUE(bpm->UnpinPage(behind_id, true));
+
+  // Scenario: the next victim is ahead of the durable log, so the other dirty page is evicted instead, without
+  // syncing the log.
+  int log_syncs = disk_manager->GetNumLogSyncs();
+  int writes = disk_manager->GetNumWrites();
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(1, bpm->GetEvictionLogSkips());
+  EXPECT_EQ(0, bpm->GetEvictionLogWaits());
+  EXPECT_LT(log_manager->GetPersistentLSN(), ahead_lsn);
+  EXPECT_EQ(log_syncs, disk_manager->GetNumLogSyncs());
+  EXPECT_EQ(writes + 1, disk_manager->GetNumWrites());
+
+  // Scenario: when every victim is ahead of the durable log, the eviction waits for one sync of the log before the
+  // write-back. The persistent LSN only covers synced records.
+  Page *page = bpm->FetchPage(page_id);
+  lsn_t page_lsn = append_log_record();
+  page->SetLSN(page_lsn);
+  ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(1, bpm->GetEvictionLogSkips());
+  EXPECT_EQ(1, bpm->GetEvictionLogWaits());
+  EXPECT_GE(log_manager->GetPersistentLSN(), ahead_lsn);
+  EXPECT_EQ(log_syncs + 1, disk_manager->GetNumLogSyncs());
+  EXPECT_EQ(writes + 2, disk_manager->GetNumWrites());
+
+  // Scenario: flushing a page syncs the log up to the page LSN first.
+  page = bpm->FetchPage(page_id);
+  page_lsn = append_log_record();
+  page->SetLSN(page_lsn);
+  ASSERT_TRUE(bpm->FlushPage(page_id));
+  EXPECT_EQ(1, bpm->GetFlushLogWaits());
+  EXPECT_GE(log_manager->GetPersistentLSN(), page_lsn);
+  EXPECT_EQ(log_syncs + 2, disk_manager->GetNumLogSyncs());
+  EXPECT_EQ(writes + 3, disk_manager->GetNumWrites());
+  ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+
+  // Scenario: flushing a page whose log is already synced does not sync the log again.
+  ASSERT_TRUE(bpm->FlushPage(page_id));
+  EXPECT_EQ(1, bpm->GetFlushLogWaits());
+  EXPECT_EQ(log_syncs + 2, disk_manager->GetNumLogSyncs());
+  ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+
+  log_manager->StopFlushThread();
+  log_timeout = saved_log_timeout;
+  disk_manager->ShutDown();
+  remove("test.db");
+  DiskManager::RemoveLogFiles("test.db");
+
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DoubleWriteLogOrderTest) {
+  const int num_pages = 3;
+  auto saved_log_timeout = log_timeout;
+  log_timeout = std::chrono::seconds(60);
+  auto *disk_manager =
+      new DiskManager("test.db", DiskIOBackend::PREAD_PWRITE, LOG_SEGMENT_SIZE, PageProtection::DOUBLE_WRITE);
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(num_pages + 1, disk_manager, log_manager);
+  log_manager->RunFlushThread();
+  auto append_log_record = [&] {
+    LogRecord log_record(0, INVALID_LSN, LogRecordType::BEGIN);
+    return log_manager->AppendLogRecord(&log_record);
+  };
+  log_manager->Flush(append_log_record());
+
+  std::vector<page_id_t> page_ids(num_pages);
+  lsn_t max_lsn = INVALID_LSN;
+  for (auto &page_id : page_ids) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    max_lsn = append_log_record();
+    page->SetLSN(max_lsn);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_LT(log_manager->GetPersistentLSN(), max_lsn);
+
+  // Scenario: the pages go through the double-write file only after one sync of the log covers all of them.
+  int log_syncs = disk_manager->GetNumLogSyncs();
+  int syncs = disk_manager->GetNumSyncs();
+  bpm->FlushAllPages();
+  EXPECT_EQ(log_syncs + 1, disk_manager->GetNumLogSyncs());
+  EXPECT_EQ(syncs + 3, disk_manager->GetNumSyncs());
+  EXPECT_GE(log_manager->GetPersistentLSN(), max_lsn);
+  log_manager->StopFlushThread();
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+
+  // Scenario: after a crash, the log on disk covers the LSN of every page in the database file.
+  disk_manager =
+      new DiskManager("test.db", DiskIOBackend::PREAD_PWRITE, LOG_SEGMENT_SIZE, PageProtection::DOUBLE_WRITE);
+  log_manager = new LogManager(disk_manager);
+  Page page;
+  for (auto page_id : page_ids) {
+    disk_manager->ReadPage(page_id, page.GetData());
+    EXPECT_LT(page.GetLSN(), log_manager->GetNextLSN());
+  }
+  EXPECT_EQ(0, disk_manager->GetNumChecksumFailures());
+
+  log_timeout = saved_log_timeout;
+  delete log_manager;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove("test.db");
+  remove("test.crc");
+  remove("test.dwb");
+  DiskManager::RemoveLogFiles("test.db");
+}
+
 }  // namespace bustub
@@ -19,7 +19,7 @@
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
@@ -59,4 +59,43 @@ TEST(ClockReplacerTest, DISABLED_SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+// NOLINTNEXTLINE
+TEST(ClockReplacerTest, ConcurrencyTest) {
+  const int num_threads = 4;
+  const int frames_per_thread = 64;
+  ClockReplacer clock_replacer(num_threads * frames_per_thread);
+
+  // Every thread unpins and pins its own frames while all of them race for victims.
+  std::vector<std::thread> threads;
+  std::vector<int> victims(num_threads, 0);
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < frames_per_thread; ++i) {
+          clock_replacer.Unpin(t * frames_per_thread + i);
+        }
+        for (int i = 0; i < frames_per_thread; i += 2) {
+          clock_replacer.Pin(t * frames_per_thread + i);
+        }
+        int value;
+        while (clock_replacer.Victim(&value)) {
+          victims[t]++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Odd frames can only leave the replacer as victims, even frames may be victimized before they are pinned.
+  int total = 0;
+  for (int count : victims) {
+    total += count;
+  }
+  EXPECT_LE(num_threads * frames_per_thread / 2 * 100, total);
+  EXPECT_GE(num_threads * frames_per_thread * 100, total);
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
 }  // namespace bustub
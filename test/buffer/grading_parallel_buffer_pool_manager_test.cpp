@@ -195,7 +195,7 @@ TEST(ParallelBufferPoolManagerTest, NewPage) {
   }
 
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -251,7 +251,7 @@ TEST(ParallelBufferPoolManagerTest, UnpinPage) {
   strcpy(page->GetData(), "page1againupdated");  // NOLINT
 
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -357,7 +357,7 @@ TEST(ParallelBufferPoolManagerTest, FetchPage) {
   EXPECT_EQ(0, std::strcmp("7", (page7->GetData())));
 
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -436,7 +436,7 @@ TEST(ParallelBufferPoolManagerTest, DeletePage) {
   EXPECT_EQ(0, std::strcmp(page6->GetData(), "updatedpage6"));
 
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -483,7 +483,7 @@ TEST(ParallelBufferPoolManagerTest, IsDirty) {
   EXPECT_EQ(0, page0->IsDirty());
 
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -528,7 +528,7 @@ TEST(ParallelBufferPoolManagerTest, ConcurrencyTest) {
     }
 
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
     delete disk_manager;
   }
 }
@@ -564,7 +564,7 @@ TEST(ParallelBufferPoolManagerTest, IntegratedTest) {
     EXPECT_EQ(1, bpm->DeletePage(page_ids[j]));
   }
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -628,7 +628,7 @@ TEST(ParallelBufferPoolManagerTest, HardTest_1) {
   }
 
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -719,7 +719,7 @@ TEST(ParallelBufferPoolManagerTest, HardTest_2) {
     }
 
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
     delete disk_manager;
   }
 }
@@ -834,7 +834,7 @@ TEST(ParallelBufferPoolManagerTest, HardTest_3) {
     }
 
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
     delete disk_manager;
   }
 }
@@ -966,7 +966,7 @@ TEST(ParallelBufferPoolManagerTest, HardTest_4) {
     }
 
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
     delete disk_manager;
   }
 }
@@ -198,7 +198,7 @@ TEST(BufferPoolManagerInstanceTest, NewPage) {
   }
 
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -254,7 +254,7 @@ TEST(BufferPoolManagerInstanceTest, UnpinPage) {
   strcpy(page->GetData(), "page1againupdated");  // NOLINT
 
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -360,7 +360,7 @@ TEST(BufferPoolManagerInstanceTest, FetchPage) {
   EXPECT_EQ(0, std::strcmp("7", (page7->GetData())));
 
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -439,7 +439,7 @@ TEST(BufferPoolManagerInstanceTest, DeletePage) {
   EXPECT_EQ(0, std::strcmp(page6->GetData(), "updatedpage6"));
 
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -486,7 +486,7 @@ TEST(BufferPoolManagerInstanceTest, IsDirty) {
   EXPECT_EQ(0, page0->IsDirty());
 
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -531,7 +531,7 @@ TEST(BufferPoolManagerInstanceTest, ConcurrencyTest) {
     }
 
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
     delete disk_manager;
   }
 }
@@ -567,7 +567,7 @@ TEST(BufferPoolManagerInstanceTest, IntegratedTest) {
     EXPECT_EQ(1, bpm->DeletePage(page_ids[j]));
   }
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -631,7 +631,7 @@ TEST(BufferPoolManagerInstanceTest, HardTest_1) {
   }
 
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -722,7 +722,7 @@ TEST(BufferPoolManagerInstanceTest, HardTest_2) {
     }
 
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
     delete disk_manager;
   }
 }
@@ -837,7 +837,7 @@ TEST(BufferPoolManagerInstanceTest, HardTest_3) {
     }
 
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
     delete disk_manager;
   }
 }
@@ -969,7 +969,7 @@ TEST(BufferPoolManagerInstanceTest, HardTest_4) {
     }
 
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
     delete disk_manager;
   }
 }
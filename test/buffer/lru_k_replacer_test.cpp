@@ -0,0 +1,228 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2, 0);
+
+  // Scenario: frames 1 and 2 are referenced twice, frames 3 to 5 only once.
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Pin(3);
+  lru_k_replacer.Pin(4);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Pin(5);
+  for (int i = 1; i <= 5; ++i) {
+    lru_k_replacer.Unpin(i);
+  }
+  // Unpinning twice has no effect.
+  lru_k_replacer.Unpin(1);
+  EXPECT_EQ(5, lru_k_replacer.Size());
+
+  // Scenario: frames with a single reference go first, in the order of that reference.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+
+  // Scenario: then frames by their second most recent reference. Pinned frames cannot be victims.
+  lru_k_replacer.Pin(1);
+  EXPECT_EQ(1, lru_k_replacer.Size());
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+
+  // Scenario: frame 1 now has references at times 1, 5 and 8; its backward 2-distance starts at 5.
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Pin(6);
+  lru_k_replacer.Pin(6);
+  lru_k_replacer.Unpin(6);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+  LRUKReplacer lru_k_replacer(7, 2, 3);
+
+  // Frame 1 is referenced in a burst, which counts as a single reference. Frame 2 is referenced twice, far apart.
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Pin(3);
+  lru_k_replacer.Pin(4);
+  lru_k_replacer.Pin(5);
+  lru_k_replacer.Pin(2);
+  for (int i = 1; i <= 5; ++i) {
+    lru_k_replacer.Unpin(i);
+  }
+
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+}
+
+TEST(LRUKReplacerTest, PassedOverVictimTest) {
+  LRUKReplacer lru_k_replacer(7, 2, 0);
+
+  // Frames 1 and 2 are referenced twice, frame 1 first; frame 3 only once.
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Pin(3);
+  for (int i = 1; i <= 3; ++i) {
+    lru_k_replacer.Unpin(i);
+  }
+
+  // Scenario: victims that are passed over and unpinned again return to their old place with their history.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(3);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+
+  // Scenario: a victim that is pinned again holds a new page, whose history starts from scratch.
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, FlushIsNotAReferenceTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(3, disk_manager, nullptr, ReplacerType::LRU_K);
+  page_id_t page_ids[3];
+  Page *pages[3];
+  for (int i = 0; i < 3; ++i) {
+    pages[i] = bpm->NewPage(&page_ids[i]);
+    ASSERT_NE(nullptr, pages[i]);
+    ASSERT_TRUE(bpm->UnpinPage(page_ids[i], true));
+  }
+  // Move the clock past the correlated reference period of the first page.
+  for (int i = 0; i < 2 * LRUK_CORRELATED_REFERENCE_PERIOD; ++i) {
+    bpm->FetchPage(page_ids[1 + i % 2]);
+    bpm->UnpinPage(page_ids[1 + i % 2], false);
+  }
+
+  // Scenario: flushing the page referenced least recently does not make it hot, so it is still the next victim.
+  ASSERT_TRUE(bpm->FlushPage(page_ids[0]));
+  bpm->FlushAllPages();
+  page_id_t page_id;
+  EXPECT_EQ(pages[0], bpm->NewPage(&page_id));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+/**
+ * Mixed workload: sequential scans over a table much larger than the pool, interleaved with point lookups into a
+ * small set of index pages. Every scanned page is fetched several times in a row, like a TableIterator reading one
+ * tuple at a time. Returns the fraction of index lookups that did not have to read from disk.
+ */
+static double IndexHitRate(ReplacerType replacer_type) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const int num_index_pages = 32;
+  const int num_table_pages = 512;
+  const int tuples_per_page = 4;
+  const int num_scans = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, replacer_type);
+
+  page_id_t page_id_temp;
+  std::vector<page_id_t> index_pages;
+  std::vector<page_id_t> table_pages;
+  for (int i = 0; i < num_index_pages + num_table_pages; ++i) {
+    bpm->NewPage(&page_id_temp);
+    bpm->UnpinPage(page_id_temp, true);
+    (i < num_index_pages ? index_pages : table_pages).push_back(page_id_temp);
+  }
+
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<int> index_dist(0, num_index_pages - 1);
+  int lookups = 0;
+  int misses = 0;
+  for (int scan = 0; scan < num_scans; ++scan) {
+    for (int i = 0; i < num_table_pages; ++i) {
+      for (int tuple = 0; tuple < tuples_per_page; ++tuple) {
+        bpm->FetchPage(table_pages[i]);
+        bpm->UnpinPage(table_pages[i], false);
+      }
+      // Four point lookups for every eight scanned pages.
+      if (i % 2 == 0) {
+        page_id_t index_page = index_pages[index_dist(gen)];
+        int reads = disk_manager->GetNumReads();
+        bpm->FetchPage(index_page);
+        bpm->UnpinPage(index_page, false);
+        lookups++;
+        misses += disk_manager->GetNumReads() - reads;
+      }
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+  return 1.0 - static_cast<double>(misses) / lookups;
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  double lru_hit_rate = IndexHitRate(ReplacerType::LRU);
+  double lru_k_hit_rate = IndexHitRate(ReplacerType::LRU_K);
+
+  // Apart from warming up every index page, LRU-K keeps the index resident.
+  EXPECT_GT(lru_k_hit_rate, 0.9);
+  EXPECT_GT(lru_k_hit_rate, lru_hit_rate);
+}
+
+}  // namespace bustub
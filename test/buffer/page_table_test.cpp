@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(5);
+  EXPECT_EQ(8, page_table.GetNumBuckets());
+
+  // Scenario: page ids strided like a parallel buffer pool hands them out.
+  for (int i = 0; i < 100; i++) {
+    page_table.WLatch(i * 4);
+    page_table.Insert(i * 4, i);
+    page_table.WUnlatch(i * 4);
+  }
+
+  frame_id_t frame_id;
+  for (int i = 0; i < 100; i++) {
+    page_table.RLatch(i * 4);
+    EXPECT_TRUE(page_table.Find(i * 4, &frame_id));
+    EXPECT_EQ(i, frame_id);
+    EXPECT_FALSE(page_table.Find(i * 4 + 1, &frame_id));
+    page_table.RUnlatch(i * 4);
+  }
+
+  page_table.WLatch(8);
+  EXPECT_TRUE(page_table.Remove(8));
+  EXPECT_FALSE(page_table.Remove(8));
+  EXPECT_FALSE(page_table.Find(8, &frame_id));
+  page_table.WUnlatch(8);
+}
+
+// Resident pages are fetched and unpinned from many threads while other threads force evictions.
+TEST(PageTableTest, ConcurrentFetchUnpinTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const int num_hot_pages = 4;
+  const int num_cold_pages = 32;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  for (int i = 0; i < num_hot_pages + num_cold_pages; i++) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t] {
+      char expected[32];
+      for (int round = 0; round < 2000; round++) {
+        page_id_t target = t % 2 == 0 ? round % num_hot_pages : num_hot_pages + (round + t) % num_cold_pages;
+        Page *page = bpm->FetchPage(target);
+        if (page == nullptr) {
+          continue;
+        }
+        snprintf(expected, sizeof(expected), "page-%d", target);
+        page->RLatch();
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_EQ(target, page->GetPageId());
+        page->RUnlatch();
+        EXPECT_TRUE(bpm->UnpinPage(target, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: every pin has been released, so the whole pool can be handed out again.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
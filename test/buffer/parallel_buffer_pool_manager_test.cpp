@@ -151,4 +151,47 @@ TEST(ParallelBufferPoolManagerTest, DISABLED_SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SortedFlushTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_instances = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  const auto num_pages = static_cast<page_id_t>(buffer_pool_size * num_instances);
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+
+  // Scenario: the pages of all instances are merged in page id order and written as one run per writing thread,
+  // although consecutive page ids belong to different instances.
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_pages, disk_manager->GetNumWrites());
+  EXPECT_EQ(num_instances, disk_manager->GetNumWriteCalls());
+  char buf[PAGE_SIZE];
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    disk_manager->ReadPage(i, buf);
+    EXPECT_EQ("page " + std::to_string(i), std::string(buf)) << i;
+  }
+
+  // Scenario: the flushed pages are clean and unpinned again.
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_pages, disk_manager->GetNumWrites());
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  EXPECT_EQ(num_pages, disk_manager->GetNumWrites());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
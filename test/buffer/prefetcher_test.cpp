@@ -0,0 +1,171 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// prefetcher_test.cpp
+//
+// Identification: test/buffer/prefetcher_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/prefetcher.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PrefetcherTest, PageListTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_pages = 40;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    snprintf(bpm->FetchPage(page_id_temp)->GetData(), PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    page_ids.push_back(page_id_temp);
+  }
+  bpm->FlushAllPages();
+
+  {
+    Prefetcher prefetcher(bpm, 4);
+
+    // Scenario: a slow consumer finds almost every page already read by the prefetcher, and reads the right data.
+    auto stream = prefetcher.PrefetchPages(page_ids);
+    int misses = 0;
+    for (int i = 0; i < num_pages; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      int reads = disk_manager->GetNumReads();
+      Page *page = bpm->FetchPage(page_ids[i]);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+      stream->Consume(page_ids[i]);
+      EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+      if (disk_manager->GetNumReads() != reads) {
+        misses++;
+      }
+    }
+    EXPECT_LT(misses, num_pages / 4);
+    EXPECT_GE(stream->GetDistance(), 1);
+    EXPECT_LE(stream->GetDistance(), prefetcher.GetMaxDistance());
+
+    // Scenario: a consumer that jumps ahead drags the read-ahead along.
+    stream = prefetcher.PrefetchPages(page_ids);
+    for (int i = 0; i < num_pages; i += 7) {
+      Page *page = bpm->FetchPage(page_ids[i]);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+      stream->Consume(page_ids[i]);
+      EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+    }
+
+    // Scenario: releasing a stream releases its pages, so every frame can be reused.
+    stream.reset();
+    std::vector<Page *> pages;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      pages.push_back(bpm->NewPage(&page_id_temp));
+      ASSERT_NE(nullptr, pages.back());
+    }
+    for (auto *page : pages) {
+      EXPECT_EQ(true, bpm->UnpinPage(page->GetPageId(), false));
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(PrefetcherTest, PageChainTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 30;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Every page stores the id of its successor, like the pages of a table heap.
+  page_id_t first_page_id;
+  page_id_t page_id_temp;
+  Page *prev = bpm->NewPage(&first_page_id);
+  ASSERT_NE(nullptr, prev);
+  for (int i = 1; i <= num_pages; ++i) {
+    page_id_t next_page_id = INVALID_PAGE_ID;
+    if (i < num_pages) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      next_page_id = page_id_temp;
+    }
+    memcpy(prev->GetData(), &next_page_id, sizeof(page_id_t));
+    EXPECT_EQ(true, bpm->UnpinPage(prev->GetPageId(), true));
+    if (i < num_pages) {
+      prev = bpm->FetchPage(next_page_id);
+      EXPECT_EQ(true, bpm->UnpinPage(next_page_id, false));
+    }
+  }
+  bpm->FlushAllPages();
+
+  auto next_page_fn = [](Page *page) {
+    page_id_t next_page_id;
+    memcpy(&next_page_id, page->GetData(), sizeof(page_id_t));
+    return next_page_id;
+  };
+
+  {
+    Prefetcher prefetcher(bpm, 4);
+    BufferAccessStrategy strategy(BULK_RING_SIZE + prefetcher.GetMaxDistance());
+
+    // Scenario: walking the chain with a stream visits every page once, in order, through a ring.
+    auto stream = prefetcher.PrefetchChain(first_page_id, next_page_fn, &strategy);
+    int visited = 0;
+    page_id_t page_id = first_page_id;
+    while (page_id != INVALID_PAGE_ID) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      Page *page = bpm->FetchPageWithStrategy(page_id, &strategy);
+      ASSERT_NE(nullptr, page);
+      stream->Consume(page_id);
+      page_id_t next_page_id = next_page_fn(page);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      page_id = next_page_id;
+      visited++;
+    }
+    EXPECT_EQ(num_pages, visited);
+
+    // Scenario: after the stream is gone, no page of the chain stays pinned.
+    stream.reset();
+    std::vector<Page *> pages;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      pages.push_back(bpm->NewPage(&page_id_temp));
+      ASSERT_NE(nullptr, pages.back());
+    }
+    for (auto *page : pages) {
+      EXPECT_EQ(true, bpm->UnpinPage(page->GetPageId(), false));
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -58,7 +58,7 @@ TEST(CatalogTest, DISABLED_CreateTable1) {
   EXPECT_NE(Catalog::NULL_TABLE_INFO, catalog->GetTable(table_oid));
 
   remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveLogFiles("catalog_test.db");
 }
 
 TEST(CatalogTest, DISABLED_CreateTable2) {
@@ -86,7 +86,7 @@ TEST(CatalogTest, DISABLED_CreateTable2) {
   EXPECT_EQ(Catalog::NULL_TABLE_INFO, catalog->CreateTable(nullptr, table_name, schema));
 
   remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveLogFiles("catalog_test.db");
 }
 
 TEST(CatalogTest, DISABLED_CreateTable3) {
@@ -118,7 +118,7 @@ TEST(CatalogTest, DISABLED_CreateTable3) {
   EXPECT_EQ(table_info_0->name_, table_info_1->name_);
 
   remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveLogFiles("catalog_test.db");
 }
 
 TEST(CatalogTest, DISABLED_CreateTableTest) {
@@ -214,7 +214,7 @@ TEST(CatalogTest, DISABLED_CreateIndex1) {
   EXPECT_EQ(table_indexes2.size(), 1);
 
   remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveLogFiles("catalog_test.db");
 }
 
 // Attempts to create an index with duplicate name should fail
@@ -263,7 +263,7 @@ TEST(CatalogTest, DISABLED_CreateIndex2) {
   EXPECT_EQ(Catalog::NULL_INDEX_INFO, create_index_f());
 
   remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveLogFiles("catalog_test.db");
 }
 
 TEST(CatalogTest, DISABLED_CreateIndex3) {
@@ -337,7 +337,7 @@ TEST(CatalogTest, DISABLED_QueryIndex1) {
   EXPECT_NE(Catalog::NULL_INDEX_INFO, catalog->GetIndex(index_name, table_name));
 
   remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveLogFiles("catalog_test.db");
 }
 
 // Vanilla index queries by index OID
@@ -387,7 +387,7 @@ TEST(CatalogTest, DISABLED_QueryIndex2) {
   EXPECT_EQ(index_info1->index_oid_, index_info2->index_oid_);
 
   remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveLogFiles("catalog_test.db");
 }
 
 // Query for nonexistent index on table should fail
@@ -409,7 +409,7 @@ TEST(CatalogTest, DISABLED_FailedQuery1) {
   EXPECT_EQ(Catalog::NULL_INDEX_INFO, catalog->GetIndex("index1", table_name));
 
   remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveLogFiles("catalog_test.db");
 }
 
 // Query for index on nonexistent table should fail
@@ -422,7 +422,7 @@ TEST(CatalogTest, DISABLED_FailedQuery2) {
   EXPECT_EQ(Catalog::NULL_INDEX_INFO, catalog->GetIndex("index1", "invalid_table"));
 
   remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveLogFiles("catalog_test.db");
 }
 
 // Query for nonexistent index OID should throw
@@ -436,7 +436,7 @@ TEST(CatalogTest, DISABLED_FailedQuery3) {
   EXPECT_EQ(Catalog::NULL_INDEX_INFO, catalog->GetIndex(bad_oid));
 
   remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveLogFiles("catalog_test.db");
 }
 
 // Query for all indexes on nonexistent table should give empty collection
@@ -450,7 +450,7 @@ TEST(CatalogTest, DISABLED_FailedQuery4) {
   EXPECT_TRUE(indexes.empty());
 
   remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveLogFiles("catalog_test.db");
 }
 
 // Query for all indexes on existing table with no
@@ -474,7 +474,7 @@ TEST(CatalogTest, DISABLED_FailedQuery5) {
   EXPECT_TRUE(indexes.empty());
 
   remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveLogFiles("catalog_test.db");
 }
 
 // Should be able to create and interact with an index with a single BIGINT key
@@ -526,7 +526,7 @@ TEST(CatalogTest, DISABLED_IndexInteraction0) {
   ASSERT_TRUE(results.empty());
 
   remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveLogFiles("catalog_test.db");
 }
 
 // Should be able to create and interact with an index that is keyed by two INTEGER values
@@ -578,7 +578,7 @@ TEST(CatalogTest, DISABLED_IndexInteraction1) {
   ASSERT_TRUE(results.empty());
 
   remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveLogFiles("catalog_test.db");
 }
 
 // Should be able to create and interact with an index that is keyed by a single INTEGER column
@@ -630,7 +630,7 @@ TEST(CatalogTest, DISABLED_IndexInteraction2) {
   ASSERT_TRUE(results.empty());
 
   remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveLogFiles("catalog_test.db");
 }
 
 TEST(CatalogTest, DISABLED_IndexInteraction3) {
@@ -685,7 +685,141 @@ TEST(CatalogTest, DISABLED_IndexInteraction3) {
   ASSERT_TRUE(results.empty());
 
   remove("catalog_test.db");
-  remove("catalog_test.log");
+  DiskManager::RemoveLogFiles("catalog_test.db");
+}
+
+// A B+ tree index is bulk loaded from the keys of the table, which come out of the heap unsorted
+TEST(CatalogTest, CreateBPlusTreeIndex) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  // The B+ tree keeps its root in the header page, which has to be the first page
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  ASSERT_EQ(HEADER_PAGE_ID, header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+
+  const std::string table_name{"foobar"};
+  const std::string index_name{"index1"};
+
+  // Construct a new table and fill it with the keys in a shuffled order
+  std::vector<Column> columns{};
+  columns.emplace_back("A", TypeId::BIGINT);
+  columns.emplace_back("B", TypeId::BOOLEAN);
+  Schema schema{columns};
+  auto *table_info = catalog->CreateTable(txn.get(), table_name, schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  const int64_t num_keys = 1000;
+  for (int64_t i = 0; i < num_keys; i++) {
+    int64_t key = i * 7 % num_keys;
+    Tuple tuple{{ValueFactory::GetBigIntValue(key), ValueFactory::GetBooleanValue(key % 2 == 0)}, &schema};
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+
+  std::vector<Column> key_columns{};
+  std::vector<uint32_t> key_attrs{};
+  key_columns.emplace_back("A", TypeId::BIGINT);
+  key_attrs.emplace_back(0);
+  Schema key_schema{key_columns};
+
+  auto *index_info = catalog->CreateIndex<BigintKeyType, BigintValueType, BigintComparatorType>(
+      txn.get(), index_name, table_name, schema, key_schema, key_attrs, BIGINT_SIZE, BigintHashFunctionType{},
+      IndexType::B_PLUS_TREE);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+
+  // Every key finds the tuple it came from
+  for (int64_t key = 0; key < num_keys; key++) {
+    std::vector<RID> rids;
+    Tuple key_tuple{{ValueFactory::GetBigIntValue(key)}, &key_schema};
+    index_info->index_->ScanKey(key_tuple, &rids, txn.get());
+    ASSERT_EQ(1, rids.size());
+    Tuple tuple;
+    ASSERT_TRUE(table_info->table_->GetTuple(rids[0], &tuple, txn.get()));
+    EXPECT_EQ(key, tuple.GetValue(&schema, 0).GetAs<int64_t>());
+  }
+
+  remove("catalog_test.db");
+  DiskManager::RemoveLogFiles("catalog_test.db");
+}
+
+// Indexes of NORMALIZED keys find every key, and a B+ tree of them scans the keys in the order of their columns
+TEST(CatalogTest, CreateNormalizedKeyIndex) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  ASSERT_EQ(HEADER_PAGE_ID, header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+
+  // Construct a table whose keys repeat A with different B, negative A included
+  const std::string table_name{"foobar"};
+  std::vector<Column> columns{};
+  columns.emplace_back("A", TypeId::INTEGER);
+  columns.emplace_back("B", TypeId::VARCHAR, 8);
+  Schema schema{columns};
+  auto *table_info = catalog->CreateTable(txn.get(), table_name, schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  const int32_t num_keys = 600;
+  for (int32_t i = 0; i < num_keys; i++) {
+    int32_t key = i * 7 % num_keys;
+    Tuple tuple{{ValueFactory::GetIntegerValue(key / 2 - num_keys / 4),
+                 ValueFactory::GetVarcharValue(std::to_string(key % 2))},
+                &schema};
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+  }
+
+  std::vector<Column> key_columns{};
+  key_columns.emplace_back("A", TypeId::INTEGER);
+  key_columns.emplace_back("B", TypeId::VARCHAR, 8);
+  std::vector<uint32_t> key_attrs{0, 1};
+  Schema key_schema{key_columns};
+
+  auto *tree_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      txn.get(), "index1", table_name, schema, key_schema, key_attrs, 8, HashFunction<GenericKey<8>>{},
+      IndexType::B_PLUS_TREE, KeyCompression::NONE, KeyFormat::NORMALIZED);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, tree_info);
+  auto *hash_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      txn.get(), "index2", table_name, schema, key_schema, key_attrs, 8, HashFunction<GenericKey<8>>{},
+      IndexType::EXTENDIBLE_HASH, KeyCompression::NONE, KeyFormat::NORMALIZED);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, hash_info);
+
+  // Every key finds the tuple it came from in both indexes
+  for (int32_t key = 0; key < num_keys; key++) {
+    Tuple key_tuple{{ValueFactory::GetIntegerValue(key / 2 - num_keys / 4),
+                     ValueFactory::GetVarcharValue(std::to_string(key % 2))},
+                    &key_schema};
+    for (auto *index_info : {tree_info, hash_info}) {
+      std::vector<RID> rids;
+      index_info->index_->ScanKey(key_tuple, &rids, txn.get());
+      ASSERT_EQ(1, rids.size());
+      Tuple tuple;
+      ASSERT_TRUE(table_info->table_->GetTuple(rids[0], &tuple, txn.get()));
+      EXPECT_EQ(key / 2 - num_keys / 4, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+      EXPECT_EQ(std::to_string(key % 2), tuple.GetValue(&schema, 1).ToString());
+    }
+  }
+
+  // The tree scans the keys ordered by A, then by B
+  auto *tree = dynamic_cast<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> *>(tree_info->index_.get());
+  ASSERT_NE(nullptr, tree);
+  int32_t key = 0;
+  for (auto iterator = tree->GetBeginIterator(); iterator != tree->GetEndIterator(); ++iterator, key++) {
+    Tuple tuple;
+    ASSERT_TRUE(table_info->table_->GetTuple((*iterator).second, &tuple, txn.get()));
+    EXPECT_EQ(key / 2 - num_keys / 4, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(std::to_string(key % 2), tuple.GetValue(&schema, 1).ToString());
+  }
+  EXPECT_EQ(num_keys, key);
+
+  remove("catalog_test.db");
+  DiskManager::RemoveLogFiles("catalog_test.db");
 }
 
 }  // namespace bustub
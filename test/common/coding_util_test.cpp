@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// coding_util_test.cpp
+//
+// Identification: test/common/coding_util_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/util/coding_util.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** Compress data, check that it decompresses into the same bytes, and return the compressed size. */
+static size_t RoundTrip(const std::string &data) {
+  std::vector<char> compressed(data.size() + data.size() / 2 + 16);
+  size_t compressed_size = CodingUtil::Compress(data.data(), data.size(), compressed.data(), compressed.size());
+  EXPECT_GT(compressed_size, 0);
+  std::vector<char> decompressed(data.size() + 1);
+  EXPECT_TRUE(CodingUtil::Decompress(compressed.data(), compressed_size, decompressed.data(), data.size()));
+  EXPECT_EQ(data, std::string(decompressed.data(), data.size()));
+  return compressed_size;
+}
+
+// NOLINTNEXTLINE
+TEST(CodingUtilTest, CompressTest) {
+  // Scenario: empty and short inputs are stored as literals.
+  RoundTrip("");
+  RoundTrip("abc");
+
+  // Scenario: repeated tuples and runs of one byte compress well, with matches overlapping their own output.
+  std::string records;
+  for (int i = 0; i < 200; ++i) {
+    records += "INSERT rid=" + std::to_string(i) + " name=" + std::string(40, 'x') + " value=42;";
+  }
+  EXPECT_LT(RoundTrip(records) * 4, records.size());
+  EXPECT_LT(RoundTrip(std::string(10000, '\0')), 100);
+
+  // Scenario: random bytes do not compress, but still round trip.
+  std::mt19937 rng(42);
+  std::string random(5000, ' ');
+  for (auto &c : random) {
+    c = static_cast<char>(rng());
+  }
+  EXPECT_GE(RoundTrip(random), random.size());
+
+  // Scenario: the compressor gives up when the output does not fit.
+  std::vector<char> small(random.size() / 2);
+  EXPECT_EQ(0, CodingUtil::Compress(random.data(), random.size(), small.data(), small.size()));
+}
+
+// NOLINTNEXTLINE
+TEST(CodingUtilTest, DecompressInvalidTest) {
+  std::string data;
+  for (int i = 0; i < 100; ++i) {
+    data += "abcdefgh" + std::to_string(i % 7);
+  }
+  std::vector<char> compressed(data.size() + 16);
+  size_t size = CodingUtil::Compress(data.data(), data.size(), compressed.data(), compressed.size());
+  ASSERT_GT(size, 0);
+  std::vector<char> out(data.size());
+
+  // Scenario: a wrong expected size, a cut-off input and a corrupted input are rejected, never overrunning the output.
+  EXPECT_FALSE(CodingUtil::Decompress(compressed.data(), size, out.data(), data.size() - 1));
+  EXPECT_FALSE(CodingUtil::Decompress(compressed.data(), size - 1, out.data(), data.size()));
+  for (size_t i = 0; i < size; ++i) {
+    if (compressed[i] == static_cast<char>(0xff)) {
+      continue;
+    }
+    std::vector<char> corrupted(compressed.begin(), compressed.begin() + size);
+    corrupted[i] = static_cast<char>(0xff);
+    if (CodingUtil::Decompress(corrupted.data(), size, out.data(), data.size())) {
+      // Corrupting a literal still decompresses; the log block checksum catches it.
+      EXPECT_NE(data, std::string(out.data(), out.size()));
+    }
+  }
+}
+
+}  // namespace bustub
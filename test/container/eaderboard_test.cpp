@@ -184,7 +184,7 @@ void HashTableLeaderboardTestCall() {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 /*
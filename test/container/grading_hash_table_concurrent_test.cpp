@@ -148,7 +148,7 @@ void InsertTest1Call() {
     delete disk_manager;
     delete bpm;
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
   }
 }
 
@@ -189,7 +189,7 @@ void InsertTest2Call() {
     delete disk_manager;
     delete bpm;
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
   }
 }
 
@@ -230,7 +230,7 @@ void DeleteTest1Call() {
     delete disk_manager;
     delete bpm;
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
   }
 }
 
@@ -269,7 +269,7 @@ void DeleteTest2Call() {
     delete disk_manager;
     delete bpm;
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
   }
 }
 
@@ -333,7 +333,7 @@ void MixTest1Call() {
     delete disk_manager;
     delete bpm;
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
   }
 }
 
@@ -402,7 +402,7 @@ void MixTest2Call() {
     delete disk_manager;
     delete bpm;
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
   }
 }
 
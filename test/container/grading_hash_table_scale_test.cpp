@@ -173,7 +173,7 @@ void ConcurrentScaleTest() {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 void ScaleTestCall() {
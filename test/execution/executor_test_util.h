@@ -74,7 +74,7 @@ class ExecutorTest : public ::testing::Test {
     // Shut down the disk manager and clean up the transaction
     disk_manager_->ShutDown();
     remove("executor_test.db");
-    remove("executor_test.log");
+    DiskManager::RemoveLogFiles("executor_test.db");
     delete txn_;
   };
 
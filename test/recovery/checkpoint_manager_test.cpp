@@ -0,0 +1,339 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// checkpoint_manager_test.cpp
+//
+// Identification: test/recovery/checkpoint_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "common/bustub_instance.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "recovery/checkpoint_manager.h"
+#include "recovery/log_recovery.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+class CheckpointManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("test.db");
+    DiskManager::RemoveLogFiles("test.db");
+  }
+
+  void TearDown() override {
+    remove("test.db");
+    DiskManager::RemoveLogFiles("test.db");
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(CheckpointManagerTest, FuzzyCheckpointTest) {
+  const int num_tuples = 2000;
+  Schema schema{{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}}};
+  auto make_tuple = [&](int a) {
+    return Tuple({Value(TypeId::INTEGER, a), Value(TypeId::VARCHAR, std::string(60, 'b'))}, &schema);
+  };
+
+  auto *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+  TransactionManager *txn_manager = bustub_instance->transaction_manager_;
+
+  Transaction *txn = txn_manager->Begin();
+  auto *table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                              bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = table->GetFirstPageId();
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples; ++i) {
+    ASSERT_TRUE(table->InsertTuple(make_tuple(i), &rids[i], txn));
+  }
+  txn_manager->Commit(txn);
+  delete txn;
+
+  Transaction *loser = txn_manager->Begin();
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(-1), rids[0], loser));
+
+  // Scenario: transactions keep running to completion while a checkpoint is in progress.
+  bustub_instance->checkpoint_manager_->BeginCheckpoint();
+  txn = txn_manager->Begin();
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(7777), rids[2], txn));
+  txn_manager->Commit(txn);
+  delete txn;
+  bustub_instance->checkpoint_manager_->EndCheckpoint();
+
+  ASSERT_TRUE(table->MarkDelete(rids[1], loser));
+  txn = txn_manager->Begin();
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(8888), rids[3], txn));
+  txn_manager->Commit(txn);
+  delete txn;
+  txn_id_t loser_id = loser->GetTransactionId();
+
+  // Crash: the log is on disk, the dirty pages in the buffer pool are lost.
+  delete loser;
+  delete table;
+  delete bustub_instance;
+
+  bustub_instance = new BustubInstance("test.db");
+  auto *log_recovery = new LogRecovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_);
+
+  // Scenario: the checkpoint lists the loser as active and lets redo skip most of the log.
+  std::vector<char> log(1 << 20);
+  ASSERT_TRUE(bustub_instance->disk_manager_->ReadLog(log.data(), static_cast<int>(log.size()), 0));
+  lsn_t begin_lsn = INVALID_LSN;
+  LogRecord end_record;
+  LogRecord log_record;
+  for (size_t offset = 0; log_recovery->DeserializeLogRecord(log.data() + offset, static_cast<int>(log.size() - offset),
+                                                             &log_record);) {
+    if (log_record.GetLogRecordType() == LogRecordType::CHECKPOINT_BEGIN) {
+      begin_lsn = log_record.GetLSN();
+    } else if (log_record.GetLogRecordType() == LogRecordType::CHECKPOINT_END) {
+      end_record = log_record;
+    }
+    offset += log_record.GetSize();
+  }
+  ASSERT_NE(INVALID_LSN, begin_lsn);
+  ASSERT_EQ(LogRecordType::CHECKPOINT_END, end_record.GetLogRecordType());
+  const auto &active_txns = end_record.GetActiveTxns();
+  auto loser_entry = std::find_if(active_txns.begin(), active_txns.end(),
+                                  [&](const auto &entry) { return entry.first == loser_id; });
+  ASSERT_NE(active_txns.end(), loser_entry);
+  EXPECT_LT(loser_entry->second, begin_lsn);
+  ASSERT_FALSE(end_record.GetDirtyPages().empty());
+  lsn_t redo_lsn = begin_lsn;
+  for (const auto &[page_id, rec_lsn] : end_record.GetDirtyPages()) {
+    redo_lsn = std::min(redo_lsn, rec_lsn);
+  }
+  EXPECT_GT(redo_lsn, num_tuples / 2);
+
+  log_recovery->Redo();
+  log_recovery->Undo();
+  delete log_recovery;
+
+  txn = bustub_instance->transaction_manager_->Begin();
+  table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                        bustub_instance->log_manager_, first_page_id);
+  Tuple tuple;
+  for (int i = 0; i < num_tuples; ++i) {
+    ASSERT_TRUE(table->GetTuple(rids[i], &tuple, txn)) << i;
+    int expected = i == 2 ? 7777 : i == 3 ? 8888 : i;
+    EXPECT_EQ(expected, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  delete table;
+  delete bustub_instance;
+}
+
+// NOLINTNEXTLINE
+TEST_F(CheckpointManagerTest, LogTruncationTest) {
+  const int num_rounds = 10;
+  const int tuples_per_round = 200;
+  const int64_t log_segment_size = 4 * PAGE_SIZE;
+  Schema schema{{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}}};
+  auto make_tuple = [&](int a) {
+    return Tuple({Value(TypeId::INTEGER, a), Value(TypeId::VARCHAR, std::string(60, 'b'))}, &schema);
+  };
+
+  auto *disk_manager = new DiskManager("test.db", DiskIOBackend::PREAD_PWRITE, log_segment_size);
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(BUFFER_POOL_SIZE, disk_manager, log_manager);
+  auto *lock_manager = new LockManager();
+  auto *txn_manager = new TransactionManager(lock_manager, log_manager);
+  auto *checkpoint_manager = new CheckpointManager(txn_manager, log_manager, bpm);
+  log_manager->RunFlushThread();
+
+  Transaction *txn = txn_manager->Begin();
+  auto *table = new TableHeap(bpm, lock_manager, log_manager, txn);
+  txn_manager->Commit(txn);
+  delete txn;
+  page_id_t first_page_id = table->GetFirstPageId();
+
+  // Scenario: every checkpoint drops the segments that neither its redo point nor a running transaction needs.
+  std::vector<RID> rids;
+  Transaction *loser = nullptr;
+  int64_t loser_start_offset = 0;
+  for (int round = 0; round < num_rounds; ++round) {
+    txn = txn_manager->Begin();
+    for (int i = 0; i < tuples_per_round; ++i) {
+      rids.emplace_back();
+      ASSERT_TRUE(table->InsertTuple(make_tuple(static_cast<int>(rids.size()) - 1), &rids.back(), txn));
+    }
+    txn_manager->Commit(txn);
+    delete txn;
+    if (round == num_rounds / 2) {
+      loser = txn_manager->Begin();
+      ASSERT_TRUE(table->UpdateTuple(make_tuple(-1), rids[0], loser));
+    }
+    checkpoint_manager->BeginCheckpoint();
+    checkpoint_manager->EndCheckpoint();
+    if (round == num_rounds / 2 + 1) {
+      loser_start_offset = disk_manager->GetLogStartOffset();
+    }
+  }
+  EXPECT_GT(loser_start_offset, 0);
+  // The loser's records, from its BEGIN onwards, keep later checkpoints from truncating the log any further.
+  EXPECT_EQ(loser_start_offset, disk_manager->GetLogStartOffset());
+  char byte;
+  EXPECT_FALSE(disk_manager->ReadLog(&byte, 1, 0));
+  lsn_t next_lsn = log_manager->GetNextLSN();
+
+  // Crash: the log is on disk, the dirty pages in the buffer pool are lost.
+  delete loser;
+  delete table;
+  delete checkpoint_manager;
+  delete txn_manager;
+  delete lock_manager;
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+
+  disk_manager = new DiskManager("test.db", DiskIOBackend::PREAD_PWRITE, log_segment_size);
+  log_manager = new LogManager(disk_manager);
+  bpm = new BufferPoolManagerInstance(BUFFER_POOL_SIZE, disk_manager, log_manager);
+  lock_manager = new LockManager();
+  txn_manager = new TransactionManager(lock_manager, log_manager);
+  // Scenario: LSNs continue after the log on disk, so that segment start LSNs keep increasing.
+  EXPECT_EQ(next_lsn, log_manager->GetNextLSN());
+
+  // Scenario: recovery only reads the segments that are left.
+  auto *log_recovery = new LogRecovery(disk_manager, bpm);
+  log_recovery->Redo();
+  log_recovery->Undo();
+  delete log_recovery;
+
+  txn = txn_manager->Begin();
+  table = new TableHeap(bpm, lock_manager, log_manager, first_page_id);
+  Tuple tuple;
+  for (size_t i = 0; i < rids.size(); ++i) {
+    ASSERT_TRUE(table->GetTuple(rids[i], &tuple, txn)) << i;
+    EXPECT_EQ(static_cast<int>(i), tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  txn_manager->Commit(txn);
+  delete txn;
+  delete table;
+  delete txn_manager;
+  delete lock_manager;
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(CheckpointManagerTest, LargeCheckpointTest) {
+  // Every table has one dirty page, more than the entries of a record that fits into a log buffer of PAGE_SIZE bytes.
+  const int num_tables = 600;
+  Schema schema{{Column{"a", TypeId::INTEGER}}};
+  auto make_tuple = [&](int a) { return Tuple({Value(TypeId::INTEGER, a)}, &schema); };
+
+  auto *disk_manager = new DiskManager("test.db");
+  auto *log_manager = new LogManager(disk_manager, PAGE_SIZE);
+  auto *bpm = new BufferPoolManagerInstance(2 * num_tables, disk_manager, log_manager);
+  auto *lock_manager = new LockManager();
+  auto *txn_manager = new TransactionManager(lock_manager, log_manager);
+  auto *checkpoint_manager = new CheckpointManager(txn_manager, log_manager, bpm);
+  log_manager->RunFlushThread();
+
+  Transaction *txn = txn_manager->Begin();
+  std::vector<page_id_t> first_page_ids;
+  std::vector<RID> rids(num_tables);
+  for (int i = 0; i < num_tables; ++i) {
+    TableHeap table(bpm, lock_manager, log_manager, txn);
+    ASSERT_TRUE(table.InsertTuple(make_tuple(i), &rids[i], txn));
+    first_page_ids.push_back(table.GetFirstPageId());
+  }
+  txn_manager->Commit(txn);
+  delete txn;
+
+  Transaction *loser = txn_manager->Begin();
+  {
+    TableHeap table(bpm, lock_manager, log_manager, first_page_ids[0]);
+    ASSERT_TRUE(table.UpdateTuple(make_tuple(-1), rids[0], loser));
+  }
+  txn_id_t loser_id = loser->GetTransactionId();
+  checkpoint_manager->BeginCheckpoint();
+  checkpoint_manager->EndCheckpoint();
+
+  // Crash: the loser's update was written back by the checkpoint.
+  delete loser;
+  delete checkpoint_manager;
+  delete txn_manager;
+  delete lock_manager;
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+
+  disk_manager = new DiskManager("test.db");
+  log_manager = new LogManager(disk_manager, PAGE_SIZE);
+  bpm = new BufferPoolManagerInstance(2 * num_tables, disk_manager, log_manager);
+  lock_manager = new LockManager();
+  txn_manager = new TransactionManager(lock_manager, log_manager);
+  auto *log_recovery = new LogRecovery(disk_manager, bpm);
+
+  // Scenario: the tables are split across CHECKPOINT_PART records and a CHECKPOINT_END record that all fit the buffer.
+  std::vector<char> log(1 << 20);
+  ASSERT_TRUE(disk_manager->ReadLog(log.data(), static_cast<int>(log.size()), disk_manager->GetLogStartOffset()));
+  int num_parts = 0;
+  int num_ends = 0;
+  std::vector<std::pair<txn_id_t, lsn_t>> active_txns;
+  std::vector<page_id_t> dirty_page_ids;
+  LogRecord log_record;
+  for (size_t offset = 0; log_recovery->DeserializeLogRecord(log.data() + offset, static_cast<int>(log.size() - offset),
+                                                             &log_record);) {
+    LogRecordType type = log_record.GetLogRecordType();
+    if (type == LogRecordType::CHECKPOINT_PART || type == LogRecordType::CHECKPOINT_END) {
+      EXPECT_EQ(0, num_ends);
+      if (type == LogRecordType::CHECKPOINT_PART) {
+        ++num_parts;
+      } else {
+        ++num_ends;
+      }
+      EXPECT_LE(log_record.GetSize(), PAGE_SIZE);
+      const auto &txns = log_record.GetActiveTxns();
+      active_txns.insert(active_txns.end(), txns.begin(), txns.end());
+      for (const auto &[page_id, rec_lsn] : log_record.GetDirtyPages()) {
+        dirty_page_ids.push_back(page_id);
+      }
+    }
+    offset += log_record.GetSize();
+  }
+  EXPECT_GT(num_parts, 0);
+  EXPECT_EQ(1, num_ends);
+  EXPECT_EQ(1, std::count_if(active_txns.begin(), active_txns.end(),
+                             [&](const auto &entry) { return entry.first == loser_id; }));
+  std::sort(dirty_page_ids.begin(), dirty_page_ids.end());
+  for (page_id_t first_page_id : first_page_ids) {
+    EXPECT_TRUE(std::binary_search(dirty_page_ids.begin(), dirty_page_ids.end(), first_page_id)) << first_page_id;
+  }
+
+  // Scenario: recovery from the split checkpoint keeps the committed tuples and undoes the loser.
+  log_recovery->Redo();
+  log_recovery->Undo();
+  delete log_recovery;
+
+  txn = txn_manager->Begin();
+  Tuple tuple;
+  for (int i = 0; i < num_tables; ++i) {
+    TableHeap table(bpm, lock_manager, log_manager, first_page_ids[i]);
+    ASSERT_TRUE(table.GetTuple(rids[i], &tuple, txn)) << i;
+    EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  txn_manager->Commit(txn);
+  delete txn;
+  delete txn_manager;
+  delete lock_manager;
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -29,7 +29,7 @@ namespace bustub {
 // NOLINTNEXTLINE
 TEST(RecoveryTest, DISABLED_RedoTestWithOneTxn) {
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
@@ -128,13 +128,13 @@ TEST(RecoveryTest, DISABLED_RedoTestWithOneTxn) {
   delete bustub_instance;
   LOG_INFO("Tearing down the system..");
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 // NOLINTNEXTLINE
 TEST(RecoveryTest, DISABLED_UndoTestWithOneTxn) {
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   ASSERT_FALSE(enable_logging);
@@ -222,13 +222,13 @@ TEST(RecoveryTest, DISABLED_UndoTestWithOneTxn) {
   delete bustub_instance;
   LOG_INFO("Tearing down the system..");
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 // NOLINTNEXTLINE
 TEST(RecoveryTest, DISABLED_BasicRedoTestWithOneTxn) {
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   ASSERT_FALSE(enable_logging);
@@ -353,13 +353,13 @@ TEST(RecoveryTest, DISABLED_BasicRedoTestWithOneTxn) {
   delete bustub_instance;
   LOG_INFO("Tearing down the system..");
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 // NOLINTNEXTLINE
 TEST(RecoveryTest, DISABLED_BasicUndoTestWithOneTxn) {
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   ASSERT_FALSE(enable_logging);
@@ -485,13 +485,13 @@ TEST(RecoveryTest, DISABLED_BasicUndoTestWithOneTxn) {
   delete bustub_instance;
   LOG_INFO("Tearing down the system..");
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 // NOLINTNEXTLINE
 TEST(RecoveryTest, DISABLED_RedoTestWithMultipleTxn) {
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   ASSERT_FALSE(enable_logging);
@@ -609,13 +609,13 @@ TEST(RecoveryTest, DISABLED_RedoTestWithMultipleTxn) {
   delete test_table;
   LOG_INFO("Tearing down the system..");
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 // NOLINTNEXTLINE
 TEST(RecoveryTest, DISABLED_UndoTestWithMultipleTxn) {
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   ASSERT_FALSE(enable_logging);
@@ -728,13 +728,13 @@ TEST(RecoveryTest, DISABLED_UndoTestWithMultipleTxn) {
   delete test_table;
   LOG_INFO("Tearing down the system..");
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 // NOLINTNEXTLINE
 TEST(RecoveryTest, DISABLED_MixedTestWithMultipleTxn) {
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   ASSERT_FALSE(enable_logging);
@@ -855,13 +855,13 @@ TEST(RecoveryTest, DISABLED_MixedTestWithMultipleTxn) {
   delete test_table;
   LOG_INFO("Tore down the system");
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 // NOLINTNEXTLINE
 TEST(RecoveryTest, DISABLED_GroupCommitTest) {
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   ASSERT_FALSE(enable_logging);
@@ -997,13 +997,13 @@ TEST(RecoveryTest, DISABLED_GroupCommitTest) {
   delete log_recovery;
   LOG_INFO("Tore down the system");
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 // NOLINTNEXTLINE
 TEST(RecoveryTest, DISABLED_BufferPoolSyncFlushTestWithOneTxn) {
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   ASSERT_FALSE(enable_logging);
@@ -1093,13 +1093,13 @@ TEST(RecoveryTest, DISABLED_BufferPoolSyncFlushTestWithOneTxn) {
   delete bustub_instance;
   LOG_INFO("Tearing down the system..");
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 // NOLINTNEXTLINE
 TEST(RecoveryTest, DISABLED_BufferPoolSyncFlushTestWithMultipleTxn) {
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   ASSERT_FALSE(enable_logging);
@@ -1220,7 +1220,7 @@ TEST(RecoveryTest, DISABLED_BufferPoolSyncFlushTestWithMultipleTxn) {
   delete bustub_instance;
   LOG_INFO("Tearing down the system..");
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 // NOLINTNEXTLINE
@@ -1231,7 +1231,7 @@ TEST(RecoveryTest, DISABLED_CheckpointDurabilityTest) {
 #undef BUFFER_POOL_SIZE
 #define BUFFER_POOL_SIZE 100
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   EXPECT_FALSE(enable_logging);
@@ -1349,13 +1349,13 @@ TEST(RecoveryTest, DISABLED_CheckpointDurabilityTest) {
 
   LOG_INFO("Tearing down the system..");
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 // NOLINTNEXTLINE
 TEST(RecoveryTest, DISABLED_CheckpointConcurrencyTest) {
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   EXPECT_FALSE(enable_logging);
@@ -1449,7 +1449,7 @@ TEST(RecoveryTest, DISABLED_CheckpointConcurrencyTest) {
 
   LOG_INFO("Tearing down the system..");
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 // NOLINTNEXTLINE
@@ -1464,7 +1464,7 @@ TEST(RecoveryTest, DISABLED_TestAsyncLogging) {
 #define BUFFER_POOL_SIZE 100
   log_timeout = std::chrono::seconds(1);
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   ASSERT_FALSE(enable_logging);
@@ -1559,7 +1559,7 @@ TEST(RecoveryTest, DISABLED_TestAsyncLogging) {
   delete bustub_instance;
   LOG_INFO("Tearing down the system..");
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 }  // namespace bustub
@@ -0,0 +1,143 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_manager_bench_test.cpp
+//
+// Identification: test/recovery/log_manager_bench_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cinttypes>
+#include <cstdio>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "recovery/log_manager.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+class LogManagerBenchTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    saved_log_timeout_ = log_timeout;
+    RemoveFiles();
+  }
+
+  void TearDown() override {
+    log_timeout = saved_log_timeout_;
+    RemoveFiles();
+  }
+
+  static void RemoveFiles() {
+    remove("bench.db");
+    DiskManager::RemoveLogFiles("bench.db");
+  }
+
+  std::chrono::milliseconds saved_log_timeout_;
+};
+
+/**
+ * Measures the commit path of the write-ahead log: concurrent transactions that each insert a few small tuples through
+ * TableHeap::InsertTuple with logging on and then commit, across log timeouts, log buffer sizes and log compression.
+ * Every commit waits until its commit record is synced, so the latencies include the log sync, the log syncs per commit
+ * show how many commits share a group commit, and the disk bytes per transaction show what compression saves.
+ */
+// NOLINTNEXTLINE
+TEST_F(LogManagerBenchTest, CommitBench) {
+  const int num_threads = 8;
+  const int txns_per_thread = 50;
+  const int inserts_per_txn = 4;
+  const size_t pool_size = 64;
+  Schema schema{{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER}}};
+
+  printf("%10s %12s %5s %12s %10s %10s %14s %15s %17s\n", "timeout ms", "buffer bytes", "lz", "commits/s", "p50 us",
+         "p99 us", "log bytes/txn", "disk bytes/txn", "log syncs/commit");
+  for (auto timeout : {std::chrono::milliseconds(1), std::chrono::milliseconds(10), std::chrono::milliseconds(100)}) {
+    for (uint32_t log_buffer_size : {static_cast<uint32_t>(PAGE_SIZE), static_cast<uint32_t>(LOG_BUFFER_SIZE),
+                                     static_cast<uint32_t>(4 * LOG_BUFFER_SIZE)}) {
+      for (auto log_compression : {LogCompression::NONE, LogCompression::LZ}) {
+        log_timeout = timeout;
+        auto *disk_manager = new DiskManager("bench.db", DiskIOBackend::PREAD_PWRITE, LOG_SEGMENT_SIZE,
+                                             PageProtection::NONE, log_compression);
+        auto *log_manager = new LogManager(disk_manager, log_buffer_size);
+        auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager, log_manager);
+        auto *lock_manager = new LockManager();
+        auto *txn_manager = new TransactionManager(lock_manager, log_manager);
+        log_manager->RunFlushThread();
+
+        Transaction *txn = txn_manager->Begin();
+        auto *table = new TableHeap(bpm, lock_manager, log_manager, txn);
+        txn_manager->Commit(txn);
+        delete txn;
+        int64_t log_start = disk_manager->GetLogEndOffset();
+        int64_t disk_start = disk_manager->GetNumLogBytesWritten();
+        int log_syncs_start = disk_manager->GetNumLogSyncs();
+
+        std::vector<std::vector<int64_t>> latencies(num_threads);
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int tid = 0; tid < num_threads; ++tid) {
+          threads.emplace_back([&, tid] {
+            RID rid;
+            for (int i = 0; i < txns_per_thread; ++i) {
+              auto txn_start = std::chrono::steady_clock::now();
+              Transaction *txn = txn_manager->Begin();
+              for (int j = 0; j < inserts_per_txn; ++j) {
+                Tuple tuple({Value(TypeId::INTEGER, tid), Value(TypeId::INTEGER, i * inserts_per_txn + j)}, &schema);
+                EXPECT_TRUE(table->InsertTuple(tuple, &rid, txn));
+              }
+              txn_manager->Commit(txn);
+              delete txn;
+              auto latency = std::chrono::steady_clock::now() - txn_start;
+              latencies[tid].push_back(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+            }
+          });
+        }
+        for (auto &thread : threads) {
+          thread.join();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        int64_t elapsed_us =
+            std::max<int64_t>(1, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+        log_manager->StopFlushThread();
+
+        std::vector<int64_t> all_latencies;
+        for (const auto &thread_latencies : latencies) {
+          all_latencies.insert(all_latencies.end(), thread_latencies.begin(), thread_latencies.end());
+        }
+        std::sort(all_latencies.begin(), all_latencies.end());
+        const int64_t num_txns = num_threads * txns_per_thread;
+        ASSERT_EQ(num_txns, all_latencies.size());
+        int64_t log_bytes = disk_manager->GetLogEndOffset() - log_start;
+        int64_t disk_bytes = disk_manager->GetNumLogBytesWritten() - disk_start;
+        int log_syncs = disk_manager->GetNumLogSyncs() - log_syncs_start;
+        EXPECT_GT(log_bytes, 0);
+        EXPECT_GT(log_syncs, 0);
+        printf("%10" PRId64 " %12u %5s %12" PRId64 " %10" PRId64 " %10" PRId64 " %14" PRId64 " %15" PRId64 " %17.2f\n",
+               static_cast<int64_t>(timeout.count()), log_buffer_size,
+               log_compression == LogCompression::LZ ? "on" : "off", num_txns * 1000000 / elapsed_us,
+               all_latencies[num_txns / 2], all_latencies[num_txns * 99 / 100], log_bytes / num_txns,
+               disk_bytes / num_txns, static_cast<double>(log_syncs) / num_txns);
+
+        delete table;
+        delete txn_manager;
+        delete lock_manager;
+        delete bpm;
+        delete log_manager;
+        delete disk_manager;
+        RemoveFiles();
+      }
+    }
+  }
+}
+
+}  // namespace bustub
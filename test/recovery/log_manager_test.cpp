@@ -0,0 +1,269 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_manager_test.cpp
+//
+// Identification: test/recovery/log_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "recovery/log_manager.h"
+#include "recovery/log_recovery.h"
+
+namespace bustub {
+
+class LogManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("test.db");
+    DiskManager::RemoveLogFiles("test.db");
+  }
+
+  void TearDown() override {
+    remove("test.db");
+    DiskManager::RemoveLogFiles("test.db");
+  }
+};
+
+/** Read the log back and check that it holds the records with LSNs 0 .. num_records - 1 in order. */
+static void CheckLog(DiskManager *disk_manager, int num_records) {
+  LogRecovery log_recovery(disk_manager, nullptr);
+  std::vector<char> buffer(LOG_BUFFER_SIZE);
+  int64_t offset = 0;
+  for (lsn_t expected = 0; expected < num_records; ++expected) {
+    LogRecord log_record;
+    ASSERT_TRUE(disk_manager->ReadLog(buffer.data(), LOG_BUFFER_SIZE, offset));
+    ASSERT_TRUE(log_recovery.DeserializeLogRecord(buffer.data(), LOG_BUFFER_SIZE, &log_record));
+    ASSERT_EQ(expected, log_record.GetLSN());
+    offset += log_record.GetSize();
+  }
+  char byte;
+  EXPECT_FALSE(disk_manager->ReadLog(&byte, 1, offset));
+  EXPECT_EQ(offset, disk_manager->GetLogEndOffset());
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, GroupCommitTest) {
+  const int num_threads = 8;
+  const int num_txns = 50;
+
+  auto *disk_manager = new DiskManager("test.db");
+  auto *log_manager = new LogManager(disk_manager);
+  log_manager->RunFlushThread();
+  EXPECT_TRUE(enable_logging);
+
+  // Scenario: every commit blocks until its commit record is durable, and concurrent commits share log syncs.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      for (int i = 0; i < num_txns; ++i) {
+        txn_id_t txn_id = tid * num_txns + i;
+        LogRecord begin(txn_id, INVALID_LSN, LogRecordType::BEGIN);
+        lsn_t prev_lsn = log_manager->AppendLogRecord(&begin);
+        LogRecord commit(txn_id, prev_lsn, LogRecordType::COMMIT);
+        lsn_t lsn = log_manager->AppendLogRecord(&commit);
+        EXPECT_LT(prev_lsn, lsn);
+        log_manager->Flush(lsn);
+        EXPECT_GE(log_manager->GetPersistentLSN(), lsn);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  // Every log write is synced, besides the new segment file and its directory.
+  EXPECT_EQ(disk_manager->GetNumFlushes() + 2, disk_manager->GetNumLogSyncs());
+  EXPECT_LT(disk_manager->GetNumLogSyncs(), num_threads * num_txns);
+
+  log_manager->StopFlushThread();
+  EXPECT_FALSE(enable_logging);
+  EXPECT_EQ(2 * num_threads * num_txns, log_manager->GetNextLSN());
+  EXPECT_EQ(2 * num_threads * num_txns - 1, log_manager->GetPersistentLSN());
+  CheckLog(disk_manager, 2 * num_threads * num_txns);
+
+  delete log_manager;
+  disk_manager->ShutDown();
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, FullBufferTest) {
+  const int num_threads = 4;
+  const int num_records = 100;
+
+  // A tuple of a quarter of a page, so the records fill up the log buffer several times over.
+  std::vector<char> storage(sizeof(int32_t) + PAGE_SIZE / 4, 'x');
+  auto tuple_size = static_cast<int32_t>(PAGE_SIZE / 4);
+  memcpy(storage.data(), &tuple_size, sizeof(int32_t));
+  Tuple tuple;
+  tuple.DeserializeFrom(storage.data());
+
+  // Scenario: appenders that find the buffer full wait for the flush thread to swap buffers, without any commit, with
+  // the default log buffers and with buffers that only hold a few records.
+  for (uint32_t log_buffer_size : {static_cast<uint32_t>(LOG_BUFFER_SIZE), static_cast<uint32_t>(PAGE_SIZE)}) {
+    auto *disk_manager = new DiskManager("test.db");
+    auto *log_manager = new LogManager(disk_manager, log_buffer_size);
+    log_manager->RunFlushThread();
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([&, tid] {
+        for (int i = 0; i < num_records; ++i) {
+          LogRecord insert(tid, INVALID_LSN, LogRecordType::INSERT, RID(tid, i), tuple);
+          log_manager->AppendLogRecord(&insert);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    log_manager->StopFlushThread();
+    EXPECT_GT(disk_manager->GetNumFlushes(), num_threads * num_records * (PAGE_SIZE / 4) / log_buffer_size);
+    CheckLog(disk_manager, num_threads * num_records);
+
+    delete log_manager;
+    disk_manager->ShutDown();
+    delete disk_manager;
+    remove("test.db");
+    DiskManager::RemoveLogFiles("test.db");
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, CompressedLogTest) {
+  const int num_records = 500;
+
+  auto *disk_manager = new DiskManager("test.db", DiskIOBackend::PREAD_PWRITE, LOG_SEGMENT_SIZE,
+                                       PageProtection::NONE, LogCompression::LZ);
+  auto *log_manager = new LogManager(disk_manager);
+  log_manager->RunFlushThread();
+
+  // Tuples that repeat most of their bytes, like rows with padded columns.
+  std::vector<char> storage(sizeof(int32_t) + 100, 'x');
+  auto tuple_size = static_cast<int32_t>(100);
+  memcpy(storage.data(), &tuple_size, sizeof(int32_t));
+  Tuple tuple;
+  tuple.DeserializeFrom(storage.data());
+  for (int i = 0; i < num_records; ++i) {
+    LogRecord insert(0, INVALID_LSN, LogRecordType::INSERT, RID(i / 10, i % 10), tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&insert);
+    if (i % 100 == 99) {
+      log_manager->Flush(lsn);
+    }
+  }
+  log_manager->StopFlushThread();
+
+  // Scenario: the log takes a fraction of its size on disk, and reads back through LogRecovery as if uncompressed.
+  EXPECT_LT(disk_manager->GetNumLogBytesWritten() * 3, disk_manager->GetLogEndOffset());
+  CheckLog(disk_manager, num_records);
+  delete log_manager;
+  delete disk_manager;
+
+  // Scenario: after a restart, LSNs continue after the last record of the compressed log.
+  disk_manager = new DiskManager("test.db");
+  log_manager = new LogManager(disk_manager);
+  EXPECT_EQ(num_records, log_manager->GetNextLSN());
+  delete log_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, TornSegmentTest) {
+  const int num_records = 10;
+  // Segments of a single byte, so that every log write starts a new one.
+  auto open_disk_manager = [] { return new DiskManager("test.db", DiskIOBackend::PREAD_PWRITE, 1); };
+  auto *disk_manager = open_disk_manager();
+  auto *log_manager = new LogManager(disk_manager);
+  log_manager->RunFlushThread();
+  for (int i = 0; i < 2 * num_records; ++i) {
+    LogRecord begin(i, INVALID_LSN, LogRecordType::BEGIN);
+    lsn_t lsn = log_manager->AppendLogRecord(&begin);
+    if (i % num_records == num_records - 1) {
+      log_manager->Flush(lsn);
+    }
+  }
+  delete log_manager;
+  ASSERT_LE(2, disk_manager->GetNumLogSegments());
+  int64_t segment_offset = disk_manager->GetLastLogSegmentOffset();
+  int64_t records_size = disk_manager->GetLogEndOffset() - segment_offset;
+  lsn_t start_lsn = disk_manager->GetLastLogSegmentStartLSN();
+  std::vector<char> buffer(LOG_BUFFER_SIZE);
+  ASSERT_TRUE(disk_manager->ReadLog(buffer.data(), LOG_BUFFER_SIZE, segment_offset));
+  LogRecord first_record;
+  ASSERT_TRUE(LogRecovery(disk_manager, nullptr).DeserializeLogRecord(buffer.data(), LOG_BUFFER_SIZE, &first_record));
+  EXPECT_EQ(first_record.GetLSN(), start_lsn);
+  delete disk_manager;
+
+  std::string last_segment;
+  for (const auto &entry : std::filesystem::directory_iterator(".")) {
+    std::string name = entry.path().filename().string();
+    if (name.rfind("test.log.", 0) == 0 && name > last_segment) {
+      last_segment = name;
+    }
+  }
+  ASSERT_FALSE(last_segment.empty());
+  auto header_size = std::filesystem::file_size(last_segment) - records_size;
+
+  // Scenario: a crash tore the first record of the newest segment, or left the segment with only its header. LSNs
+  // continue after the records of the older segments rather than starting over, and new records follow them.
+  for (auto size : {header_size + 3, header_size}) {
+    std::filesystem::resize_file(last_segment, size);
+    disk_manager = open_disk_manager();
+    log_manager = new LogManager(disk_manager);
+    EXPECT_EQ(start_lsn, log_manager->GetNextLSN());
+    EXPECT_EQ(start_lsn - 1, log_manager->GetPersistentLSN());
+    EXPECT_EQ(segment_offset, disk_manager->GetLogEndOffset());
+    delete log_manager;
+    delete disk_manager;
+  }
+  disk_manager = open_disk_manager();
+  log_manager = new LogManager(disk_manager);
+  log_manager->RunFlushThread();
+  LogRecord begin(0, INVALID_LSN, LogRecordType::BEGIN);
+  EXPECT_EQ(start_lsn, log_manager->AppendLogRecord(&begin));
+  log_manager->Flush(start_lsn);
+  delete log_manager;
+  CheckLog(disk_manager, start_lsn + 1);
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, TimeoutTest) {
+  auto saved_log_timeout = log_timeout;
+  log_timeout = std::chrono::milliseconds(50);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *log_manager = new LogManager(disk_manager);
+  log_manager->RunFlushThread();
+
+  // Scenario: without anyone forcing the log, the flush thread writes it out after the log timeout.
+  LogRecord begin(0, INVALID_LSN, LogRecordType::BEGIN);
+  lsn_t lsn = log_manager->AppendLogRecord(&begin);
+  auto deadline = std::chrono::steady_clock::now() + 5 * log_timeout;
+  while (log_manager->GetPersistentLSN() < lsn && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(lsn, log_manager->GetPersistentLSN());
+  EXPECT_EQ(1, disk_manager->GetNumFlushes());
+
+  log_manager->StopFlushThread();
+  CheckLog(disk_manager, 1);
+
+  delete log_manager;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  log_timeout = saved_log_timeout;
+}
+
+}  // namespace bustub
@@ -0,0 +1,341 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_recovery_test.cpp
+//
+// Identification: test/recovery/log_recovery_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/bustub_instance.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "recovery/log_recovery.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+class LogRecoveryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("test.db");
+    DiskManager::RemoveLogFiles("test.db");
+  }
+
+  void TearDown() override {
+    remove("test.db");
+    DiskManager::RemoveLogFiles("test.db");
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(LogRecoveryTest, ParallelRedoTest) {
+  const int num_tuples = 2000;
+  Schema schema{{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}}};
+  auto make_tuple = [&](int a) {
+    return Tuple({Value(TypeId::INTEGER, a), Value(TypeId::VARCHAR, std::string(60, 'b'))}, &schema);
+  };
+
+  auto *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+  TransactionManager *txn_manager = bustub_instance->transaction_manager_;
+
+  // A committed transaction fills a table heap of many more pages than the buffer pool holds, so some of its pages
+  // reach the disk before the crash and some do not.
+  Transaction *txn = txn_manager->Begin();
+  auto *table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                              bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = table->GetFirstPageId();
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples; ++i) {
+    ASSERT_TRUE(table->InsertTuple(make_tuple(i), &rids[i], txn));
+  }
+  txn_manager->Commit(txn);
+  delete txn;
+
+  // A transaction that never commits updates, deletes and inserts.
+  Transaction *loser = txn_manager->Begin();
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(-1), rids[0], loser));
+  ASSERT_TRUE(table->MarkDelete(rids[1], loser));
+  RID loser_rid;
+  ASSERT_TRUE(table->InsertTuple(make_tuple(-2), &loser_rid, loser));
+
+  // A transaction that commits after the loser's changes.
+  txn = txn_manager->Begin();
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(7777), rids[2], txn));
+  txn_manager->Commit(txn);
+  delete txn;
+
+  // Crash: the log is on disk, the dirty pages in the buffer pool are lost.
+  delete loser;
+  delete table;
+  delete bustub_instance;
+
+  bustub_instance = new BustubInstance("test.db");
+  auto *log_recovery =
+      new LogRecovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_, nullptr, 4);
+  log_recovery->Redo();
+  log_recovery->Undo();
+  delete log_recovery;
+
+  txn = bustub_instance->transaction_manager_->Begin();
+  table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                        bustub_instance->log_manager_, first_page_id);
+  Tuple tuple;
+  for (int i = 0; i < num_tuples; ++i) {
+    ASSERT_TRUE(table->GetTuple(rids[i], &tuple, txn)) << i;
+    EXPECT_EQ(i == 2 ? 7777 : i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  EXPECT_FALSE(table->GetTuple(loser_rid, &tuple, txn));
+
+  // Every page of the heap is reachable again.
+  int count = 0;
+  for (auto it = table->Begin(txn); it != table->End(); ++it) {
+    count++;
+  }
+  EXPECT_EQ(num_tuples, count);
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  delete table;
+  delete bustub_instance;
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogRecoveryTest, CompactLogRecordTest) {
+  Schema schema{{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}}};
+  auto make_tuple = [&](int a, size_t length) {
+    return Tuple({Value(TypeId::INTEGER, a), Value(TypeId::VARCHAR, std::string(length, 'b'))}, &schema);
+  };
+  auto bytes = [](const Tuple &tuple) { return std::string(tuple.GetData(), tuple.GetLength()); };
+  Tuple old_tuple = make_tuple(1, 60);
+  Tuple new_tuple = make_tuple(2, 60);
+  Tuple short_tuple = make_tuple(1, 30);
+
+  // Scenario: an update is logged as the byte ranges it changed, and can be replayed and reverted from them alone.
+  LogRecord update(0, INVALID_LSN, LogRecordType::UPDATE, RID(0, 0), old_tuple, new_tuple);
+  ASSERT_EQ(1, update.GetUpdateRanges().size());
+  EXPECT_EQ(1, update.GetUpdateRanges()[0].new_bytes_.size());
+  EXPECT_EQ(bytes(new_tuple), bytes(update.RedoUpdate(old_tuple)));
+  EXPECT_EQ(bytes(old_tuple), bytes(update.UndoUpdate(new_tuple)));
+  LogRecord shrink(0, INVALID_LSN, LogRecordType::UPDATE, RID(0, 0), old_tuple, short_tuple);
+  EXPECT_EQ(bytes(short_tuple), bytes(shrink.RedoUpdate(old_tuple)));
+  EXPECT_EQ(bytes(old_tuple), bytes(shrink.UndoUpdate(short_tuple)));
+
+  auto *disk_manager = new DiskManager("test.db");
+  auto *log_manager = new LogManager(disk_manager);
+  log_manager->RunFlushThread();
+  LogRecord begin(0, INVALID_LSN, LogRecordType::BEGIN);
+  lsn_t prev_lsn = log_manager->AppendLogRecord(&begin);
+  update = LogRecord(0, prev_lsn, LogRecordType::UPDATE, RID(0, 0), old_tuple, new_tuple);
+  prev_lsn = log_manager->AppendLogRecord(&update);
+  LogRecord commit(0, prev_lsn, LogRecordType::COMMIT);
+  lsn_t commit_lsn = log_manager->AppendLogRecord(&commit);
+  log_manager->Flush(commit_lsn);
+  // The old format took a 20 byte header and both whole tuples.
+  EXPECT_LT(update.GetSize(), static_cast<int32_t>(old_tuple.GetLength()) / 2);
+  delete log_manager;
+  delete disk_manager;
+
+  // Scenario: a crash tears the last record; it fails its checksum, and the log continues after the record before.
+  std::string last_segment;
+  for (const auto &entry : std::filesystem::directory_iterator(".")) {
+    std::string name = entry.path().filename().string();
+    if (name.rfind("test.log.", 0) == 0 && name > last_segment) {
+      last_segment = name;
+    }
+  }
+  ASSERT_FALSE(last_segment.empty());
+  {
+    std::fstream file(last_segment, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(-1, std::ios::end);
+    file.put('x');
+  }
+  disk_manager = new DiskManager("test.db");
+  log_manager = new LogManager(disk_manager);
+  EXPECT_EQ(commit_lsn, log_manager->GetNextLSN());
+  log_manager->RunFlushThread();
+  commit = LogRecord(0, prev_lsn, LogRecordType::COMMIT);
+  log_manager->Flush(log_manager->AppendLogRecord(&commit));
+  delete log_manager;
+
+  std::vector<char> log(LOG_BUFFER_SIZE);
+  ASSERT_TRUE(disk_manager->ReadLog(log.data(), static_cast<int>(log.size()), 0));
+  auto *log_recovery = new LogRecovery(disk_manager, nullptr);
+  std::vector<LogRecordType> types;
+  LogRecord log_record;
+  LogRecord update_record;
+  for (size_t offset = 0; log_recovery->DeserializeLogRecord(log.data() + offset, static_cast<int>(log.size() - offset),
+                                                             &log_record);) {
+    EXPECT_EQ(static_cast<lsn_t>(types.size()), log_record.GetLSN());
+    EXPECT_EQ(0, log_record.GetTxnId());
+    EXPECT_EQ(static_cast<lsn_t>(types.size()) - 1, log_record.GetPrevLSN());
+    types.push_back(log_record.GetLogRecordType());
+    if (log_record.GetLogRecordType() == LogRecordType::UPDATE) {
+      update_record = log_record;
+    }
+    offset += log_record.GetSize();
+  }
+  EXPECT_EQ((std::vector{LogRecordType::BEGIN, LogRecordType::UPDATE, LogRecordType::COMMIT}), types);
+  EXPECT_EQ(bytes(new_tuple), bytes(update_record.RedoUpdate(old_tuple)));
+  EXPECT_EQ(RID(0, 0), update_record.GetUpdateRID());
+  delete log_recovery;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogRecoveryTest, CompensationLogRecordTest) {
+  const int num_tuples = 10;
+  Schema schema{{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}}};
+  auto make_tuple = [&](int a) {
+    return Tuple({Value(TypeId::INTEGER, a), Value(TypeId::VARCHAR, std::string(60, 'b'))}, &schema);
+  };
+  // Recover with the log manager running, so that undo logs its CLRs.
+  auto recover = [] {
+    auto *bustub_instance = new BustubInstance("test.db");
+    bustub_instance->log_manager_->RunFlushThread();
+    LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                             bustub_instance->log_manager_);
+    log_recovery.Redo();
+    log_recovery.Undo();
+    return bustub_instance;
+  };
+  // The changes, the CLRs and the ABORT records in the log by transaction, with the file offsets of the CLRs.
+  struct TxnLog {
+    std::vector<LogRecord> changes_;
+    std::vector<LogRecord> clrs_;
+    std::vector<int64_t> clr_offsets_;
+    int aborts_{0};
+  };
+  auto read_log = [] {
+    auto *disk_manager = new DiskManager("test.db");
+    std::vector<char> log(1 << 20);
+    EXPECT_TRUE(disk_manager->ReadLog(log.data(), static_cast<int>(log.size()), 0));
+    LogRecovery log_recovery(disk_manager, nullptr);
+    std::unordered_map<txn_id_t, TxnLog> txn_logs;
+    LogRecord log_record;
+    for (size_t offset = 0;
+         log_recovery.DeserializeLogRecord(log.data() + offset, static_cast<int>(log.size() - offset), &log_record);) {
+      TxnLog &txn_log = txn_logs[log_record.GetTxnId()];
+      switch (log_record.GetLogRecordType()) {
+        case LogRecordType::INSERT:
+        case LogRecordType::MARKDELETE:
+        case LogRecordType::UPDATE:
+          txn_log.changes_.push_back(log_record);
+          break;
+        case LogRecordType::CLR:
+          txn_log.clrs_.push_back(log_record);
+          txn_log.clr_offsets_.push_back(offset);
+          break;
+        case LogRecordType::ABORT:
+          txn_log.aborts_++;
+          break;
+        default:
+          break;
+      }
+      offset += log_record.GetSize();
+    }
+    delete disk_manager;
+    return txn_logs;
+  };
+  // Every change is undone by exactly one CLR, latest change first, each CLR resuming before the change it undid.
+  auto check_rollback = [](const TxnLog &txn_log) {
+    const std::vector<LogRecordType> undo_types{LogRecordType::APPLYDELETE, LogRecordType::ROLLBACKDELETE,
+                                                LogRecordType::UPDATE};
+    ASSERT_EQ(3, txn_log.changes_.size());
+    ASSERT_EQ(3, txn_log.clrs_.size());
+    for (size_t i = 0; i < txn_log.clrs_.size(); ++i) {
+      LogRecord undone = txn_log.changes_[txn_log.changes_.size() - 1 - i];
+      LogRecord clr = txn_log.clrs_[i];
+      EXPECT_EQ(undone.GetPrevLSN(), clr.GetUndoNextLSN()) << i;
+      EXPECT_EQ(undo_types[i], clr.GetChangeType()) << i;
+    }
+    EXPECT_EQ(1, txn_log.aborts_);
+  };
+
+  auto *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+  TransactionManager *txn_manager = bustub_instance->transaction_manager_;
+  Transaction *txn = txn_manager->Begin();
+  auto *table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                              bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = table->GetFirstPageId();
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples; ++i) {
+    ASSERT_TRUE(table->InsertTuple(make_tuple(i), &rids[i], txn));
+  }
+  txn_manager->Commit(txn);
+  delete txn;
+
+  // A transaction that aborts, and one that never commits, each update, delete and insert.
+  Transaction *aborted = txn_manager->Begin();
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(-1), rids[0], aborted));
+  ASSERT_TRUE(table->MarkDelete(rids[1], aborted));
+  RID aborted_rid;
+  ASSERT_TRUE(table->InsertTuple(make_tuple(-2), &aborted_rid, aborted));
+  txn_id_t aborted_id = aborted->GetTransactionId();
+  txn_manager->Abort(aborted);
+  delete aborted;
+  Transaction *loser = txn_manager->Begin();
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(-3), rids[2], loser));
+  ASSERT_TRUE(table->MarkDelete(rids[3], loser));
+  RID loser_rid;
+  ASSERT_TRUE(table->InsertTuple(make_tuple(-4), &loser_rid, loser));
+  txn_id_t loser_id = loser->GetTransactionId();
+
+  // Crash: the log is on disk, the dirty pages in the buffer pool are lost.
+  delete loser;
+  delete table;
+  delete bustub_instance;
+
+  // Scenario: the abort and the recovery log one CLR for every change they undo.
+  delete recover();
+  auto txn_logs = read_log();
+  check_rollback(txn_logs[aborted_id]);
+  check_rollback(txn_logs[loser_id]);
+
+  // Scenario: a crash during recovery lost all but the first CLR of the loser, and all of its pages. The next
+  // recovery redoes that CLR and undoes only the two changes it did not cover.
+  auto *disk_manager = new DiskManager("test.db");
+  disk_manager->TruncateLogTail(txn_logs[loser_id].clr_offsets_[1]);
+  delete disk_manager;
+  ASSERT_EQ(1, read_log()[loser_id].clrs_.size());
+  bustub_instance = recover();
+  txn_logs = read_log();
+  check_rollback(txn_logs[loser_id]);
+
+  txn = bustub_instance->transaction_manager_->Begin();
+  table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                        bustub_instance->log_manager_, first_page_id);
+  Tuple tuple;
+  for (int i = 0; i < num_tuples; ++i) {
+    ASSERT_TRUE(table->GetTuple(rids[i], &tuple, txn)) << i;
+    EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  int count = 0;
+  for (auto it = table->Begin(txn); it != table->End(); ++it) {
+    count++;
+  }
+  EXPECT_EQ(num_tuples, count);
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  delete table;
+  lsn_t next_lsn = bustub_instance->log_manager_->GetNextLSN();
+  delete bustub_instance;
+
+  // Scenario: once every loser is rolled back, recovery has nothing left to undo and logs nothing.
+  bustub_instance = recover();
+  EXPECT_EQ(next_lsn, bustub_instance->log_manager_->GetNextLSN());
+  delete bustub_instance;
+}
+
+}  // namespace bustub
@@ -31,14 +31,14 @@ class RecoveryTest : public ::testing::Test {
   // This function is called before every test.
   void SetUp() override {
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
   }
 
   // This function is called after every test.
   void TearDown() override {
     LOG_INFO("Tearing down the system..");
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
   };
 };
 
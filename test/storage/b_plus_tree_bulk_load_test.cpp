@@ -0,0 +1,216 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bulk_load_test.cpp
+//
+// Identification: test/storage/b_plus_tree_bulk_load_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using BulkLoadTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using BulkLoadInternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+
+/**
+ * Check the node and its subtree: every node but the root is between min size and max size - 1, children point back to
+ * their parent and all leaves are at the same depth.
+ * @return the height of the subtree
+ */
+static int CheckNode(BufferPoolManager *bpm, page_id_t page_id, page_id_t parent_id) {
+  auto *node = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+  EXPECT_EQ(parent_id, node->GetParentPageId());
+  EXPECT_LT(node->GetSize(), node->GetMaxSize());
+  if (parent_id != INVALID_PAGE_ID) {
+    EXPECT_GE(node->GetSize(), node->GetMinSize());
+  }
+  int height = 1;
+  if (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<BulkLoadInternalPage *>(node);
+    height += CheckNode(bpm, internal->ValueAt(0), page_id);
+    for (int i = 1; i < internal->GetSize(); i++) {
+      EXPECT_EQ(height - 1, CheckNode(bpm, internal->ValueAt(i), page_id));
+    }
+  }
+  bpm->UnpinPage(page_id, false);
+  return height;
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, BulkLoadTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  for (auto [leaf_max_size, internal_max_size] :
+       {std::make_pair(2, 3), std::make_pair(4, 5), std::make_pair(64, 16)}) {
+    for (double fill_factor : {1.0, 0.5}) {
+      for (int64_t num_keys : {0, 1, 2, 3, 7, 100, 2000}) {
+        auto *disk_manager = new DiskManager("test.db");
+        BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+        BulkLoadTree tree("foo_pk", bpm, comparator, leaf_max_size, internal_max_size);
+        Transaction transaction(0);
+        page_id_t page_id;
+        auto header_page = bpm->NewPage(&page_id);
+        (void)header_page;
+
+        // Scenario: the even keys, bulk loaded in order, are all found by point lookups and by a full scan.
+        int64_t next_key = 0;
+        ASSERT_TRUE(tree.BulkLoad(
+            [&](std::pair<GenericKey<8>, RID> *item) {
+              if (next_key == num_keys) {
+                return false;
+              }
+              item->first.SetFromInteger(2 * next_key);
+              item->second.Set(0, 2 * next_key);
+              next_key++;
+              return true;
+            },
+            fill_factor));
+        ASSERT_EQ(num_keys == 0, tree.IsEmpty());
+        if (num_keys == 0) {
+          bpm->UnpinPage(HEADER_PAGE_ID, true);
+          delete bpm;
+          delete disk_manager;
+          remove("test.db");
+          continue;
+        }
+
+        std::vector<RID> rids;
+        GenericKey<8> index_key;
+        for (int64_t key = 0; key < 2 * num_keys; key++) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          ASSERT_EQ(key % 2 == 0, tree.GetValue(index_key, &rids, &transaction));
+          if (key % 2 == 0) {
+            EXPECT_EQ(key, rids[0].GetSlotNum());
+          }
+        }
+        int64_t current_key = 0;
+        for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+          EXPECT_EQ(current_key, (*iterator).first.ToString());
+          current_key += 2;
+        }
+        EXPECT_EQ(2 * num_keys, current_key);
+
+        // Scenario: a second bulk load into the tree that is not empty anymore is rejected.
+        EXPECT_FALSE(tree.BulkLoad([](std::pair<GenericKey<8>, RID> *item) { return false; }));
+
+        // Scenario: inserts go on splitting the bulk loaded nodes, which keeps all keys in order.
+        RID rid;
+        for (int64_t key = 1; key < 2 * num_keys; key += 2) {
+          index_key.SetFromInteger(key);
+          rid.Set(0, key);
+          EXPECT_TRUE(tree.Insert(index_key, rid, &transaction));
+        }
+        current_key = 0;
+        for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+          EXPECT_EQ(current_key, (*iterator).first.ToString());
+          current_key++;
+        }
+        EXPECT_EQ(2 * num_keys, current_key);
+
+        bpm->UnpinPage(HEADER_PAGE_ID, true);
+        delete bpm;
+        delete disk_manager;
+        remove("test.db");
+      }
+    }
+  }
+  DiskManager::RemoveLogFiles("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, ShapeTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  // Scenario: bulk loaded trees keep the node sizes of the tree at every level, for any number of keys.
+  for (int64_t num_keys = 1; num_keys < 200; num_keys++) {
+    for (auto [leaf_max_size, internal_max_size, fill_factor] :
+         {std::make_tuple(2, 3, 1.0), std::make_tuple(2, 3, 0.5), std::make_tuple(5, 6, 1.0),
+          std::make_tuple(5, 6, 0.7)}) {
+      auto *disk_manager = new DiskManager("test.db");
+      BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+      BulkLoadTree tree("foo_pk", bpm, comparator, leaf_max_size, internal_max_size);
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+      int64_t next_key = 0;
+      ASSERT_TRUE(tree.BulkLoad(
+          [&](std::pair<GenericKey<8>, RID> *item) {
+            if (next_key == num_keys) {
+              return false;
+            }
+            item->first.SetFromInteger(next_key);
+            item->second.Set(0, next_key);
+            next_key++;
+            return true;
+          },
+          fill_factor));
+      page_id_t root_id;
+      ASSERT_TRUE(reinterpret_cast<HeaderPage *>(header_page)->GetRootId("foo_pk", &root_id));
+      CheckNode(bpm, root_id, INVALID_PAGE_ID);
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete bpm;
+      delete disk_manager;
+      remove("test.db");
+    }
+  }
+  DiskManager::RemoveLogFiles("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, DuplicateKeyTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  BulkLoadTree tree("foo_pk", bpm, comparator, 4, 5);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // Scenario: of equal keys only the first one is loaded, as Insert would keep it.
+  std::vector<int64_t> keys = {1, 1, 2, 3, 3, 3, 4, 5, 6, 6};
+  size_t next = 0;
+  ASSERT_TRUE(tree.BulkLoad([&](std::pair<GenericKey<8>, RID> *item) {
+    if (next == keys.size()) {
+      return false;
+    }
+    item->first.SetFromInteger(keys[next]);
+    item->second.Set(0, next);
+    next++;
+    return true;
+  }));
+  std::vector<int64_t> expected_slots = {0, 2, 3, 6, 7, 8};
+  size_t i = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    ASSERT_LT(i, expected_slots.size());
+    EXPECT_EQ(static_cast<int64_t>(i) + 1, (*iterator).first.ToString());
+    EXPECT_EQ(expected_slots[i], (*iterator).second.GetSlotNum());
+    i++;
+  }
+  EXPECT_EQ(expected_slots.size(), i);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  DiskManager::RemoveLogFiles("test.db");
+}
+
+}  // namespace bustub
@@ -10,10 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
@@ -149,7 +151,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
@@ -200,7 +202,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
@@ -242,7 +244,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
@@ -285,7 +287,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
@@ -330,7 +332,86 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
+}
+
+TEST(BPlusTreeConcurrentTest, OptimisticReadTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(256, disk_manager);
+  // small nodes, so that the writers split leaves and internal pages all the time
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  // the even keys are there from the start, the writers insert the odd keys between them
+  const int64_t num_keys = 1000;
+  std::vector<int64_t> even_keys;
+  std::vector<int64_t> odd_keys;
+  for (int64_t key = 0; key < num_keys; key++) {
+    (key % 2 == 0 ? even_keys : odd_keys).push_back(key);
+  }
+  InsertHelper(&tree, even_keys);
+
+  std::atomic<bool> done = false;
+  auto writer = [&](uint64_t thread_itr) { InsertHelperSplit(&tree, odd_keys, 2, thread_itr); };
+  // Scenario: readers racing with the splits always find the even keys, by point lookup and by range scan.
+  auto reader = [&](uint64_t thread_itr) {
+    GenericKey<8> index_key;
+    std::vector<RID> rids;
+    while (!done) {
+      for (size_t i = thread_itr; i < even_keys.size(); i += 7) {
+        int64_t key = even_keys[i];
+        index_key.SetFromInteger(key);
+        rids.clear();
+        EXPECT_TRUE(tree.GetValue(index_key, &rids));
+        ASSERT_EQ(1, rids.size());
+        EXPECT_EQ(key, rids[0].GetSlotNum());
+        auto iterator = tree.Begin(index_key);
+        ASSERT_FALSE(iterator.IsEnd());
+        EXPECT_EQ(key, (*iterator).first.ToString());
+      }
+    }
+  };
+  const uint64_t num_readers = 2;
+  std::vector<std::thread> readers;
+  for (uint64_t i = 0; i < num_readers; i++) {
+    readers.emplace_back(reader, i);
+  }
+  LaunchParallelTest(2, writer);
+  done = true;
+  for (auto &thread : readers) {
+    thread.join();
+  }
+
+  // Scenario: once the writers are done, the readers see all the keys, and without writers no read restarts.
+  size_t restarts = tree.GetNumOptimisticRestarts();
+  std::vector<RID> rids;
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < num_keys; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+  }
+  int64_t current_key = 0;
+  index_key.SetFromInteger(current_key);
+  for (auto iterator = tree.Begin(index_key); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ(current_key, (*iterator).first.ToString());
+    current_key += 1;
+  }
+  EXPECT_EQ(num_keys, current_key);
+  EXPECT_EQ(restarts, tree.GetNumOptimisticRestarts());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 }  // namespace bustub
@@ -95,7 +95,7 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
@@ -173,6 +173,6 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 }  // namespace bustub
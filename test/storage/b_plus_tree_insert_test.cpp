@@ -75,7 +75,7 @@ TEST(BPlusTreeTests, DISABLED_InsertTest1) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 TEST(BPlusTreeTests, DISABLED_InsertTest2) {
@@ -143,6 +143,6 @@ TEST(BPlusTreeTests, DISABLED_InsertTest2) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 }  // namespace bustub
@@ -0,0 +1,450 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_key_compression_test.cpp
+//
+// Identification: test/storage/b_plus_tree_key_compression_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using WideKey = GenericKey<64>;
+using WideComparator = GenericComparator<64>;
+using WideTree = BPlusTree<WideKey, RID, WideComparator>;
+using WideInternalPage = BPlusTreeInternalPage<WideKey, page_id_t, WideComparator>;
+using WideLeafPage = BPlusTreeLeafPage<WideKey, RID, WideComparator>;
+
+/** The node sizes of the trees, which the size macros take from the KeyType and ValueType in scope. */
+struct WidePageSizes {
+  using KeyType = WideKey;
+  using ValueType = RID;
+  static constexpr int LEAF = LEAF_PAGE_SIZE;
+  static constexpr int INTERNAL = INTERNAL_PAGE_SIZE;
+  static constexpr int LEAF_PREFIX = LEAF_PAGE_PREFIX_SIZE;
+  static constexpr int INTERNAL_PREFIX = INTERNAL_PAGE_PREFIX_SIZE;
+};
+
+// small nodes that split by the number of entries, and nodes that split when their page is full
+static const std::vector<std::pair<int, int>> node_sizes = {
+    {4, 5}, {WidePageSizes::LEAF_PREFIX, WidePageSizes::INTERNAL_PREFIX}};
+
+static const char *narrow_schema = "a bigint";
+static const char *wide_schema = "a bigint,b bigint,c bigint,d bigint,e bigint,f bigint,g bigint,h bigint";
+
+/** A 64 byte key that orders by the first column; with a wide schema the other columns are filled from the key. */
+static WideKey MakeKey(Schema *key_schema, int64_t key) {
+  WideKey index_key;
+  if (key_schema->GetColumnCount() == 1) {
+    index_key.SetFromInteger(key);
+    return index_key;
+  }
+  std::vector<Value> values;
+  uint64_t hash = key;
+  for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+    values.emplace_back(TypeId::BIGINT, static_cast<int64_t>(hash));
+    hash = hash * 6364136223846793005ULL + 1442695040888963407ULL;
+  }
+  index_key.SetFromKey(Tuple(values, key_schema));
+  return index_key;
+}
+
+/**
+ * Check the node and its subtree: children point back to their parent, all leaves are at the same depth, and the keys
+ * of each subtree are between the separators around it.
+ * @return the height of the subtree
+ */
+static int CheckNode(BufferPoolManager *bpm, const WideComparator &comparator, page_id_t page_id,
+                     page_id_t parent_id, const WideKey *lower, const WideKey *upper, int *num_leaves) {
+  auto *node = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+  EXPECT_EQ(parent_id, node->GetParentPageId());
+  EXPECT_LT(node->GetSize(), node->GetMaxSize());
+  int height = 1;
+  if (node->IsLeafPage()) {
+    auto *leaf = reinterpret_cast<WideLeafPage *>(node);
+    for (int i = 0; i < leaf->GetSize(); i++) {
+      EXPECT_TRUE(lower == nullptr || comparator(*lower, leaf->KeyAt(i)) <= 0);
+      EXPECT_TRUE(upper == nullptr || comparator(leaf->KeyAt(i), *upper) < 0);
+    }
+    (*num_leaves)++;
+  } else {
+    auto *internal = reinterpret_cast<WideInternalPage *>(node);
+    EXPECT_GE(internal->GetSize(), 1);
+    std::vector<WideKey> keys;
+    for (int i = 0; i < internal->GetSize(); i++) {
+      keys.push_back(internal->KeyAt(i));
+    }
+    for (int i = 0; i < internal->GetSize(); i++) {
+      const WideKey *child_lower = i == 0 ? lower : &keys[i];
+      const WideKey *child_upper = i + 1 == internal->GetSize() ? upper : &keys[i + 1];
+      int child_height =
+          CheckNode(bpm, comparator, internal->ValueAt(i), page_id, child_lower, child_upper, num_leaves);
+      if (i == 0) {
+        height += child_height;
+      } else {
+        EXPECT_EQ(height - 1, child_height);
+      }
+    }
+  }
+  bpm->UnpinPage(page_id, false);
+  return height;
+}
+
+/** Check the whole tree. @return the number of its leaves */
+static int CheckTree(BufferPoolManager *bpm, const WideComparator &comparator, const WideTree &tree,
+                     Page *header_page) {
+  int num_leaves = 0;
+  page_id_t root_id;
+  if (tree.IsEmpty() || !reinterpret_cast<HeaderPage *>(header_page)->GetRootId("foo_pk", &root_id)) {
+    return num_leaves;
+  }
+  CheckNode(bpm, comparator, root_id, INVALID_PAGE_ID, nullptr, nullptr, &num_leaves);
+  return num_leaves;
+}
+
+/** Check that the tree holds exactly the keys, by point lookups and by a full scan. */
+static void CheckKeys(Schema *key_schema, WideTree *tree, std::vector<int64_t> keys) {
+  std::sort(keys.begin(), keys.end());
+  Transaction transaction(0);
+  std::vector<RID> rids;
+  for (int64_t key : keys) {
+    rids.clear();
+    ASSERT_TRUE(tree->GetValue(MakeKey(key_schema, key), &rids, &transaction)) << key;
+    EXPECT_EQ(static_cast<int32_t>(key), rids[0].GetSlotNum());
+  }
+  size_t i = 0;
+  for (auto iterator = tree->Begin(); iterator != tree->End(); ++iterator) {
+    ASSERT_LT(i, keys.size());
+    EXPECT_EQ(keys[i], (*iterator).first.ToString());
+    i++;
+  }
+  EXPECT_EQ(keys.size(), i);
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeKeyCompressionTest, InsertTest) {
+  for (const char *schema : {narrow_schema, wide_schema}) {
+    auto key_schema = ParseCreateStatement(schema);
+    WideComparator comparator(key_schema.get());
+    for (auto [leaf_max_size, internal_max_size] : node_sizes) {
+      // sequential, reverse and random keys, with negative ones among them
+      std::vector<std::vector<int64_t>> key_orders(3);
+      for (int64_t key = -1000; key < 2000; key++) {
+        key_orders[0].push_back(key);
+      }
+      key_orders[1].assign(key_orders[0].rbegin(), key_orders[0].rend());
+      key_orders[2] = key_orders[0];
+      std::shuffle(key_orders[2].begin(), key_orders[2].end(), std::mt19937(42));
+
+      for (const auto &keys : key_orders) {
+        auto *disk_manager = new DiskManager("test.db");
+        BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+        WideTree tree("foo_pk", bpm, comparator, leaf_max_size, internal_max_size, KeyCompression::PREFIX);
+        Transaction transaction(0);
+        page_id_t page_id;
+        auto header_page = bpm->NewPage(&page_id);
+
+        // Scenario: the keys inserted in any order are found by point lookups and come out of a scan in order.
+        for (int64_t key : keys) {
+          EXPECT_TRUE(tree.Insert(MakeKey(key_schema.get(), key), RID(0, key), &transaction));
+        }
+        // Scenario: keys that are in the tree already are rejected.
+        EXPECT_FALSE(tree.Insert(MakeKey(key_schema.get(), 7), RID(0, 7), &transaction));
+        CheckKeys(key_schema.get(), &tree, keys);
+        CheckTree(bpm, comparator, tree, header_page);
+
+        // Scenario: a scan from a key starts at that key.
+        int64_t current_key = 1500;
+        for (auto iterator = tree.Begin(MakeKey(key_schema.get(), current_key)); iterator != tree.End(); ++iterator) {
+          EXPECT_EQ(current_key, (*iterator).first.ToString());
+          current_key++;
+        }
+        EXPECT_EQ(2000, current_key);
+
+        bpm->UnpinPage(HEADER_PAGE_ID, true);
+        delete bpm;
+        delete disk_manager;
+        remove("test.db");
+      }
+    }
+  }
+  DiskManager::RemoveLogFiles("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeKeyCompressionTest, FanOutTest) {
+  // Scenario: with keys that share most of their bytes, a PREFIX tree needs a fraction of the leaves of a tree that
+  // stores whole keys, whether the keys are inserted or bulk loaded.
+  auto key_schema = ParseCreateStatement(narrow_schema);
+  WideComparator comparator(key_schema.get());
+  const int64_t num_keys = 10000;
+  int num_leaves[2][2];
+  for (int bulk_load = 0; bulk_load < 2; bulk_load++) {
+    for (auto key_compression : {KeyCompression::NONE, KeyCompression::PREFIX}) {
+      auto *disk_manager = new DiskManager("test.db");
+      BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+      bool prefix = key_compression == KeyCompression::PREFIX;
+      WideTree tree("foo_pk", bpm, comparator, prefix ? WidePageSizes::LEAF_PREFIX : WidePageSizes::LEAF,
+                    prefix ? WidePageSizes::INTERNAL_PREFIX : WidePageSizes::INTERNAL, key_compression);
+      Transaction transaction(0);
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      std::vector<int64_t> keys;
+      for (int64_t key = 0; key < num_keys; key++) {
+        keys.push_back(key);
+      }
+      if (bulk_load == 1) {
+        size_t next = 0;
+        ASSERT_TRUE(tree.BulkLoad([&](std::pair<WideKey, RID> *item) {
+          if (next == keys.size()) {
+            return false;
+          }
+          *item = {MakeKey(key_schema.get(), keys[next]), RID(0, keys[next])};
+          next++;
+          return true;
+        }));
+      } else {
+        std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+        for (int64_t key : keys) {
+          EXPECT_TRUE(tree.Insert(MakeKey(key_schema.get(), key), RID(0, key), &transaction));
+        }
+      }
+      CheckKeys(key_schema.get(), &tree, keys);
+      num_leaves[bulk_load][static_cast<int>(prefix)] = CheckTree(bpm, comparator, tree, header_page);
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete bpm;
+      delete disk_manager;
+      remove("test.db");
+    }
+    EXPECT_LT(3 * num_leaves[bulk_load][1], num_leaves[bulk_load][0]);
+  }
+  DiskManager::RemoveLogFiles("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeKeyCompressionTest, BulkLoadTest) {
+  // Scenario: PREFIX trees bulk loaded from wide keys at any fill factor hold all keys and take further inserts.
+  auto key_schema = ParseCreateStatement(wide_schema);
+  WideComparator comparator(key_schema.get());
+  for (auto [leaf_max_size, internal_max_size] : node_sizes) {
+    for (double fill_factor : {1.0, 0.5, 0.0}) {
+      for (int64_t num_keys : {0, 1, 2, 3, 100, 3000}) {
+        auto *disk_manager = new DiskManager("test.db");
+        BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+        WideTree tree("foo_pk", bpm, comparator, leaf_max_size, internal_max_size, KeyCompression::PREFIX);
+        Transaction transaction(0);
+        page_id_t page_id;
+        auto header_page = bpm->NewPage(&page_id);
+        std::vector<int64_t> keys;
+        int64_t next_key = 0;
+        ASSERT_TRUE(tree.BulkLoad(
+            [&](std::pair<WideKey, RID> *item) {
+              if (next_key == num_keys) {
+                return false;
+              }
+              *item = {MakeKey(key_schema.get(), 2 * next_key), RID(0, 2 * next_key)};
+              keys.push_back(2 * next_key);
+              next_key++;
+              return true;
+            },
+            fill_factor));
+        CheckKeys(key_schema.get(), &tree, keys);
+        CheckTree(bpm, comparator, tree, header_page);
+
+        for (int64_t key = 1; key < 2 * num_keys; key += 2) {
+          EXPECT_TRUE(tree.Insert(MakeKey(key_schema.get(), key), RID(0, key), &transaction));
+          keys.push_back(key);
+        }
+        CheckKeys(key_schema.get(), &tree, keys);
+        CheckTree(bpm, comparator, tree, header_page);
+
+        bpm->UnpinPage(HEADER_PAGE_ID, true);
+        delete bpm;
+        delete disk_manager;
+        remove("test.db");
+      }
+    }
+  }
+  DiskManager::RemoveLogFiles("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeKeyCompressionTest, RemoveTest) {
+  auto key_schema = ParseCreateStatement(wide_schema);
+  WideComparator comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  WideTree tree("foo_pk", bpm, comparator, WidePageSizes::LEAF_PREFIX, WidePageSizes::INTERNAL_PREFIX,
+                KeyCompression::PREFIX);
+  Transaction transaction(0);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 3000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+  for (int64_t key : keys) {
+    EXPECT_TRUE(tree.Insert(MakeKey(key_schema.get(), key), RID(0, key), &transaction));
+  }
+
+  // Scenario: after removing most keys, the rest of the keys are still found and scanned.
+  std::vector<int64_t> removed(keys.begin(), keys.begin() + 2500);
+  std::vector<int64_t> kept(keys.begin() + 2500, keys.end());
+  for (int64_t key = 1000; key < 2000; key++) {
+    if (std::find(removed.begin(), removed.end(), key) == removed.end()) {
+      removed.push_back(key);
+      kept.erase(std::find(kept.begin(), kept.end(), key));
+    }
+  }
+  for (int64_t key : removed) {
+    tree.Remove(MakeKey(key_schema.get(), key), &transaction);
+  }
+  CheckKeys(key_schema.get(), &tree, kept);
+  CheckTree(bpm, comparator, tree, header_page);
+  std::vector<RID> rids;
+  EXPECT_FALSE(tree.GetValue(MakeKey(key_schema.get(), 1500), &rids, &transaction));
+  // the first kept key after the removed range, which may be in a leaf after empty ones
+  int64_t first_key = INT64_MAX;
+  for (int64_t key : kept) {
+    if (key >= 1000) {
+      first_key = std::min(first_key, key);
+    }
+  }
+  {
+    // the iterator holds a latch on its leaf until it is destroyed
+    auto iterator = tree.Begin(MakeKey(key_schema.get(), first_key));
+    ASSERT_FALSE(iterator == tree.End());
+    EXPECT_EQ(first_key, (*iterator).first.ToString());
+  }
+
+  // Scenario: the removed keys can be inserted again.
+  for (int64_t key : removed) {
+    EXPECT_TRUE(tree.Insert(MakeKey(key_schema.get(), key), RID(0, key), &transaction));
+  }
+  CheckKeys(key_schema.get(), &tree, keys);
+  CheckTree(bpm, comparator, tree, header_page);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  DiskManager::RemoveLogFiles("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeKeyCompressionTest, RemoveAllTest) {
+  auto key_schema = ParseCreateStatement(wide_schema);
+  WideComparator comparator(key_schema.get());
+  const int64_t num_keys = 3000;
+  for (auto [leaf_max_size, internal_max_size] : node_sizes) {
+    for (int num_threads : {1, 4}) {
+      auto *disk_manager = new DiskManager("test.db");
+      BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+      WideTree tree("foo_pk", bpm, comparator, leaf_max_size, internal_max_size, KeyCompression::PREFIX);
+      Transaction transaction(0);
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      std::vector<int64_t> keys;
+      for (int64_t key = 0; key < num_keys; key++) {
+        keys.push_back(key);
+      }
+      std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+      for (int64_t key : keys) {
+        EXPECT_TRUE(tree.Insert(MakeKey(key_schema.get(), key), RID(0, key), &transaction));
+      }
+      EXPECT_LT(1, CheckTree(bpm, comparator, tree, header_page));
+
+      // Scenario: removing every key, by one thread or by several that remove interleaved keys, frees every leaf.
+      std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+      std::vector<std::thread> threads;
+      for (int tid = 0; tid < num_threads; tid++) {
+        threads.emplace_back([&, tid] {
+          Transaction thread_transaction(0);
+          for (size_t i = tid; i < keys.size(); i += num_threads) {
+            tree.Remove(MakeKey(key_schema.get(), keys[i]), &thread_transaction);
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      CheckKeys(key_schema.get(), &tree, {});
+      EXPECT_TRUE(tree.IsEmpty());
+      EXPECT_EQ(0, CheckTree(bpm, comparator, tree, header_page));
+
+      // Scenario: the keys can be inserted again.
+      for (int64_t key : keys) {
+        EXPECT_TRUE(tree.Insert(MakeKey(key_schema.get(), key), RID(0, key), &transaction));
+      }
+      CheckKeys(key_schema.get(), &tree, keys);
+      CheckTree(bpm, comparator, tree, header_page);
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete bpm;
+      delete disk_manager;
+      remove("test.db");
+    }
+  }
+  DiskManager::RemoveLogFiles("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeKeyCompressionTest, ConcurrentInsertTest) {
+  // Scenario: threads that insert interleaved keys into a PREFIX tree while others look keys up leave all keys in it.
+  auto key_schema = ParseCreateStatement(wide_schema);
+  WideComparator comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  WideTree tree("foo_pk", bpm, comparator, WidePageSizes::LEAF_PREFIX, WidePageSizes::INTERNAL_PREFIX,
+                KeyCompression::PREFIX);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  const int num_threads = 4;
+  const int64_t num_keys = 4000;
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      Transaction transaction(0);
+      std::vector<RID> rids;
+      for (int64_t key = tid; key < num_keys; key += num_threads) {
+        EXPECT_TRUE(tree.Insert(MakeKey(key_schema.get(), key), RID(0, key), &transaction));
+        rids.clear();
+        EXPECT_TRUE(tree.GetValue(MakeKey(key_schema.get(), key), &rids, &transaction));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_keys; key++) {
+    keys.push_back(key);
+  }
+  CheckKeys(key_schema.get(), &tree, keys);
+  CheckTree(bpm, comparator, tree, header_page);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  DiskManager::RemoveLogFiles("test.db");
+}
+
+}  // namespace bustub
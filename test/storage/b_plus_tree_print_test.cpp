@@ -113,6 +113,6 @@ TEST(BptTreeTest, DISABLED_UnitTest) {
   delete transaction;
   delete disk_manager;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 }  // namespace bustub
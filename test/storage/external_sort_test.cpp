@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort_test.cpp
+//
+// Identification: test/storage/external_sort_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/external_sort.h"
+#include "storage/index/generic_key.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using Sort = ExternalSort<GenericKey<8>, RID, GenericComparator<8>>;
+
+/**
+ * Sort keys drawn from [0, key_range), with the RID slot set to the order in which they were added, and check that
+ * they come out sorted, with equal keys in the order they were added.
+ * @param[out] num_merge_passes if not null, the number of merge passes before the final merge
+ * @return the number of runs the sort wrote
+ */
+static size_t SortAndCheck(BufferPoolManager *bpm, const GenericComparator<8> &comparator, size_t buffer_pages,
+                           int num_keys, int key_range, size_t *num_merge_passes = nullptr) {
+  std::mt19937 rng(42);
+  std::vector<int64_t> keys;
+  Sort sort(bpm, comparator, buffer_pages);
+  GenericKey<8> index_key;
+  for (int i = 0; i < num_keys; i++) {
+    keys.push_back(rng() % key_range);
+    index_key.SetFromInteger(keys.back());
+    sort.Add(index_key, RID(0, i));
+  }
+  sort.Finish();
+
+  std::pair<GenericKey<8>, RID> item;
+  int count = 0;
+  int64_t last_key = -1;
+  int64_t last_slot = -1;
+  while (sort.Next(&item)) {
+    int64_t key = item.first.ToString();
+    int64_t slot = item.second.GetSlotNum();
+    EXPECT_EQ(keys[slot], key);
+    EXPECT_LE(last_key, key);
+    if (key == last_key) {
+      EXPECT_LT(last_slot, slot);
+    }
+    last_key = key;
+    last_slot = slot;
+    count++;
+  }
+  EXPECT_EQ(num_keys, count);
+  EXPECT_FALSE(sort.Next(&item));
+  if (num_merge_passes != nullptr) {
+    *num_merge_passes = sort.GetNumMergePasses();
+  }
+  return sort.GetNumRuns();
+}
+
+// NOLINTNEXTLINE
+TEST(ExternalSortTest, SortTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  const size_t pool_size = 10;
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(pool_size, disk_manager);
+
+  // Scenario: no entries, and entries that fit into the buffer, are sorted in memory.
+  EXPECT_EQ(0, SortAndCheck(bpm, comparator, 1, 0, 10));
+  EXPECT_EQ(0, SortAndCheck(bpm, comparator, 1, 100, 10));
+
+  // Scenario: more entries than fit into the buffer are merged from runs, with duplicates staying stable.
+  size_t entries_per_page = PAGE_SIZE / sizeof(std::pair<GenericKey<8>, RID>);
+  EXPECT_EQ(8, SortAndCheck(bpm, comparator, 1, 8 * entries_per_page, 1000));
+  EXPECT_EQ(7, SortAndCheck(bpm, comparator, 2, 13 * entries_per_page + 1, 1 << 30));
+
+  // Scenario: more runs than frames in the pool are merged in several passes of at most half the pool.
+  size_t num_merge_passes = 0;
+  EXPECT_EQ(31, SortAndCheck(bpm, comparator, 1, 31 * entries_per_page, 1000, &num_merge_passes));
+  EXPECT_EQ(2, num_merge_passes);
+  EXPECT_EQ(4, SortAndCheck(bpm, comparator, 1, 4 * entries_per_page, 1 << 30, &num_merge_passes));
+  EXPECT_EQ(0, num_merge_passes);
+
+  // Scenario: a sort that is destroyed before all entries are read leaves no pages pinned.
+  {
+    Sort sort(bpm, comparator, 1);
+    GenericKey<8> index_key;
+    for (size_t i = 0; i < 5 * entries_per_page; i++) {
+      index_key.SetFromInteger(i % 3);
+      sort.Add(index_key, RID(0, i));
+    }
+    sort.Finish();
+    std::pair<GenericKey<8>, RID> item;
+    for (size_t i = 0; i < entries_per_page + 1; i++) {
+      ASSERT_TRUE(sort.Next(&item));
+    }
+  }
+  page_id_t page_id;
+  for (size_t i = 0; i < pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  DiskManager::RemoveLogFiles("test.db");
+}
+
+}  // namespace bustub
@@ -202,7 +202,7 @@ void BPlusTreeBenchmarkCall() {
     delete disk_manager;
     delete bpm;
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
   }
   if (success) {
     ss << (time_total.count() / static_cast<double>(NUM_ITERS));
@@ -224,7 +224,7 @@ TEST(BPlusTreeTest, BPlusTreeBenchmark) {
   TEST_TIMEOUT_BEGIN
   BPlusTreeBenchmarkCall();
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   TEST_TIMEOUT_FAIL_END(1000 * 300)
 }
 
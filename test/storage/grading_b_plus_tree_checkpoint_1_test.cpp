@@ -72,7 +72,7 @@ TEST(BPlusTreeTests, SplitTest) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 /*
@@ -124,7 +124,7 @@ TEST(BPlusTreeTests, InsertTest1) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 /*
@@ -176,7 +176,7 @@ TEST(BPlusTreeTests, InsertTest2) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 /*
@@ -234,6 +234,6 @@ TEST(BPlusTreeTests, ScaleTest) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 }  // namespace bustub
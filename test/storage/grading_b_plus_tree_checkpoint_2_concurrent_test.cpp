@@ -175,7 +175,7 @@ void InsertTest1Call() {
     delete disk_manager;
     delete bpm;
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
   }
 }
 
@@ -230,7 +230,7 @@ void InsertTest2Call() {
     delete disk_manager;
     delete bpm;
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
   }
 }
 
@@ -274,7 +274,7 @@ void DeleteTest1Call() {
     delete disk_manager;
     delete bpm;
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
   }
 }
 
@@ -319,7 +319,7 @@ void DeleteTest2Call() {
     delete disk_manager;
     delete bpm;
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
   }
 }
 
@@ -381,7 +381,7 @@ void MixTest1Call() {
     delete disk_manager;
     delete bpm;
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
   }
 }
 
@@ -450,7 +450,7 @@ void MixTest2Call() {
     delete disk_manager;
     delete bpm;
     remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveLogFiles("test.db");
   }
 }
 
@@ -462,7 +462,7 @@ TEST(BPlusTreeConcurrentTest, InsertTest1) {
   TEST_TIMEOUT_BEGIN
   InsertTest1Call();
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   TEST_TIMEOUT_FAIL_END(1000 * 60)
 }
 
@@ -475,7 +475,7 @@ TEST(BPlusTreeConcurrentTest, InsertTest2) {
   TEST_TIMEOUT_BEGIN
   InsertTest2Call();
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   TEST_TIMEOUT_FAIL_END(1000 * 60)
 }
 
@@ -487,7 +487,7 @@ TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   TEST_TIMEOUT_BEGIN
   DeleteTest1Call();
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   TEST_TIMEOUT_FAIL_END(1000 * 60)
 }
 
@@ -500,7 +500,7 @@ TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   TEST_TIMEOUT_BEGIN
   DeleteTest2Call();
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   TEST_TIMEOUT_FAIL_END(1000 * 60)
 }
 
@@ -515,7 +515,7 @@ TEST(BPlusTreeConcurrentTest, MixTest1) {
   TEST_TIMEOUT_BEGIN
   MixTest1Call();
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   TEST_TIMEOUT_FAIL_END(1000 * 300)
 }
 
@@ -531,7 +531,7 @@ TEST(BPlusTreeConcurrentTest, MixTest2) {
   TEST_TIMEOUT_BEGIN
   MixTest2Call();
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   TEST_TIMEOUT_FAIL_END(1000 * 300)
 }
 
@@ -72,7 +72,7 @@ TEST(BPlusTreeTests, InsertTest1) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 /*
@@ -145,7 +145,7 @@ TEST(BPlusTreeTests, InsertTest2) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 /*
@@ -230,7 +230,7 @@ TEST(BPlusTreeTests, DeleteTest1) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 /*
@@ -314,7 +314,7 @@ TEST(BPlusTreeTests, DeleteTest2) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 /*
@@ -398,7 +398,7 @@ TEST(BPlusTreeTests, ScaleTest) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 /*
@@ -479,6 +479,6 @@ TEST(BPlusTreeTests, SequentialMixTest) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 }  // namespace bustub
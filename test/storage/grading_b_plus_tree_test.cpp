@@ -57,7 +57,7 @@ TEST(BPlusTreeTests, SplitTest) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 TEST(BPlusTreeTests, MergeTest) {
@@ -100,7 +100,7 @@ TEST(BPlusTreeTests, MergeTest) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 TEST(BPlusTreeTests, InsertTest1) {
@@ -154,7 +154,7 @@ TEST(BPlusTreeTests, InsertTest1) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 TEST(BPlusTreeTests, InsertTest2) {
@@ -218,7 +218,7 @@ TEST(BPlusTreeTests, InsertTest2) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 TEST(BPlusTreeTests, DeleteTest1) {
@@ -293,7 +293,7 @@ TEST(BPlusTreeTests, DeleteTest1) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 TEST(BPlusTreeTests, DeleteTest2) {
@@ -367,7 +367,7 @@ TEST(BPlusTreeTests, DeleteTest2) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 TEST(BPlusTreeTests, ScaleTest) {
@@ -452,7 +452,7 @@ TEST(BPlusTreeTests, ScaleTest) {
   delete disk_manager;
   delete bpm;
   remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
 }
 
 }  // namespace cmudb
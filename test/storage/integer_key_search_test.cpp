@@ -0,0 +1,157 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// integer_key_search_test.cpp
+//
+// Identification: test/storage/integer_key_search_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/integer_key_search.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(IntegerKeySearchTest, SearchTest) {
+  std::mt19937_64 rng(42);
+  for (size_t width : {1, 2, 4, 8}) {
+    for (size_t stride : {width, size_t{12}, size_t{16}}) {
+      if (stride < width) {
+        continue;
+      }
+      for (int count = 0; count < 80; count++) {
+        // Scenario: sorted keys with duplicates and negative ones, laid out like the entries of a page, are found
+        // where std::lower_bound and std::upper_bound find them, for every width and stride.
+        std::vector<int64_t> keys;
+        int64_t limit = width == 8 ? INT64_MAX : (int64_t{1} << (8 * width - 1)) - 1;
+        for (int i = 0; i < count; i++) {
+          keys.push_back(static_cast<int64_t>(rng() % 64) - 32);
+        }
+        keys.push_back(limit);
+        keys.push_back(-limit - 1);
+        std::sort(keys.begin(), keys.end());
+        std::vector<char> data(keys.size() * stride + 8);
+        for (size_t i = 0; i < keys.size(); i++) {
+          memcpy(&data[i * stride], &keys[i], width);
+        }
+        int size = keys.size();
+        for (int64_t key : {int64_t{-40}, int64_t{-32}, int64_t{-1}, int64_t{0}, int64_t{5}, int64_t{31}, int64_t{40},
+                            limit, -limit - 1}) {
+          int64_t normalized = IntegerKeySearch::Normalize(reinterpret_cast<const char *>(&key), width);
+          EXPECT_EQ(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin(),
+                    IntegerKeySearch::Search(data.data(), stride, size, width, normalized, false));
+          EXPECT_EQ(std::upper_bound(keys.begin(), keys.end(), key) - keys.begin(),
+                    IntegerKeySearch::Search(data.data(), stride, size, width, normalized, true));
+        }
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(IntegerKeySearchTest, ComparatorTest) {
+  // Scenario: the comparator of a single integer column orders keys as comparing their values does.
+  std::mt19937_64 rng(42);
+  for (const char *schema : {"a tinyint", "a smallint", "a integer", "a bigint"}) {
+    auto key_schema = ParseCreateStatement(schema);
+    GenericComparator<8> comparator(key_schema.get());
+    EXPECT_EQ(Type::GetTypeSize(key_schema->GetColumn(0).GetType()), comparator.GetIntegerKeyWidth());
+    TypeId type = key_schema->GetColumn(0).GetType();
+    for (int i = 0; i < 1000; i++) {
+      std::vector<Value> values;
+      for (int j = 0; j < 2; j++) {
+        // small values collide often, so that equal keys are covered too
+        auto raw = static_cast<int64_t>(i % 2 == 0 ? rng() % 16 : rng());
+        switch (type) {
+          case TypeId::TINYINT:
+            values.emplace_back(type, static_cast<int8_t>(std::max<int64_t>(static_cast<int8_t>(raw), -127)));
+            break;
+          case TypeId::SMALLINT:
+            values.emplace_back(type, static_cast<int16_t>(std::max<int64_t>(static_cast<int16_t>(raw), -32767)));
+            break;
+          case TypeId::INTEGER:
+            values.emplace_back(type, static_cast<int32_t>(std::max<int64_t>(static_cast<int32_t>(raw), -2147483647)));
+            break;
+          default:
+            values.emplace_back(type, std::max<int64_t>(raw, -INT64_MAX));
+        }
+      }
+      GenericKey<8> lhs;
+      GenericKey<8> rhs;
+      lhs.SetFromKey(Tuple({values[0]}, key_schema.get()));
+      rhs.SetFromKey(Tuple({values[1]}, key_schema.get()));
+      int expected = values[0].CompareLessThan(values[1]) == CmpBool::CmpTrue
+                         ? -1
+                         : static_cast<int>(values[0].CompareGreaterThan(values[1]) == CmpBool::CmpTrue);
+      EXPECT_EQ(expected, comparator(lhs, rhs));
+    }
+  }
+
+  // Scenario: keys of other schemas are compared through their values.
+  auto key_schema = ParseCreateStatement("a bigint,b bigint");
+  GenericComparator<16> comparator(key_schema.get());
+  EXPECT_EQ(0, comparator.GetIntegerKeyWidth());
+}
+
+// NOLINTNEXTLINE
+TEST(IntegerKeySearchTest, TreeTest) {
+  // Scenario: a tree of integer keys, which its pages search with IntegerKeySearch, finds and scans all keys in
+  // order, negative ones included.
+  auto key_schema = ParseCreateStatement("a integer");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  Transaction transaction(0);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  auto make_key = [&key_schema](int32_t key) {
+    GenericKey<8> index_key;
+    index_key.SetFromKey(Tuple({Value(TypeId::INTEGER, key)}, key_schema.get()));
+    return index_key;
+  };
+  std::vector<int32_t> keys;
+  for (int32_t key = -5000; key < 5000; key++) {
+    keys.push_back(key * 3);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+  for (int32_t key : keys) {
+    EXPECT_TRUE(tree.Insert(make_key(key), RID(0, key), &transaction));
+  }
+  std::vector<RID> rids;
+  for (int32_t key = -15001; key < 15000; key++) {
+    rids.clear();
+    ASSERT_EQ(key % 3 == 0, tree.GetValue(make_key(key), &rids, &transaction)) << key;
+    if (key % 3 == 0) {
+      EXPECT_EQ(key, static_cast<int32_t>(rids[0].GetSlotNum()));
+    }
+  }
+  int32_t current_key = -15000;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ(current_key, static_cast<int32_t>((*iterator).second.GetSlotNum()));
+    current_key += 3;
+  }
+  EXPECT_EQ(15000, current_key);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  DiskManager::RemoveLogFiles("test.db");
+}
+
+}  // namespace bustub
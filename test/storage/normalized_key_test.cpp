@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// normalized_key_test.cpp
+//
+// Identification: test/storage/normalized_key_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "storage/index/normalized_key.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** @return a random value of the type, drawn from few values so that equal ones come up */
+static Value RandomValue(TypeId type, std::mt19937_64 *rng) {
+  auto raw = static_cast<int64_t>((*rng)() % 7) - 3;
+  if ((*rng)() % 8 == 0) {
+    raw = static_cast<int64_t>((*rng)());
+  }
+  switch (type) {
+    case TypeId::TINYINT:
+      return Value(type, static_cast<int8_t>(std::max<int64_t>(static_cast<int8_t>(raw), -127)));
+    case TypeId::SMALLINT:
+      return Value(type, static_cast<int16_t>(std::max<int64_t>(static_cast<int16_t>(raw), -32767)));
+    case TypeId::INTEGER:
+      return Value(type, static_cast<int32_t>(std::max<int64_t>(static_cast<int32_t>(raw), -2147483647)));
+    case TypeId::BIGINT:
+      return Value(type, std::max<int64_t>(raw, -INT64_MAX));
+    case TypeId::DECIMAL:
+      return Value(type, static_cast<double>(raw % 1000) / 8);
+    case TypeId::BOOLEAN:
+      return Value(type, static_cast<int8_t>(raw > 0));
+    default: {
+      // short strings of a few characters, zero bytes among them
+      std::string chars(static_cast<size_t>((*rng)() % 4), 'a');
+      for (auto &c : chars) {
+        c = "\0ab\xff"[(*rng)() % 4];
+      }
+      return Value(TypeId::VARCHAR, chars);
+    }
+  }
+}
+
+/** @return the order of the values of two keys, column by column */
+static int CompareValues(const std::vector<Value> &lhs, const std::vector<Value> &rhs) {
+  for (size_t i = 0; i < lhs.size(); i++) {
+    if (lhs[i].CompareLessThan(rhs[i]) == CmpBool::CmpTrue) {
+      return -1;
+    }
+    if (lhs[i].CompareGreaterThan(rhs[i]) == CmpBool::CmpTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static int Sign(int cmp) { return cmp < 0 ? -1 : static_cast<int>(cmp > 0); }
+
+// NOLINTNEXTLINE
+TEST(NormalizedKeyTest, OrderTest) {
+  // Scenario: the memcmp order of the encodings is the order of the keys, for every type and for keys of several
+  // columns, varchars with zero bytes in them and in the middle of the key included.
+  std::mt19937_64 rng(42);
+  for (const char *schema : {"a boolean", "a tinyint", "a smallint", "a integer", "a bigint", "a double",
+                             "a varchar(8)", "a integer,b varchar(8),c bigint", "a varchar(8),b varchar(8)"}) {
+    auto key_schema = ParseCreateStatement(schema);
+    GenericComparator<64> comparator(key_schema.get(), KeyFormat::NORMALIZED);
+    for (int i = 0; i < 2000; i++) {
+      std::vector<Value> values[2];
+      GenericKey<64> keys[2];
+      for (int j = 0; j < 2; j++) {
+        for (uint32_t column = 0; column < key_schema->GetColumnCount(); column++) {
+          values[j].push_back(RandomValue(key_schema->GetColumn(column).GetType(), &rng));
+        }
+        keys[j].SetFromKey(Tuple(values[j], key_schema.get()), key_schema.get(), KeyFormat::NORMALIZED);
+      }
+      ASSERT_EQ(CompareValues(values[0], values[1]), Sign(comparator(keys[0], keys[1])))
+          << schema << ": " << values[0][0].ToString() << " " << values[1][0].ToString();
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(NormalizedKeyTest, EncodeTest) {
+  // Scenario: integers are big-endian with the sign bit flipped, and varchars are terminated.
+  auto key_schema = ParseCreateStatement("a integer,b varchar(8)");
+  Tuple key({Value(TypeId::INTEGER, -2), Value(TypeId::VARCHAR, std::string("a\0b", 3))}, key_schema.get());
+  char data[16];
+  const char expected[] = {'\x7f', '\xff', '\xff', '\xfe', 'a', '\0', '\xff', 'b', '\0', '\x01'};
+  ASSERT_EQ(sizeof(expected), NormalizedKey::Encode(key, key_schema.get(), data, sizeof(data)));
+  EXPECT_EQ(0, memcmp(expected, data, sizeof(expected)));
+
+  // Scenario: an encoding longer than the capacity is cut, and its whole length is returned.
+  memset(data, 0, sizeof(data));
+  EXPECT_EQ(sizeof(expected), NormalizedKey::Encode(key, key_schema.get(), data, 5));
+  EXPECT_EQ(0, memcmp(expected, data, 5));
+  EXPECT_EQ(0, data[5]);
+
+  // Scenario: a NULL integer sorts before every other one.
+  auto integer_schema = ParseCreateStatement("a integer");
+  GenericComparator<8> comparator(integer_schema.get(), KeyFormat::NORMALIZED);
+  GenericKey<8> null_key;
+  GenericKey<8> min_key;
+  null_key.SetFromKey(Tuple({ValueFactory::GetNullValueByType(TypeId::INTEGER)}, integer_schema.get()),
+                      integer_schema.get(), KeyFormat::NORMALIZED);
+  min_key.SetFromKey(Tuple({Value(TypeId::INTEGER, -2147483647)}, integer_schema.get()), integer_schema.get(),
+                     KeyFormat::NORMALIZED);
+  EXPECT_GT(0, comparator(null_key, min_key));
+
+  // Scenario: TUPLE keys keep the bytes of the tuple.
+  auto bigint_schema = ParseCreateStatement("a bigint");
+  GenericKey<8> tuple_key;
+  GenericKey<8> integer_key;
+  tuple_key.SetFromKey(Tuple({Value(TypeId::BIGINT, int64_t{42})}, bigint_schema.get()), bigint_schema.get(),
+                       KeyFormat::TUPLE);
+  integer_key.SetFromInteger(42);
+  EXPECT_EQ(0, memcmp(tuple_key.data_, integer_key.data_, sizeof(tuple_key.data_)));
+}
+
+}  // namespace bustub
@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_protection_bench_test.cpp
+//
+// Identification: test/storage/page_protection_bench_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cinttypes>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+class PageProtectionBenchTest : public ::testing::Test {
+ protected:
+  void SetUp() override { RemoveFiles(); }
+
+  void TearDown() override { RemoveFiles(); }
+
+  static void RemoveFiles() {
+    remove("bench.db");
+    remove("bench.crc");
+    remove("bench.dwb");
+    DiskManager::RemoveLogFiles("bench.db");
+  }
+};
+
+/**
+ * Compares the cost of the page protection options on the two write patterns of the buffer pool: FlushAllPages writes
+ * many sorted pages at once, eviction writes one page at a time. The reads verify the checksums.
+ */
+// NOLINTNEXTLINE
+TEST_F(PageProtectionBenchTest, WriteReadBench) {
+  const int num_pages = 1024;
+  const int num_single_writes = 128;
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE));
+  std::vector<page_id_t> page_ids;
+  std::vector<const char *> page_data;
+  for (int i = 0; i < num_pages; ++i) {
+    snprintf(pages[i].data(), PAGE_SIZE, "page %d", i);
+    page_ids.push_back(i);
+    page_data.push_back(pages[i].data());
+  }
+  char buf[PAGE_SIZE];
+  auto elapsed_us = [](std::chrono::steady_clock::time_point start) {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::max<int64_t>(1, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+  };
+
+  printf("%-12s %16s %16s %16s %8s\n", "protection", "batch pages/s", "single pages/s", "read pages/s", "syncs");
+  for (auto [name, protection] : {std::make_pair("none", PageProtection::NONE),
+                                  std::make_pair("checksum", PageProtection::CHECKSUM),
+                                  std::make_pair("double-write", PageProtection::DOUBLE_WRITE)}) {
+    auto *dm = new DiskManager("bench.db", DiskIOBackend::PREAD_PWRITE, LOG_SEGMENT_SIZE, protection);
+
+    auto start = std::chrono::steady_clock::now();
+    dm->WritePages(page_ids, page_data);
+    int64_t batch_us = elapsed_us(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_single_writes; ++i) {
+      dm->WritePage(i * (num_pages / num_single_writes), page_data[i * (num_pages / num_single_writes)]);
+    }
+    int64_t single_us = elapsed_us(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_pages; ++i) {
+      dm->ReadPage(i, buf);
+    }
+    int64_t read_us = elapsed_us(start);
+
+    EXPECT_EQ(0, dm->GetNumChecksumFailures());
+    printf("%-12s %16" PRId64 " %16" PRId64 " %16" PRId64 " %8d\n", name, num_pages * int64_t{1000000} / batch_us,
+           num_single_writes * int64_t{1000000} / single_us, num_pages * int64_t{1000000} / read_us, dm->GetNumSyncs());
+    delete dm;
+    RemoveFiles();
+  }
+}
+
+}  // namespace bustub
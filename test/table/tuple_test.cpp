@@ -65,7 +65,7 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   }
   disk_manager->ShutDown();
   remove("test.db");  // remove db file
-  remove("test.log");
+  DiskManager::RemoveLogFiles("test.db");
   delete table;
   delete buffer_pool_manager;
   delete disk_manager;